@@ -0,0 +1,332 @@
+//Reference client for the feeder's binary protocol. It frames requests the way src/protocol.c expects them,
+//COBS encoded with a CRC-16 (CCITT, 0x1021, initial 0xFFFF) and a 0 byte at the end, and matches the
+//responses to the requests by type and id. openFeeder switches a serial port to 115200 8N1 and the feeder
+//to binary mode with the "binary" command. encodeRequest and receiveByte work without a port, for other
+//transports and the host tests. The CRC is computed bit by bit here so it checks the firmware's table.
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "feederClient.h"
+
+uint16_t clientCrc16(const uint8_t* data, uint8_t length)
+{
+    uint16_t crc = CRC_START;
+    uint8_t i = 0;
+    uint8_t bit = 0;
+    for(i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint8_t encodeRequest(uint8_t* wire, uint8_t type, uint8_t id, const uint8_t* payload, uint8_t length)  // Returns the bytes to send, 0 included
+{
+    uint8_t data[FRAME_MAX];
+    uint8_t count = 0;
+    uint8_t start = 0;                              // Start of the run the next code byte describes
+    uint8_t i = 0;
+    uint16_t crc = 0;
+
+    if(length > PAYLOAD_MAX)
+    {
+        return 0;
+    }
+    data[0] = type;
+    data[1] = id;
+    if(length != 0)
+    {
+        memcpy(&data[2], payload, length);
+    }
+    length += 2;
+    crc = clientCrc16(data, length);
+    data[length++] = crc & 0xFF;
+    data[length++] = crc >> 8;
+
+    for(i = 0; i <= length; i++)                    // Frames are shorter than 254, every run ends at a 0 or the end
+    {
+        if((i == length) || (data[i] == 0))
+        {
+            wire[count++] = i - start + 1;
+            memcpy(&wire[count], &data[start], i - start);
+            count += i - start;
+            start = i + 1;
+        }
+    }
+    wire[count++] = 0;
+    return count;
+}
+
+void initClient(CLIENT* client, int fd)
+{
+    client->fd = fd;
+    client->nextId = 0;
+    client->rxCount = 0;
+    client->rxOverflow = false;
+    client->badFrames = 0;
+}
+
+static bool decodeResponse(CLIENT* client, RESPONSE* response)
+{
+    uint8_t data[WIRE_MAX];
+    uint8_t in = 0;
+    uint8_t out = 0;
+
+    while(in < client->rxCount)
+    {
+        uint8_t code = client->rx[in++];
+        if((code == 0) || (in + code - 1 > client->rxCount))
+        {
+            return false;
+        }
+        memcpy(&data[out], &client->rx[in], code - 1);
+        in += code - 1;
+        out += code - 1;
+        if((code != 0xFF) && (in < client->rxCount))
+        {
+            data[out++] = 0;
+        }
+    }
+    if((out < 5) || (clientCrc16(data, out - 2) != (data[out - 2] | (data[out - 1] << 8))))
+    {
+        return false;
+    }
+    response->type = data[0];
+    response->id = data[1];
+    response->status = data[2];
+    response->length = out - 5;
+    memcpy(response->payload, &data[3], response->length);
+    return true;
+}
+
+bool receiveByte(CLIENT* client, uint8_t c, RESPONSE* response)  // Returns true when a response with a good CRC is complete
+{
+    bool complete = false;
+    if(c != 0)
+    {
+        if(client->rxCount < WIRE_MAX)
+        {
+            client->rx[client->rxCount++] = c;
+        }
+        else
+        {
+            client->rxOverflow = true;
+        }
+        return false;
+    }
+    if(client->rxCount != 0)                        // Back-to-back 0 bytes are only padding
+    {
+        complete = !client->rxOverflow && decodeResponse(client, response);
+        client->badFrames += complete ? 0 : 1;
+    }
+    client->rxCount = 0;
+    client->rxOverflow = false;
+    return complete;
+}
+
+static uint32_t nowMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+}
+
+bool openFeeder(CLIENT* client, const char* device)   // 115200 8N1, raw, and the feeder in binary mode
+{
+    struct termios tty;
+    const uint8_t end = 0;
+    const struct timespec settle = {0, 100000000};   // The feeder answers "binary" well within 100 ms
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    if((fd < 0) || (tcgetattr(fd, &tty) != 0))
+    {
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+    tty.c_oflag &= ~OPOST;
+    tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tty.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+    tty.c_cflag |= CS8 | CREAD | CLOCAL;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    cfsetispeed(&tty, B115200);
+    cfsetospeed(&tty, B115200);
+    if(tcsetattr(fd, TCSANOW, &tty) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    initClient(client, fd);
+    if(write(fd, "binary\r", 7) != 7)               // Text mode switches, binary mode drops it as a bad frame
+    {
+        close(fd);
+        return false;
+    }
+    nanosleep(&settle, NULL);
+    tcflush(fd, TCIFLUSH);                          // The "Binary mode." reply
+    return write(fd, &end, 1) == 1;                 // Ends whatever the feeder has collected as a frame
+}
+
+void closeFeeder(CLIENT* client)
+{
+    if(client->fd >= 0)
+    {
+        close(client->fd);
+    }
+    client->fd = -1;
+}
+
+uint8_t feederRequest(CLIENT* client, uint8_t type, const uint8_t* payload, uint8_t length, RESPONSE* response)  // Returns the status
+{
+    uint8_t wire[WIRE_MAX];
+    uint8_t id = client->nextId++;
+    uint8_t count = encodeRequest(wire, type, id, payload, length);
+    uint32_t deadline = nowMs() + CLIENT_TIMEOUT_MS;
+
+    if((client->fd < 0) || (count == 0) || (write(client->fd, wire, count) != count))
+    {
+        return CLIENT_TIMEOUT;
+    }
+    while((int32_t)(deadline - nowMs()) > 0)
+    {
+        struct pollfd wait = {client->fd, POLLIN, 0};
+        uint8_t c = 0;
+        if((poll(&wait, 1, deadline - nowMs()) > 0) && (read(client->fd, &c, 1) == 1)
+           && receiveByte(client, c, response) && (response->id == id) && (response->type == (type | FRAME_RESPONSE)))
+        {
+            return response->status;
+        }
+    }
+    return CLIENT_TIMEOUT;                          // Responses to earlier requests are skipped
+}
+
+static void putShort(uint8_t* data, uint16_t value)   // Little endian, as the feeder sends them
+{
+    data[0] = value;
+    data[1] = value >> 8;
+}
+
+static void putLong(uint8_t* data, uint32_t value)
+{
+    putShort(data, value);
+    putShort(&data[2], value >> 16);
+}
+
+static uint32_t getLong(const uint8_t* data)
+{
+    return data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+uint8_t feederGetTime(CLIENT* client, uint32_t* seconds, uint8_t* weekday)
+{
+    RESPONSE response;
+    uint8_t status = feederRequest(client, MSG_GET_TIME, NULL, 0, &response);
+    if((status == STATUS_OK) && (response.length == 5))
+    {
+        *seconds = getLong(response.payload);
+        *weekday = response.payload[4];
+    }
+    return status;
+}
+
+uint8_t feederSetTime(CLIENT* client, uint16_t minutes)
+{
+    RESPONSE response;
+    uint8_t payload[2];
+    putShort(payload, minutes);
+    return feederRequest(client, MSG_SET_TIME, payload, 2, &response);
+}
+
+uint8_t feederGetEvent(CLIENT* client, uint8_t event, uint32_t* time, uint32_t* action)  // 0xFFFFFFFF when the event is free
+{
+    RESPONSE response;
+    uint8_t status = feederRequest(client, MSG_GET_EVENT, &event, 1, &response);
+    if((status == STATUS_OK) && (response.length == 8))
+    {
+        *time = getLong(&response.payload[0]);
+        *action = getLong(&response.payload[4]);
+    }
+    return status;
+}
+
+uint8_t feederSetEvent(CLIENT* client, uint8_t event, uint32_t time, uint32_t action)   // Record words as in src/sortEvent.h
+{
+    RESPONSE response;
+    uint8_t payload[9];
+    payload[0] = event;
+    putLong(&payload[1], time);
+    putLong(&payload[5], action);
+    return feederRequest(client, MSG_SET_EVENT, payload, 9, &response);
+}
+
+uint8_t feederDeleteEvent(CLIENT* client, uint8_t event)
+{
+    RESPONSE response;
+    return feederRequest(client, MSG_DELETE_EVENT, &event, 1, &response);
+}
+
+uint8_t feederListEvents(CLIENT* client, uint8_t* events, uint16_t max, uint16_t* count)  // All events in fire order, a page at a time
+{
+    RESPONSE response;
+    uint8_t payload[2];
+    uint16_t after = 0xFFFF;
+    uint8_t status = STATUS_OK;
+    uint8_t page = LIST_PAGE;
+
+    *count = 0;
+    while((status == STATUS_OK) && (page == LIST_PAGE) && (*count < max))
+    {
+        uint8_t i = 0;
+        putShort(payload, after);
+        status = feederRequest(client, MSG_LIST_EVENTS, payload, 2, &response);
+        page = (status == STATUS_OK) ? response.length - 2 : 0;
+        for(i = 0; (i < page) && (*count < max); i++)
+        {
+            events[(*count)++] = response.payload[2 + i];
+        }
+        after = (page != 0) ? response.payload[1 + page] : after;
+    }
+    return status;                                  // STATUS_VALUE when the page start fired meanwhile, list again
+}
+
+uint8_t feederGetSetting(CLIENT* client, uint16_t word, uint32_t* value)
+{
+    RESPONSE response;
+    uint8_t payload[2];
+    uint8_t status = 0;
+    putShort(payload, word);
+    status = feederRequest(client, MSG_GET_SETTING, payload, 2, &response);
+    if((status == STATUS_OK) && (response.length == 4))
+    {
+        *value = getLong(response.payload);
+    }
+    return status;
+}
+
+uint8_t feederSetSetting(CLIENT* client, uint16_t word, uint32_t value)
+{
+    RESPONSE response;
+    uint8_t payload[6];
+    putShort(payload, word);
+    putLong(&payload[2], value);
+    return feederRequest(client, MSG_SET_SETTING, payload, 6, &response);
+}
+
+uint8_t feederTextMode(CLIENT* client)
+{
+    RESPONSE response;
+    return feederRequest(client, MSG_TEXT_MODE, NULL, 0, &response);
+}
@@ -0,0 +1,56 @@
+/*
+ * feederClient.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Reference client for the binary protocol in src/protocol.h, for a PC on the other end of UART0.
+ */
+
+#ifndef FEEDERCLIENT_H_
+#define FEEDERCLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol.h"
+
+#define WIRE_MAX (FRAME_MAX + 2)                    // COBS code byte and the 0 that ends the frame
+#define CLIENT_TIMEOUT 0xFF                         // Status when no valid response came back
+#define CLIENT_TIMEOUT_MS 500
+
+typedef struct _RESPONSE
+{
+    uint8_t type;                                   // Request type with FRAME_RESPONSE set
+    uint8_t id;
+    uint8_t status;
+    uint8_t length;
+    uint8_t payload[PAYLOAD_MAX];
+} RESPONSE;
+
+typedef struct _CLIENT
+{
+    int fd;                                         // Serial port, -1 when the caller moves the bytes itself
+    uint8_t nextId;
+    uint8_t rx[WIRE_MAX];                           // Encoded bytes of the frame being received
+    uint8_t rxCount;
+    bool rxOverflow;
+    uint32_t badFrames;                             // CRC, COBS or length errors
+} CLIENT;
+
+uint16_t clientCrc16(const uint8_t* data, uint8_t length);
+uint8_t encodeRequest(uint8_t* wire, uint8_t type, uint8_t id, const uint8_t* payload, uint8_t length);
+void initClient(CLIENT* client, int fd);
+bool receiveByte(CLIENT* client, uint8_t c, RESPONSE* response);
+bool openFeeder(CLIENT* client, const char* device);
+void closeFeeder(CLIENT* client);
+uint8_t feederRequest(CLIENT* client, uint8_t type, const uint8_t* payload, uint8_t length, RESPONSE* response);
+uint8_t feederGetTime(CLIENT* client, uint32_t* seconds, uint8_t* weekday);
+uint8_t feederSetTime(CLIENT* client, uint16_t minutes);
+uint8_t feederGetEvent(CLIENT* client, uint8_t event, uint32_t* time, uint32_t* action);
+uint8_t feederSetEvent(CLIENT* client, uint8_t event, uint32_t time, uint32_t action);
+uint8_t feederDeleteEvent(CLIENT* client, uint8_t event);
+uint8_t feederListEvents(CLIENT* client, uint8_t* events, uint16_t max, uint16_t* count);
+uint8_t feederGetSetting(CLIENT* client, uint16_t word, uint32_t* value);
+uint8_t feederSetSetting(CLIENT* client, uint16_t word, uint32_t value);
+uint8_t feederTextMode(CLIENT* client);
+
+#endif /* FEEDERCLIENT_H_ */
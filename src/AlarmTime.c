@@ -1,12 +1,11 @@
-#include <inttypes.h>
-#include <float.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdio.h>
 #include <string.h>
 #include "clock.h"
 #include "eeprom.h"
+#include "eepromCache.h"
 #include "uart0.h"
+#include "format.h"
 #include "tm4c123gh6pm.h"
 #include "wait.h"
 #include "sortEvent.h"
@@ -15,43 +14,38 @@
 
 void AlarmTime()
 {
-    uint8_t a = 0;
-    uint32_t H = 0;
-    uint32_t M = 0;
+    uint16_t a = getNextEvent();            //Earliest event, at the top of the scheduler heap
     uint32_t newSeconds = 0;
 
-    H = readEeprom((16*a)+3);
-    M = readEeprom((16*a)+4);
+    if(a == NO_EVENT)
+    {
+        while(!(HIB_CTL_R & HIB_CTL_WRC));
+        HIB_RTCM0_R = 0xFFFFFFFF;           //Disarms the match left from the last event, the RTC never gets there
+        putsUart0("No alarm scheduled.\n");
+        return;
+    }
 
-    newSeconds = ((3600 * H) + (M * 60));
+    newSeconds = getNextFireTime();         //RTC second of the next feed, already rolled over to tomorrow if needed
 
     uint32_t RealTimeSeconds = 0;
     while(!(HIB_CTL_R & HIB_CTL_WRC));
     RealTimeSeconds = HIB_RTCC_R;           //Gets the value of the RTCC
 
-    uint32_t Difference = 0;
-    Difference = newSeconds - RealTimeSeconds;
+    if(newSeconds <= RealTimeSeconds)       //Events due now (e.g. several at the same minute) fire on the next second
+    {
+        newSeconds = RealTimeSeconds + 1;
+    }
 
     while(!(HIB_CTL_R & HIB_CTL_WRC));
-    HIB_RTCM0_R = RealTimeSeconds + Difference;
+    HIB_RTCM0_R = newSeconds;
 
     uint32_t MatchRead;
 
     while(!(HIB_CTL_R & HIB_CTL_WRC));
     MatchRead = HIB_RTCM0_R;
 
-    char MRead[40];
-    uint32_t MatchHH = MatchRead / 3600;
+    uint32_t MatchHH = (MatchRead % SECONDS_PER_DAY) / 3600;
     uint32_t MatchMM = (MatchRead % 3600) / 60;
 
-    if((H == 0xFFFFFFFF) && (M == 0xFFFFFFFF))
-    {
-        putsUart0("No alarm scheduled.\n");
-    }
-    else
-    {
-        snprintf(MRead, sizeof(MRead), "Alarm time is %02d:%02d\n", MatchHH, MatchMM);
-        putsUart0(MRead);
-    }
+    printUart0("Alarm time is %02d:%02d\n", MatchHH, MatchMM);
 }
-
@@ -13,14 +13,13 @@
  * SENSOR:  Port A2
 */
 
-#include <inttypes.h>
-#include <float.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdio.h>
 #include <string.h>
 #include "clock.h"
 #include "eeprom.h"
+#include "eepromCache.h"
+#include "configStore.h"
 #include "uart0.h"
 #include "tm4c123gh6pm.h"
 #include "wait.h"
@@ -28,6 +27,21 @@
 #include "getInput.h"
 #include "initModules.h"
 #include "AlarmTime.h"
+#include "isrQueue.h"
+#include "eventLoop.h"
+#include "lowPower.h"
+#include "calibration.h"
+#include "levelFilter.h"
+#include "sampleRate.h"
+#include "pumpControl.h"
+#include "fixedPoint.h"
+#include "motion.h"
+#include "visits.h"
+#include "auger.h"
+#include "portion.h"
+#include "protocol.h"
+#include "format.h"
+#include "scheduleTransfer.h"
 
 // BIT-BANDING:
 #define SENSOR      (*((volatile uint32_t *)(0x42000000 + (0x400043FC-0x40000000)*32 + 2*4)))     //PA2
@@ -35,7 +49,7 @@
 #define CO_NEG      (*((volatile uint32_t *)(0x42000000 + (0x400063FC-0x40000000)*32 + 7*4)))     //PC7
 #define SPEAKER     (*((volatile uint32_t *)(0x42000000 + (0x400073FC-0x40000000)*32 + 0*4)))     //PD0
 #define TRIGGER     (*((volatile uint32_t *)(0x42000000 + (0x400073FC-0x40000000)*32 + 6*4)))     //PD6
-#define PUMP        (*((volatile uint32_t *)(0x42000000 + (0x400253FC-0x40000000)*32 + 0*4)))     //PF0
+#define PUMP_ON     ((PWM1_ENABLE_R & PWM_ENABLE_PWM4EN) != 0)                                        //PF0, M1PWM4
 
 // MASKING:
 #define PUMP_MASK 1         // 2^0    -   PORT F0
@@ -58,19 +72,20 @@ void initHw()
     //Initialize Uart clock and set the baud rate
     initUart0();
     setUart0BaudRate(115200, 40e6);
+    NVIC_EN0_R = 1 << (INT_UART0-16);
 
     //SYSTEM CONTROL MODULES
   //--------------------------------------------
      // Enable GPIO clocks for Register 1 [PORT_B], 2 [PORT_C], 3 [PORT_D] and 5 [PORT_F]
      SYSCTL_RCGCGPIO_R |=  SYSCTL_RCGCGPIO_R0 | SYSCTL_RCGCGPIO_R1 | SYSCTL_RCGCGPIO_R2 | SYSCTL_RCGCGPIO_R3 | SYSCTL_RCGCGPIO_R5;
 
-     // Enable Timer Clock for Timer 1, Timer 2 and Timer 3
-     SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R2 | SYSCTL_RCGCTIMER_R3 | SYSCTL_RCGCTIMER_R4;
+     // Enable Timer Clock for Timer 1, Timer 3 and Timer 4
+     SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R3;
 
      SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R1 | SYSCTL_RCGCWTIMER_R4;     //Enable Wide Timer Clock
      SYSCTL_RCGCACMP_R |=  0x00000001;                                       //Enable Analog Comparator Clock
      SYSCTL_RCGCHIB_R |= SYSCTL_RCGCHIB_R0;                                  //Enable Hibernation Clock
-     SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R0;                                  //Enable PWM Clocking
+     SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R0 | SYSCTL_RCGCPWM_R1;              //Enable PWM Clocking, auger and pump
      _delay_cycles(3);
   //---------------------------------------------
 
@@ -80,7 +95,7 @@ void initHw()
      TIMER1_CTL_R &= ~TIMER_CTL_TAEN;                     // turn-off timer before reconfiguring
      TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;               // configure as 32-bit timer (A+B)
      TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD;              // configure for periodic mode (count down)
-     TIMER1_TAILR_R = 400000000;                          // Timer Ticks # = Seconds x Clock Freq.
+     TIMER1_TAILR_R = S_TO_CYCLES(10);                    // Timer Ticks # = Seconds x Clock Freq.
      TIMER1_IMR_R = TIMER_IMR_TATOIM;                     // turn-on interrupts for timeout in timer module
      TIMER1_CTL_R |= TIMER_CTL_TAEN;                      // turn-on timer
      NVIC_EN0_R = 1 << (INT_TIMER1A-16);                  // turn-on interrupt 37 (TIMER1A)
@@ -92,40 +107,24 @@ void initHw()
      WTIMER1_TAMR_R = TIMER_TAMR_TAMR_1_SHOT | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
    //---------------------------------------------
 
-     //TIMER2 CONFIGURATION - Count Up Timer
-   //---------------------------------------------
-     TIMER2_CTL_R &= ~TIMER_CTL_TAEN;                            // turn-off counter before reconfiguring
-     TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;                      // Configured timer to be a 32 bit Timer 2
-     TIMER2_TAMR_R = TIMER_TAMR_TAMR_1_SHOT | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
-   //---------------------------------------------
-
-     //TIMER3 CONFIGURATION - One Shot Timer
+     //TIMER3 CONFIGURATION - One Shot Timer, pump run cutoff
      //---------------------------------------------
      TIMER3_CTL_R &= ~TIMER_CTL_TAEN;                            // turn-off counter before reconfiguring
      TIMER3_CFG_R = TIMER_CFG_32_BIT_TIMER;                      // Configured timer to be a 32 bit Timer 2
      TIMER3_TAMR_R = TIMER_TAMR_TAMR_1_SHOT | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
      TIMER3_IMR_R = TIMER_IMR_TATOIM;                            // turn-on interrupts for timeout in timer module
+     NVIC_EN1_R = 1 << (INT_TIMER3A-16-32);                      // turn-on interrupt 51 (TIMER3A)
      //---------------------------------------------
 
-     //WIDE TIMER CONFIGURATION - PERIOIDIC TIMER
+     //WIDE TIMER CONFIGURATION - One Shot Timer, PIR presence and hold-off
      //---------------------------------------------
        WTIMER4_CTL_R &= ~TIMER_CTL_TAEN;                            // turn-off counter before reconfiguring
-       WTIMER4_TAMR_R = TIMER_TAMR_TAMR_PERIOD| TIMER_TAMR_TACDIR;  // configure for edge count mode, count up
-       WTIMER4_TAILR_R = 80000000;                                  // configure interrupts to be fired every 2 seconds. 40M * 2 = 80M
+       WTIMER4_CFG_R = TIMER_CFG_16_BIT;                            // 32 bit half of the wide timer
+       WTIMER4_TAMR_R = TIMER_TAMR_TAMR_1_SHOT | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
        WTIMER4_IMR_R |= TIMER_IMR_TATOIM;                           // turn on interrupts for timeout in timer module
-       NVIC_EN3_R = 1 << (INT_WTIMER4A-16-96);                      // turn-on interrupt 37 (TIMER1A)
+       NVIC_EN3_R = 1 << (INT_WTIMER4A-16-96);                      // turn-on interrupt 118 (WTIMER4A)
      //---------------------------------------------
 
-      //TIMER3 CONFIGURATION - One Shot Timer
-      //---------------------------------------------
-       TIMER4_CTL_R &= ~TIMER_CTL_TAEN;                            // turn-off counter before reconfiguring
-       TIMER4_CFG_R = TIMER_CFG_32_BIT_TIMER;                      //Configured timer to be a 32 bit Timer 2
-       TIMER4_TAMR_R = TIMER_TAMR_TAMR_1_SHOT | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
-       TIMER4_TAILR_R = 100000000;                                 // Timer Ticks # = Seconds x Clock Freq. 10M = 5seconds
-       TIMER4_IMR_R = TIMER_IMR_TATOIM;                            // turn-on interrupts for timeout in timer module
-       NVIC_EN2_R = 1 << (INT_TIMER4A-16-64);                      // turn-on interrupt 37 (TIMER1A)
-      //---------------------------------------------
-
     //GPIO CONFIGURATIONS
   //---------------------------------------------
      //PORT F0 UNLOCKING
@@ -144,6 +143,14 @@ void initHw()
      GPIO_PORTD_DEN_R |= SPEAKER_MASK | TRIGGER_MASK;  //PORT D Digital Enable
      GPIO_PORTF_DEN_R |= PUMP_MASK;                    //PORT F Digital Enable
 
+     // PIR interrupt on both edges of PA2
+     GPIO_PORTA_IM_R &= ~SENSOR_MASK;                  //Masked while configuring
+     GPIO_PORTA_IS_R &= ~SENSOR_MASK;                  //Edge sensitive
+     GPIO_PORTA_IBE_R |= SENSOR_MASK;                  //Rising and falling edges
+     GPIO_PORTA_ICR_R = SENSOR_MASK;
+     GPIO_PORTA_IM_R |= SENSOR_MASK;
+     NVIC_EN0_R = 1 << (INT_GPIOA-16);                 //turn-on interrupt 16 (GPIOA)
+
      // Configure CO- Input
      GPIO_PORTC_AFSEL_R &= ~CO_NEG_MASK;                  // Disable Alternate Function
      GPIO_PORTC_AMSEL_R |= CO_NEG_MASK;                   // Enable Analog for CO_NEG_MASK
@@ -151,6 +158,11 @@ void initHw()
      //Configure Port B7 for the PWM
      GPIO_PORTB_AFSEL_R |= AUGER_MASK;                    // Enabling alternate function for AUGER
      GPIO_PORTB_PCTL_R |= GPIO_PCTL_PB7_M0PWM1;           // Port control for the AUGER
+
+     //Configure Port F0 for the PWM
+     GPIO_PORTF_AFSEL_R |= PUMP_MASK;                     // Enabling alternate function for PUMP
+     GPIO_PORTF_PCTL_R &= ~GPIO_PCTL_PF0_M;
+     GPIO_PORTF_PCTL_R |= GPIO_PCTL_PF0_M1PWM4;           // Port control for the PUMP
   //---------------------------------------------
 
     //ANALOG COMPARATOR CONFIGURATIONS
@@ -163,7 +175,7 @@ void initHw()
 }
 
 
-void timer1Isr()
+void startMeasurement()                          // One RC charge time measurement, analogISR gets the result
 {
     TRIGGER = 1;                                 //De-integrate the GPO pin
     waitMicrosecond(10);
@@ -174,80 +186,87 @@ void timer1Isr()
 
     COMP_ACINTEN_R |= COMP_ACINTEN_IN0;          //Enabling Interrupts for Comparator
     NVIC_EN0_R = 1 << (INT_COMP0-16);            //turn-on interrupt 37 (COMP0)
+}
+
+void timer1Isr()                                 //Starts a burst of measurements
+{
+    uint32_t start = isrEnter();
+    startMeasurement();
     TIMER1_ICR_R = TIMER_ICR_TATOCINT;           //clear interrupt flag
+    isrExit(ISR_TIMER1, start);
+}
+
+volatile uint32_t lastTicks = 0;            // Latest filtered comparator reading, used by "calibrate"
+volatile uint16_t lastLevel = 0;
+uint32_t suppressedTriggers = 0;            // Single readings that would have started the pump but the filtered level did not
+
+void drivePump(bool on, uint16_t duty)      // Applies the controller output, Timer 3 cuts off a run that goes on too long
+{
+    if(on)
+    {
+        PWM1_2_CMPA_R = duty;               // Takes effect at the next reload
+        if(!PUMP_ON)
+        {
+            TIMER3_TAV_R = 0;
+            TIMER3_TAILR_R = S_TO_CYCLES(getMaxRun());
+            TIMER3_CTL_R |= TIMER_CTL_TAEN;
+            PWM1_ENABLE_R |= PWM_ENABLE_PWM4EN;
+        }
+    }
+    else
+    {
+        TIMER3_CTL_R &= ~TIMER_CTL_TAEN;
+        PWM1_ENABLE_R &= ~PWM_ENABLE_PWM4EN;
+    }
 }
 
 void analogISR()
 {
+    uint32_t start = isrEnter();
     uint32_t time = 0;
-    float level = 0.0;
+    uint16_t level = 0;
     time = WTIMER1_TAV_R;                       //Give 'time' the value of the Wide Timer 1 (One Shot Timer)
     WTIMER1_CTL_R &= ~TIMER_CTL_TAEN;           //turn-off timer before reconfiguring
     COMP_ACMIS_R = 0x1;                         //Clear comparator interrupt
 
-    if(time >= 2000 && time <= 2100)
-    {
-        level = 0;
-    }
-    else if(time >= 2700 && time <= 2775)
-    {
-        level = 50;
-    }
-    else if(time >= 2800 && time <= 2900)
-    {
-        level = 100;
-    }
-    else if(time >= 2901 && time <= 3030)
-    {
-        level = 200;
-    }
-    else if(time >= 3075 && time <= 3150)
-    {
-        level = 300;
-    }
-    else if(time >= 3200 && time <= 3275)
-    {
-        level = 400;
-    }
-    else if(time >= 3276 && time <= 3375)
+    if(!addSample(time))                        //Median and moving average of a burst of readings, see the "filter" command
     {
-        level = 500;
+        startMeasurement();                     //Next reading of the burst
+        isrExit(ISR_COMP0, start);
+        return;
     }
-    else if(time >= 3376 && time <= 3499)
-    {
-        level = 600;
-    }
-    else
-    {
-        //level = (time - 2709)/(1.24);             //Linear regression formula for detecting unknown ticks
-        level = 0;
-    }
-//    char why[90];                                 //Print out ticks and water level to the interface
-//    snprintf(why, sizeof(why), "Period: %7"PRIu32" (us)\t WaterLevel: %.2f (mL)\n", time, level);
-//    putsUart0(why);
+    time = getFilteredTicks();
+    level = ticksToLevel(time);                 //Calibration table lookup, see the "calibrate" command
+    lastTicks = time;
+    lastLevel = level;
+
+//    printUart0("Period: %7u (us)\t WaterLevel: %d (mL)\n", time, level);    //Print out ticks and water level to the interface
 
     uint8_t mode = 0;                               //Reading the mode and water level setting from the EEPROM
-    mode = readEeprom((16*0)+7);
+    mode = readEepromCache((16*0)+7);
     uint16_t volume = 0;
-    volume = readEeprom((16*0)+6);
+    volume = readEepromCache((16*0)+6);
 
-    if(mode == 1)                                   //AUTO mode turns on the pump when the water level in
-    {                                               //the bowl is lower than the water level set by the user
-        if(level < volume)  
-        {
-           PUMP = 1;
-           TIMER3_CTL_R |= TIMER_CTL_TAEN;         //Timer 3 enabled
-           NVIC_EN1_R = 1 << (INT_TIMER3A-16-32);  // turn-on interrupt 37 (TIMER1A)
-        }
-        else if(level == volume)                   //Do nothing if in AUTO mode and level is same as water setting
-        {
-            PUMP = 0;
-        }
+    if((mode == 1) && (ticksToLevel(getFirstSample()) < volume) && (level >= volume))
+    {
+        suppressedTriggers++;
     }
-    else if(mode == 2)                             //MOTION mode turns on Wide Timer 4 to trigger the 2 second interrupt 
+    bool motion = motionDemand();                  //Pet there or visited since the last level
+    bool wasOn = PUMP_ON;
+    if((mode != 1) && (mode != 2))
     {
-        WTIMER4_CTL_R |= TIMER_CTL_TAEN;
+        volume = 0;                                //Water off, a running fill stops
     }
+    //AUTO mode refills whenever the level drops below the band, MOTION mode only when the PIR saw
+    //motion. Either way the pump then runs until the level reaches the water setting, see "pump".
+    drivePump(updatePump(level, volume, (mode == 1) || ((mode == 2) && motion), HIB_RTCC_R), getPumpDuty(level, volume));
+    if((mode == 2) && PUMP_ON && !wasOn)
+    {
+        motionPumpStarted(getCycles());            //Edge to pump latency, see "motion"
+        visitPumped();
+    }
+    TIMER1_TAILR_R = MS_TO_CYCLES(nextSamplePeriod(level, volume, PUMP_ON));  //Fast while filling or moving, slower while steady
+    isrExit(ISR_COMP0, start);
 
 //    if(level < volume)                            //Speaker/Alarm goes off in AUTO mode
 //    {
@@ -262,331 +281,1455 @@ void analogISR()
 //    }
 }
 
-void alarmISR()                             // Hibernate ISR 
+const char* dayNames[7] = {"sun", "mon", "tue", "wed", "thu", "fri", "sat"};
+
+uint8_t parseWeekday(const char* text)      // Day name to weekday number, 7 when it is not a day
 {
-    float speed = 0;
-    uint16_t pwm = 0;
-    uint16_t dur = 0;
-    uint16_t block = 0;
-    dur = readEeprom((16*block)+1);          // Access the duration field of block 0 from the EEPROM.
-    pwm = readEeprom((16*block)+2);          // Access the PWM field of block 0 from the EEPROM.
+    uint8_t day = 0;
+    for(day = 0; (text != NULL) && (day < 7); day++)
+    {
+        if(cmpStr(text, dayNames[day]) == 0)
+        {
+            break;
+        }
+    }
+    return (text != NULL) ? day : 7;
+}
+
+const char* isrNames[ISR_COUNT] = {"Timer 1", "Comparator", "UART0", "Timer 3", "Hibernate", "Wide timer 4", "SysTick", "PIR edge", "Auger PWM"};
+
+const char* wakeNames[3] = {"power-up", "RTC alarm", "WAKE pin"};
 
-    TIMER2_TAILR_R = dur * 40000000;         // Duration x System Clock to get the ticks needed to be run.
-    TIMER2_CTL_R |= TIMER_CTL_TAEN;          // Timer 2 is enabled and starts counting until the required ticks.
-    TIMER2_IMR_R = TIMER_IMR_TATOIM;         // Turn-on interrupts for timeout in timer module.
-    NVIC_EN0_R = 1 << (INT_TIMER2A-16);      // Storing the Timer 2 interrupt.
+const char* pumpStateNames[3] = {"idle", "filling", "resting"};
 
-    speed = (pwm/100.0)*1023;                // Stores the duty cycle of the motor.
-    PWM0_0_CMPB_R = speed;                   // The compare register uses the duty cycle value to control the speed of the motor.
+const char* motionStateNames[4] = {"idle", "pending", "present", "hold-off"};
 
+const char* importErrorNames[7] = {"", "Start with 'schedule import begin'", "Records must be 18 hex digits each", "A record has a time, repeat or speed out of range",
+                                   "An event appears twice", "Count or check does not match, nothing was changed", "EEPROM has no room for the schedule, nothing was changed"};
+
+const char* parseErrorNames[6] = {"", "too many fields", "number does not fit or has letters in it", "time must be HH:MM from 00:00 to 23:59", "missing closing quote", "unexpected character"};
+
+#define FIRED_MAX 4                         // More than one is waiting only while the EEPROM is too full to clear them
+
+typedef struct _FIRED_EVENT
+{
+    uint16_t event;
+    uint32_t record[EVENT_WORDS];           // Time and action words the event fired with
+} FIRED_EVENT;
+
+FIRED_EVENT firedEvents[FIRED_MAX];         // One-time events that have dispensed, cleared by endFeed
+uint8_t firedCount = 0;
+bool feeding = false;                       // From runAuger until endFeed, alarms in between wait for endFeed
+const uint32_t clearedEvent[EVENT_WORDS] = {0xFFFFFFFF, 0xFFFFFFFF};
+
+void alarmISR()                             // Hibernate ISR, the feed itself is started by the main loop
+{
+    uint32_t start = isrEnter();
     while(!(HIB_CTL_R & HIB_CTL_WRC));       // Wait until the write cycle of the HIB module is complete.
     HIB_IC_R |= HIB_RIS_RTCALT0;             // Clear the hibernate module interrupt for the RTC alarm.
-    putsUart0("Matched. \n");
+    postWork(WORK_ALARM, 0);
+    isrExit(ISR_HIB, start);
 }
 
-void timer2ISR()                             // Timer 2 ISR
-{
-    uint8_t i = 0;
-    putsUart0("Triggered. \n");
-
-    PWM0_0_CMPB_R = 0;
-    TIMER2_ICR_R |= TIMER_ICR_TATOCINT;      // Clear the Timer 2 interrupt.
-    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;         // Disables the timer.
+USER_DATA rxLine;                           // Line being typed, assembled by the main loop from the rx ring
+FRAME rxFrame;                              // Binary frame being received
+bool binaryMode = false;                    // UART0 carries frames instead of text, see "binary"
+volatile bool rxPosted = false;             // WORK_RX is queued and the main loop has not started draining yet
 
-    writeEeprom((16*0)+5, 0x0);              // Active flag is set to 0 and block 0 is cleared.
-    for(i = 0; i < 5; i++)
+void uart0ISR()                             // UART0 ISR, moves characters between the FIFOs and the rings
+{
+    uint32_t start = isrEnter();
+    if(serviceUart0() && !rxPosted)
     {
-        writeEeprom((16*0)+i, 0xFFFFFFFF);
+        rxPosted = postWork(WORK_RX, 0);    // Retried on the next interrupt if the queue is full
     }
-
-    sortEvent();                            // Sorts the event and now the block 1 becomes block 0.
-    AlarmTime();                            // Puts the next alarm into the Match Register, aka, reseeding.
+    isrExit(ISR_UART0, start);
 }
 
-void timer3ISR()
+void endFeed();
+
+void runAuger(uint16_t pwm, uint32_t ms)    // Ramps the auger up to the speed and back down after ms
 {
-    PUMP = 0;
-    TIMER3_ICR_R |= TIMER_ICR_TATOCINT;     // Clear the Timer 2 interrupt
+    feeding = true;
+    PWM0_0_INTEN_R &= ~PWM_0_INTEN_INTCNTLOAD;
+    startProfile(Q16_SCALE(Q16_RATIO(pwm, 100), PWM_FULL), ms);
+    if(!profileRunning())                    // Nothing to dispense, e.g. the auger lost its calibration
+    {
+        endFeed();
+        return;
+    }
+    PWM0_0_ISC_R = PWM_0_ISC_INTCNTLOAD;
+    PWM0_0_INTEN_R |= PWM_0_INTEN_INTCNTLOAD;   // augerISR steps the profile, endFeed runs when it is done.
 }
 
-void Wide4ISR()                             // WIDE TIMER 4 ISR runs every two seconds in MOTION mode
+void startFeed()                            // Runs the auger for the earliest event when the alarm matches
 {
-    uint8_t mode = 0;
-    mode = readEeprom((16*0)+7);            // Reads the fill mode
+    uint16_t pwm = 0;
+    uint16_t dur = 0;
+    uint16_t event = 0;
+    uint32_t action = 0;
+    if(feeding)
+    {
+        return;                              // endFeed re-arms the alarm, the event fires after the running feed
+    }
+    event = getNextEvent();                  // The match register always holds the earliest event.
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    if((event == NO_EVENT) || (getNextFireTime() > HIB_RTCC_R))
+    {
+        AlarmTime();                         // The schedule changed after the alarm was set.
+        return;
+    }
+    putsUart0("Matched. \n");
+    if(((readEepromCache(EVENT_TIME(event)) >> TIME_RULE_S) & TIME_RULE_M) == RULE_ONCE)
+    {
+        if(firedCount < FIRED_MAX)
+        {
+            firedEvents[firedCount].event = event;   // Deleted once it has dispensed.
+            readEepromCacheBlock(EVENT_TIME(event), firedEvents[firedCount].record, EVENT_WORDS);
+            firedCount++;
+        }
+        removeEvent(event);                  // The next event in the heap becomes the earliest one.
+    }
+    else
+    {
+        rescheduleEvent(event);              // Repeating events move to their next occurrence, the EEPROM is untouched.
+    }
+    action = readEepromCache(EVENT_ACTION(event));
+    dur = action & ACTION_DURATION_M;        // Access the duration field of the event from the EEPROM.
+    pwm = (action >> ACTION_PWM_S) & ACTION_PWM_M;  // Access the PWM field of the event from the EEPROM.
 
-    uint8_t MotionDetected = 0;
-    MotionDetected = SENSOR;                // MotionDetected stores the PIR Sensor values.
+    if(action & ACTION_GRAMS)                // Portion, the auger calibration gives the run time at this speed
+    {
+        runAuger(pwm, portionToMs(dur, pwm, getRampMs()));
+    }
+    else
+    {
+        runAuger(pwm, dur * 1000);
+    }
+}
 
-    if((mode == 2))                         // MOTION Mode turns the water pump on when motion is detected
+void augerISR()                             // PWM0 generator 0 reloaded, the compare register follows the auger profile
+{
+    uint32_t start = isrEnter();
+    uint16_t duty = 0;
+    PWM0_0_ISC_R = PWM_0_ISC_INTCNTLOAD;
+    if(profileLoad(&duty))                  // Every 10 ms
     {
-        if((MotionDetected == 1) )
+        PWM0_0_CMPB_R = duty;               // Takes effect at the next reload
+        if(!profileRunning())
         {
-            PUMP = 1;
-            TIMER4_CTL_R |= TIMER_CTL_TAEN;
+            PWM0_0_INTEN_R &= ~PWM_0_INTEN_INTCNTLOAD;
+            postWork(WORK_FEED, 0);
         }
     }
-    WTIMER4_ICR_R |= TIMER_ICR_TATOCINT;      //Clear the Timer 2 interrupt
-
+    isrExit(ISR_PWM0, start);
 }
 
-void Timer4ISR()                            
+void clearFiredEvents()                     // Clears the one-time events that fired, unless their slot was rewritten since
 {
-    PUMP = 0;
-    TIMER4_ICR_R |= TIMER_ICR_TATOCINT;      //Clear the Timer 2 interrupt
+    uint8_t i = 0;
+    uint8_t kept = 0;
+    for(i = 0; i < firedCount; i++)
+    {
+        uint16_t event = firedEvents[i].event;
+        uint32_t record[EVENT_WORDS];
+        readEepromCacheBlock(EVENT_TIME(event), record, EVENT_WORDS);
+        if((record[0] != firedEvents[i].record[0]) || (record[1] != firedEvents[i].record[1]))
+        {
+            continue;                       // "feed", an import or a binary client put a new event there, it stays
+        }
+        if(writeEepromCacheBlock(EVENT_TIME(event), clearedEvent, EVENT_WORDS))  // Time word first
+        {
+            removeEvent(event);             // A re-sort during the feed put it back into the heap
+        }
+        else
+        {
+            firedEvents[kept++] = firedEvents[i];   // EEPROM full, tried again after the next feed
+        }
+    }
+    firedCount = kept;
 }
-//-----------------------------------------------------------------------------
-// Main
-//-----------------------------------------------------------------------------
 
-int main(void)
+void endFeed()                              // Stops the auger, clears fired one-time events and arms the alarm for the next one
 {
-    USER_DATA data;
-    initHw();
-    initEeprom();
-    initHIB();
-    initPWM();
+    PWM0_0_INTEN_R &= ~PWM_0_INTEN_INTCNTLOAD;
+    stopProfile();
+    PWM0_0_CMPB_R = 0;
+    putsUart0("Triggered. \n");
+    feeding = false;
+    clearFiredEvents();
+    AlarmTime();                            // Puts the next alarm into the Match Register, aka, reseeding.
+}
 
-    uint16_t event = 0;
-    uint16_t duration = 0;
-    uint16_t PWM = 0;
-    uint16_t hour = 0;
-    uint16_t mins = 0;
-    int32_t RTCtime = 0;
-    char str[60];
-    int32_t HH = 0;
-    int32_t MM = 0;
-    putsUart0("Enter instructions:\n");
+void timer3ISR()                            // The pump ran for the maximum time without reaching the level
+{
+    uint32_t start = isrEnter();
+    cutoffPump(HIB_RTCC_R);
+    PWM1_ENABLE_R &= ~PWM_ENABLE_PWM4EN;
+    TIMER3_ICR_R |= TIMER_ICR_TATOCINT;     // Clear the Timer 3 interrupt
+    isrExit(ISR_TIMER3, start);
+}
 
-    while(true)
+void armMotionTimer(uint16_t ms)            // One-shot for the PIR presence and hold-off waits, 0 stops it
+{
+    WTIMER4_CTL_R &= ~TIMER_CTL_TAEN;
+    if(ms != 0)
     {
-        bool valid = false;
-        uint8_t EventActive = 1;
-        getsUart0(&data);
-        putcUart0('\n');
-        parseFields(&data);
+        WTIMER4_TAV_R = 0;
+        WTIMER4_TAILR_R = MS_TO_CYCLES(ms);
+        WTIMER4_CTL_R |= TIMER_CTL_TAEN;
+    }
+}
 
-        if(isCommand(&data, "time", 2))             // Extracts the time values from user input on the interface using UART
+void checkVisit()                           // Logs visits, MOTION mode measures the bowl as soon as one is confirmed
+{
+    uint8_t change = motionChange();
+    if(change == VISIT_STARTED)
+    {
+        startVisit(HIB_RTCC_R);
+        if(readEepromCache((16*0)+7) == 2)
         {
-            valid = true;
-            int32_t HOURS = getFieldInteger(&data, 1);
-            int32_t MINS =  getFieldInteger(&data, 2);
-
-            if(((HOURS < 24) && (MINS <= 59)) || ((HOURS == 0) && (MINS <= 59)))    // Valid time range is loaded into the RTCLD register 
-            {                                                                       // for the clock to start counting up
-                while(!(HIB_CTL_R & HIB_CTL_WRC));
-                HIB_RTCLD_R = ((3600 * HOURS) + (MINS * 60));
-            }
-            else
+            TIMER1_TAILR_R = MS_TO_CYCLES(sampleSoon());
+            if(!(WTIMER1_CTL_R & TIMER_CTL_TAEN))   // Unless a burst is already running
             {
-                putsUart0("Invalid time value has been input.\n");
+                startMeasurement();
             }
-            sortEvent();
         }
+    }
+    else if(change == VISIT_ENDED)
+    {
+        endVisit(HIB_RTCC_R);
+        postWork(WORK_VISIT, 0);            // The main loop folds it into the hourly counts
+    }
+}
 
-        else if(isCommand(&data, "time", 0))            // Displays the time when "time" is entered on the interface
-        {
-            valid = true;
-            while(!(HIB_CTL_R & HIB_CTL_WRC));
-            RTCtime = HIB_RTCC_R;                       // Stores the value from the RTCC
+void pirISR()                               // PA2 changed, the PIR output went up or down
+{
+    uint32_t start = isrEnter();
+    GPIO_PORTA_ICR_R = SENSOR_MASK;
+    armMotionTimer(motionEdge(SENSOR, start));
+    checkVisit();
+    isrExit(ISR_PIR, start);
+}
 
-            HH = RTCtime / 3600;                        // Converts the seconds into hours
-            MM = (RTCtime % 3600) / 60;                 // Converts the remaining seconds into minutes
-            HH = HH % 48;                               // Sets a 2 day limit for the RTCC (to account for the next day events)
-            MM = MM % 60;
+void Wide4ISR()                             // WIDE TIMER 4 ISR ends the PIR presence or hold-off wait
+{
+    uint32_t start = isrEnter();
+    WTIMER4_ICR_R |= TIMER_ICR_TATOCINT;
+    armMotionTimer(motionTimeout(SENSOR));
+    checkVisit();
+    isrExit(ISR_WTIMER4, start);
+}
 
-            snprintf(str, sizeof(str), "Real Time is %02d:%02d\n", HH, MM);
-            putsUart0(str);  //displayed in seconds
-        }
+typedef struct _SETTING
+{
+    uint16_t word;                          // EEPROM cache word
+    bool (*valid)(uint32_t setting);        // Range check, NULL when every value is valid
+    void (*apply)(uint32_t setting);        // Loads the new value, NULL when it is only read where it is used
+} SETTING;
 
-        else if(isCommand(&data, "feed", 5))            // Lets the user add feeding schedules
-        {                                               // Usage: feed 'index' 'duration to run motor (secs)' 'motor speed' 'time to run'
-            valid = true;                               // Example: "feed 0 10 99 5:10"
-            event = getFieldInteger(&data, 1);
-            duration = getFieldInteger(&data, 2);
-            PWM = getFieldInteger(&data, 3);
-            hour = getFieldInteger(&data, 4);
-            mins = getFieldInteger(&data, 5);
+bool validLevel(uint32_t setting)           // Water level in ml, 0 turns the water off
+{
+    return setting <= 0xFFFF;
+}
 
-            if((event < 10) && (hour < 24) && (mins < 60))            // If user enters event index and hours/mins in a valid range then execute
-            {
-                uint32_t secondsCompare = (hour * 3600) + (mins * 60); // For the case if user enters time lesser than the current time.
-                if(secondsCompare < HIB_RTCC_R)                        // Sets that specific feeding schedule to the next day.
-                {
-                    hour += 24;
-                }
+bool validFillMode(uint32_t setting)        // 0 off, 1 auto, 2 motion
+{
+    return setting <= 2;
+}
 
-                writeEeprom((16 * event), event);        // index field
-                writeEeprom((16 * event) + 1, duration); // duration: Amount of time to run in seconds
-                writeEeprom((16 * event) + 2, PWM);      // pwm: Motor speed (50-100 duty cycle)
-                writeEeprom((16 * event) + 3, hour);     // hours
-                writeEeprom((16 * event) + 4, mins);     // minutes
-                writeEeprom((16 * event) + 5, EventActive); //Event Activated == Active Flag is set to 1, i.e, the event is active (background)
-                putsUart0("The event has been scheduled.\n");
+bool validSwitch(uint32_t setting)          // Alert mode and power, 0 off or 1 on
+{
+    return setting <= 1;
+}
 
-                sortEvent();
-                AlarmTime();
-            }
-            else if(event > 10)
-            {
-                putsUart0("Event specified is out of range. Enter event between 0-9.\n");
-            }
-            else if(hour > 24 || mins > 60)
-            {
-                putsUart0("Enter time between 0:01 and 23:59.\n");
-            }
+const SETTING settings[] =                  // Words the commands and the binary protocol may change
+{
+    {(16*0)+6, validLevel, NULL},           // Water level
+    {(16*0)+7, validFillMode, NULL},        // Fill mode
+    {(16*0)+8, validSwitch, NULL},          // Alert mode
+    {SETTING_POWER, validSwitch, NULL},
+    {SETTING_FILTER, validFilterSetting, initLevelFilter},
+    {SETTING_SAMPLE, validSampleSetting, initSampleRate},
+    {SETTING_PUMP, validPumpSetting, initPumpControl},
+    {SETTING_MOTION, NULL, initMotion},     // Two 16 bit times
+    {SETTING_AUGER, NULL, initAuger},       // Four 8 bit fields
+    {SETTING_PUMP_SPEED, validPumpSpeedSetting, initPumpSpeed},
+};
+#define SETTING_COUNT (sizeof(settings) / sizeof(settings[0]))
+
+int8_t findSetting(uint16_t word)
+{
+    uint8_t i = 0;
+    for(i = 0; i < SETTING_COUNT; i++)
+    {
+        if(settings[i].word == word)
+        {
+            return i;
         }
+    }
+    return -1;
+}
 
-        else if(isCommand(&data, "feed", 2))                // To delete the entered feeding schedule using event index
-        {                                                   // Since EEPROM is sorted, delete feeding schedule after viewing sorted schedule
-            uint32_t deleteEvent = getFieldInteger(&data, 1);
-            char* deleteText = getFieldString(&data, 2);
+uint8_t changeSetting(uint16_t word, uint32_t value)    // Stores a setting and applies it, shared by the text and binary commands
+{
+    int8_t i = findSetting(word);
+    if((i < 0) || ((settings[i].valid != NULL) && !settings[i].valid(value)))
+    {
+        return STATUS_VALUE;
+    }
+    if(!writeEepromCache(word, value))
+    {
+        return STATUS_FULL;
+    }
+    if(settings[i].apply != NULL)
+    {
+        settings[i].apply(readEepromCache(word));
+    }
+    return STATUS_OK;
+}
 
-            if(deleteText != NULL && cmpStr(deleteText, "delete") == 0) // Compares if the second argument is "delete"
-            {
-                if(deleteEvent < 10)
-                {
-                    valid = true;
-                    putsUart0("Event has been deleted.\n");
-                    EventActive = 0;
-                    uint8_t i = 0;
-                    for(i = 0; i < 5; i++)
-                    {
-                        char strr[40];
-                        writeEeprom((16*deleteEvent)+i, 0xFFFFFFFF);                            // Writes '0' for the feeding schedule
-                        writeEeprom((16*deleteEvent)+5, 0x0);                                   // Sets the feeding schedule to inactive
-                        snprintf(strr, sizeof(strr), "%d\t", readEeprom((16*deleteEvent)+i));   
-                        putsUart0(strr);
-                    }
-                    sortEvent();
-                    putsUart0("\n");
-                    AlarmTime();
-                }
+void setClock(uint32_t seconds)             // Sets the time of day, keeping the weekday, and re-arms the schedule
+{
+    uint32_t before = HIB_RTCC_R;
+    uint8_t weekday = getWeekday(before);
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    HIB_RTCLD_R = seconds;
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    setWeekday(weekday);                    // The RTC restarts at day 0, keep today's weekday
+    restartAwakeClock(before);
+    rebaseVisits(before, seconds);          // Hourly visit counts follow the clock
+    sortEvent();                            // Fire times are RTC seconds, recompute them
+    AlarmTime();
+}
 
-                else
-                {
-                    putsUart0("Enter a valid event range.\n");
-                }
-            }
+uint8_t storeEvent(uint16_t event, uint32_t time, uint32_t action)   // Stores an event record and arms the alarm for it
+{
+    if((event >= MAX_EVENTS) || !validEventRecord(time, action))
+    {
+        return STATUS_VALUE;
+    }
+    if(writeEepromCache(EVENT_ACTION(event), action) && writeEepromCache(EVENT_TIME(event), time))  // The time word activates the event
+    {
+        insertEvent(event);
+        AlarmTime();
+        return STATUS_OK;
+    }
+    if(readEepromCache(EVENT_TIME(event)) == 0xFFFFFFFF)
+    {
+        writeEepromCache(EVENT_ACTION(event), 0xFFFFFFFF);   // Drops the half-written event
+    }
+    return STATUS_FULL;
+}
 
-            else
-            {
-                putsUart0("Feeding Event has not been deleted.\nUsage: 'feed' [event #] 'delete'\n");
-            }
-        }
+void deleteEvent(uint16_t event)            // Clears the time (inactive) and then the action
+{
+    writeEepromCacheBlock(EVENT_TIME(event), clearedEvent, EVENT_WORDS);
+    removeEvent(event);
+    AlarmTime();
+}
 
-        else if(isCommand(&data, "schedule", 0))                // Displays the feeding schedules
-        {
-            valid = true;
-            sortEvent();
-            putsUart0("Event \t Duration      PWM \t HH:MM\n");
+void scheduleEvent(uint16_t event, uint32_t action, uint16_t hour, uint16_t mins)  // Stores a daily event, used by "feed" and "portion"
+{
+    uint8_t status = STATUS_VALUE;
+    if((hour < 24) && (mins < 60))                            // The event repeats daily, see "repeat" to change it
+    {
+        status = storeEvent(event, (hour * 60) + mins + (RULE_DAILY << TIME_RULE_S), action);
+    }
 
-            char inputData[40];
-            int eNum = 0;
-            for(eNum = 0; eNum < 10; eNum++)
-            {
-                if((readEeprom(16*eNum) == 0xFFFFFFFF) && (readEeprom(16*eNum+5) == 0)) // Displays message if all the blocks have the value of 0
-                {
-                    putsUart0("\nNo events scheduled.\n");
-                }
-                else if(EventActive == readEeprom(16*eNum+5)) // Displays the feeding schedules if there is an active schedule  
-                {
-                    uint16_t NewHours = 0;
-                    if(readEeprom(16*eNum+3) > 24)            // Converts the next day event (23:59+)in a range of 0-24
-                    {
-                        NewHours = readEeprom(16*eNum+3) % 24;
-                    }
-                    else if(readEeprom(16*eNum+3) < 24)       // Reads the exact value if inside 24 hours
-                    {
-                        NewHours = readEeprom(16*eNum+3);
-                    }
+    if(status == STATUS_OK)
+    {
+        putsUart0("The event has been scheduled.\n");
+    }
+    else if(status == STATUS_FULL)
+    {
+        putsUart0("EEPROM is full. Delete an event before adding another.\n");
+    }
+    else if(event >= MAX_EVENTS)
+    {
+        putsUart0("Event specified is out of range. Enter event between 0-255.\n");
+    }
+    else if((hour >= 24) || (mins >= 60))
+    {
+        putsUart0("Enter time between 0:01 and 23:59.\n");
+    }
+    else
+    {
+        putsUart0("Enter a motor speed between 0 and 100.\n");
+    }
+}
 
-                    snprintf(inputData, sizeof(inputData), "  %d\t    %02d \t\t%02d\t %02d:%02d\n", readEeprom(16*eNum), readEeprom(16*eNum+1), readEeprom(16*eNum+2), NewHours, readEeprom(16*eNum+4)); //event
-                    putsUart0(inputData);
-                }
-            }
-            putsUart0("\n");
-            AlarmTime();
-        }
+void setTime(USER_DATA* data)               // Extracts the time values from user input on the interface using UART
+{
+    uint16_t HOURS = 0;
+    uint16_t MINS = 0;
 
-        else if(isCommand(&data, "water", 1))           // Sets the water level and writes the level into the EEPROM
-        {
-            valid = true;
-            uint16_t volume = 0;
-            volume = getFieldInteger(&data, 1);
+    if(getFieldTime(data, 1, &HOURS, &MINS))                                // Valid time range is loaded into the RTCLD register
+    {                                                                       // for the clock to start counting up
+        setClock((3600 * HOURS) + (MINS * 60));
+    }
+    else
+    {
+        putsUart0("Invalid time value has been input.\n");
+    }
+}
 
-            if(volume > 0)
-            {
-                writeEeprom((16*0)+6, volume);
-                char waterlevel[70];
-                snprintf(waterlevel, sizeof(waterlevel), "Water level regulation has been set to %d\n", volume);
-                putsUart0(waterlevel);
-            }
-            else
-            {
-                writeEeprom((16*0)+6, 0x0);
-            }
-        }
+void showTime(USER_DATA* data)              // Displays the time when "time" is entered on the interface
+{
+    int32_t RTCtime = 0;
+    int32_t HH = 0;
+    int32_t MM = 0;
 
-        else if(isCommand(&data, "fill", 1))              // Sets the mode to be either AUTO or MOTION for the water to be filled.
-        {
-            valid = true;
-            uint8_t modeFlag = 0;
-            char* mode = getFieldString(&data, 1);
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    RTCtime = HIB_RTCC_R;                       // Stores the value from the RTCC
 
-            if(mode != NULL && cmpStr(mode, "auto") == 0)
-            {
-                modeFlag = 1;
-                putsUart0("Fill mode has been set to AUTO.\n");
-            }
-            else if(mode != NULL && cmpStr(mode, "motion") == 0)
-            {
-               modeFlag = 2;
-               putsUart0("Fill mode has been set to MOTION.\n");
-            }
-            else
-            {
-                putsUart0("Please choose the mode as 'auto' or 'motion'\n");
-            }
+    HH = (RTCtime % SECONDS_PER_DAY) / 3600;    // Converts the seconds of today into hours
+    MM = (RTCtime % 3600) / 60;                 // Converts the remaining seconds into minutes
 
-            writeEeprom((16*0)+ 7, modeFlag);
-        }
+    printUart0("Real Time is %s %02d:%02d\n", dayNames[getWeekday(RTCtime)], HH, MM);  //displayed in seconds
+}
 
-        else if(isCommand(&data, "alert", 1))               // Sets the Alert mode to alert pet owner about low water alarm
-        {
-            valid = true;
-            uint8_t lowWaterAlarm = 0;
-            char* alertmode = getFieldString(&data, 1);
+void addFeed(USER_DATA* data)               // Lets the user add feeding schedules
+{                                           // Example: "feed 0 10 99 5:10"
+    uint16_t event = getFieldInteger(data, 1);
+    uint16_t duration = getFieldInteger(data, 2);
+    uint16_t PWM = getFieldInteger(data, 3);
+    uint16_t hour = 24;                         // Out of range unless the time reads
+    uint16_t mins = 0;
+    getFieldTime(data, 4, &hour, &mins);
+    PWM = (PWM > ACTION_PWM_M) ? ACTION_PWM_M : PWM;  // Out of range, not wrapped into it
+    scheduleEvent(event, (duration & ACTION_DURATION_M) | ((uint32_t)PWM << ACTION_PWM_S), hour, mins);
+}
 
-            if((alertmode != NULL && cmpStr(alertmode, "ON") == 0) || (alertmode != NULL && cmpStr(alertmode, "on") == 0))
-            {
-                lowWaterAlarm = 1;
-                putsUart0("Alert mode has been turned ON\n");
-            }
+void addPortion(USER_DATA* data)            // Adds a feeding schedule that dispenses a weight instead of a run time
+{                                           // Example: "portion 0 40 80 5:10"
+    uint16_t event = getFieldInteger(data, 1);
+    uint16_t duration = getFieldInteger(data, 2);
+    uint16_t PWM = getFieldInteger(data, 3);
+    uint16_t hour = 24;                         // Out of range unless the time reads
+    uint16_t mins = 0;
+    getFieldTime(data, 4, &hour, &mins);
+    PWM = (PWM > ACTION_PWM_M) ? ACTION_PWM_M : PWM;
+    if(getPortionRate(PWM) == 0)
+    {
+        putsUart0("Calibrate the auger first, see 'calibrate auger'.\n");
+    }
+    else
+    {
+        scheduleEvent(event, ACTION_GRAMS | (duration & ACTION_DURATION_M) | ((uint32_t)PWM << ACTION_PWM_S), hour, mins);
+    }
+}
 
-            if((alertmode != NULL && cmpStr(alertmode, "OFF") == 0) || (alertmode != NULL && cmpStr(alertmode, "off") == 0))
+void deleteFeed(USER_DATA* data)            // To delete the entered feeding schedule using event index
+{
+    uint32_t eventIndex = getFieldInteger(data, 1);
+    char* deleteText = getFieldString(data, 2);
+
+    if(deleteText != NULL && cmpStr(deleteText, "delete") == 0) // Compares if the second argument is "delete"
+    {
+        if(eventIndex < MAX_EVENTS)
+        {
+            putsUart0("Event has been deleted.\n");
+            uint8_t i = 0;
+            uint32_t record[EVENT_WORDS];
+            deleteEvent(eventIndex);
+            readEepromCacheBlock(EVENT_TIME(eventIndex), record, EVENT_WORDS);
+            for(i = 0; i < EVENT_WORDS; i++)
             {
-                lowWaterAlarm = 0;
-                putsUart0("Alert mode has been turned OFF\n");
+                printUart0("%d\t", record[i]);
             }
-            writeEeprom((16*0)+ 8, lowWaterAlarm);
+            putsUart0("\n");
         }
 
-        else if(isCommand(&data, "setting", 0))             // Displays the set water level, fill mode and alert mode
+        else
         {
-            valid = true;
-            uint16_t watervolume = readEeprom((16*0)+6);
-            uint16_t fillmode = readEeprom((16*0)+7);
-            uint16_t alertmode = readEeprom((16*0)+8);
+            putsUart0("Enter a valid event range.\n");
+        }
+    }
+
+    else
+    {
+        putsUart0("Feeding Event has not been deleted.\nUsage: 'feed' [event #] 'delete'\n");
+    }
+}
+
+void setRepeat(USER_DATA* data)             // Sets how often a stored event fires
+{                                           // Example: "repeat 0 mon wed fri"
+    uint32_t repeatEvent = getFieldInteger(data, 1);
+    char* ruleText = getFieldString(data, 2);
+    uint32_t rule = 0xFF;
+    uint32_t arg = 0;
+
+    if(cmpStr(ruleText, "once") == 0)
+    {
+        rule = RULE_ONCE;
+    }
+    else if(cmpStr(ruleText, "daily") == 0)
+    {
+        rule = RULE_DAILY;
+    }
+    else if(cmpStr(ruleText, "every") == 0)
+    {
+        arg = getFieldInteger(data, 3);
+        if((arg >= 1) && (arg <= 24))
+        {
+            rule = RULE_HOURS;
+        }
+    }
+    else
+    {
+        uint8_t field = 0;
+        for(field = 2; field < data->fieldCount; field++)    // Each day name adds its bit to the mask
+        {
+            uint8_t day = parseWeekday(getFieldString(data, field));
+            if(day > 6)
+            {
+                arg = 0;
+                break;
+            }
+            arg |= 1 << day;
+        }
+        if(arg != 0)
+        {
+            rule = RULE_WEEKDAYS;
+        }
+    }
+
+    if((repeatEvent >= MAX_EVENTS) || (readEepromCache(EVENT_TIME(repeatEvent)) == 0xFFFFFFFF))
+    {
+        putsUart0("Event is not scheduled. Check the index with 'schedule'.\n");
+    }
+    else if(rule == 0xFF)
+    {
+        putsUart0("Usage: 'repeat' [event #] once | daily | every [1-24] | [sun mon tue wed thu fri sat]\n");
+    }
+    else
+    {
+        uint32_t time = (readEepromCache(EVENT_TIME(repeatEvent)) & TIME_MINUTES_M) | (rule << TIME_RULE_S) | (arg << TIME_ARG_S);
+        if(storeEvent(repeatEvent, time, readEepromCache(EVENT_ACTION(repeatEvent))) == STATUS_OK)
+        {
+            putsUart0("The event repeat has been updated.\n");
+        }
+        else
+        {
+            putsUart0("EEPROM is full. Delete an event before changing another.\n");
+        }
+    }
+}
 
-            char lol[80];
-            snprintf(lol, sizeof(lol), "Volume = %d ml\nFill Mode is %d\nAlert mode is %d\n", watervolume, fillmode, alertmode);
-            putsUart0(lol);
+void setDayOfWeek(USER_DATA* data)          // Sets the day of the week used by weekday rules
+{
+    uint8_t day = parseWeekday(getFieldString(data, 1));
+    if(day <= 6)
+    {
+        setWeekday(day);
+        putsUart0("The weekday has been set.\n");
+        sortEvent();
+        AlarmTime();
+    }
+    else
+    {
+        putsUart0("Enter a day as sun, mon, tue, wed, thu, fri or sat.\n");
+    }
+}
+
+void showSchedule(USER_DATA* data)          // Displays the feeding schedules
+{
+    putsUart0("Event \t Duration      PWM \t HH:MM \t Repeat\n");
+
+    uint16_t eNum = NO_EVENT;
+    if(getEventCount() == 0)                          // Displays message if there is no active schedule
+    {
+        putsUart0("\nNo events scheduled.\n");
+    }
+    startEventWalk();
+    while((eNum = nextWalkEvent()) != NO_EVENT)       // Displays the active feeding schedules, next to fire first
+    {
+        uint32_t record[EVENT_WORDS];
+        readEepromCacheBlock(EVENT_TIME(eNum), record, EVENT_WORDS);
+        uint16_t minutes = record[0] & TIME_MINUTES_M;
+        uint8_t rule = (record[0] >> TIME_RULE_S) & TIME_RULE_M;
+        uint8_t arg = (record[0] >> TIME_ARG_S) & TIME_ARG_M;
+        uint16_t dur = record[1] & ACTION_DURATION_M;
+        uint16_t pwm = (record[1] >> ACTION_PWM_S) & ACTION_PWM_M;
+
+        printUart0("  %d\t    %02d %s \t%02d\t %02d:%02d \t ", eNum, dur,
+                   (record[1] & ACTION_GRAMS) ? "g" : "s", pwm, minutes / 60, minutes % 60); //event
+        if(rule == RULE_ONCE)
+        {
+            putsUart0("once");
+        }
+        else if(rule == RULE_HOURS)
+        {
+            printUart0("every %dh", ((arg == 0) || (arg > 24)) ? 24 : arg);
+        }
+        else if((rule == RULE_WEEKDAYS) && (arg != 0))
+        {
+            uint8_t i = 0;
+            for(i = 0; i < 7; i++)              // SMTWTFS with '-' for the days it does not fire
+            {
+                putTextUart0((arg & (1 << i)) ? "SMTWTFS"[i] : '-');
+            }
         }
+        else
+        {
+            putsUart0("daily");
+        }
+        putsUart0("\n");
+    }
+    putsUart0("\n");
+    AlarmTime();
+}
+
+void exportSchedule(USER_DATA* data)        // Prints the schedule as the lines "schedule import" takes back
+{
+    char line[(RECORDS_PER_LINE * RECORD_HEX) + 1];
+    uint16_t check = 0;
+    uint16_t event = 0;
+    uint16_t count = loadExport(&check);
+
+    putsUart0("schedule import begin\n");
+    while(exportLine(&event, line))
+    {
+        putsUart0("schedule import \"");
+        putsUart0(line);
+        putsUart0("\"\n");
+    }
+    printUart0("schedule import end %d %d\n", count, check);
+}
+
+void importSchedule(USER_DATA* data)        // Stages the lines of "schedule export" and replaces the schedule at "end"
+{                                           // Example: schedule import begin, schedule import "00000002DC00630005", schedule import end 1 12345
+    char* step = getFieldString(data, 2);
+    uint8_t result = IMPORT_OK;
 
-        if(!valid)                                          // Displayed if the user enters invalid commands.
+    if(data->fieldType[2] == 's')           // Records are quiet so a pasted table goes through quickly
+    {
+        result = importRecords(step);
+    }
+    else if((cmpStr(step, "begin") == 0) && (data->fieldCount == 3))
+    {
+        beginImport();
+        putsUart0("Import started.\n");
+    }
+    else if((cmpStr(step, "end") == 0) && (data->fieldCount == 5))
+    {
+        EEPROM_STATS before;
+        EEPROM_STATS after;
+        getEepromStats(&before);
+        result = endImport(getFieldInteger(data, 3), getFieldInteger(data, 4));
+        getEepromStats(&after);
+        if(result == IMPORT_OK)
         {
-            putsUart0("Invalid Command. Please try again.\n");
+            printUart0("Schedule imported, %d events, %u EEPROM writes.\n",
+                       getEventCount(), after.eepromWrites - before.eepromWrites);
         }
+    }
+    else
+    {
+        putsUart0("Usage: schedule import begin | \"records\" | end [count] [check]\n");
+    }
+    if(result != IMPORT_OK)
+    {
+        putsUart0(importErrorNames[result]);
+        putsUart0(".\n");
+    }
+}
+
+void setWater(USER_DATA* data)              // Sets the water level and writes the level into the EEPROM
+{
+    uint16_t volume = 0;
+    volume = getFieldInteger(data, 1);
 
+    changeSetting((16*0)+6, volume);
+    if(volume > 0)
+    {
+        printUart0("Water level regulation has been set to %d\n", volume);
+    }
+}
+
+void setFill(USER_DATA* data)               // Sets the mode to be either AUTO or MOTION for the water to be filled.
+{
+    uint8_t modeFlag = 0;
+    char* mode = getFieldString(data, 1);
+
+    if(mode != NULL && cmpStr(mode, "auto") == 0)
+    {
+        modeFlag = 1;
+        putsUart0("Fill mode has been set to AUTO.\n");
+    }
+    else if(mode != NULL && cmpStr(mode, "motion") == 0)
+    {
+       modeFlag = 2;
+       putsUart0("Fill mode has been set to MOTION.\n");
+    }
+    else
+    {
+        putsUart0("Please choose the mode as 'auto' or 'motion'\n");
+    }
+
+    changeSetting((16*0)+7, modeFlag);
+}
+
+void setAlert(USER_DATA* data)              // Sets the Alert mode to alert pet owner about low water alarm
+{
+    uint8_t lowWaterAlarm = 0;
+    char* alertmode = getFieldString(data, 1);
+
+    if((alertmode != NULL && cmpStr(alertmode, "ON") == 0) || (alertmode != NULL && cmpStr(alertmode, "on") == 0))
+    {
+        lowWaterAlarm = 1;
+        putsUart0("Alert mode has been turned ON\n");
+    }
+
+    if((alertmode != NULL && cmpStr(alertmode, "OFF") == 0) || (alertmode != NULL && cmpStr(alertmode, "off") == 0))
+    {
+        lowWaterAlarm = 0;
+        putsUart0("Alert mode has been turned OFF\n");
+    }
+    changeSetting((16*0)+8, lowWaterAlarm);
+}
+
+void showSettings(USER_DATA* data)          // Displays the set water level, fill mode and alert mode
+{
+    uint32_t settings[3];
+    readEepromCacheBlock((16*0)+6, settings, 3);
+    uint16_t watervolume = settings[0];
+    uint16_t fillmode = settings[1];
+    uint16_t alertmode = settings[2];
+
+    printUart0("Volume = %d ml\nFill Mode is %d\nAlert mode is %d\n", watervolume, fillmode, alertmode);
+}
+
+void calibrateAuger(USER_DATA* data)        // Auger feed rate for portions
+{                                           // Example: "calibrate auger test 80", weigh, then "calibrate auger 80 43"
+    char* augerText = getFieldString(data, 2);
+    uint8_t i = 0;
+
+    if((augerText != NULL) && (cmpStr(augerText, "test") == 0) && (data->fieldCount > 3))
+    {
+        int32_t speed = getFieldInteger(data, 3);
+        if(feeding)
+        {
+            putsUart0("A feed is running. Start the test run when it has finished.\n");
+        }
+        else if((speed < 1) || (speed > 100))
+        {
+            putsUart0("Enter a motor speed between 1 and 100.\n");
+        }
+        else
+        {
+            runAuger(speed, AUGER_TEST_S * 1000);
+            putsUart0("Test run started. Weigh what comes out and enter it with 'calibrate auger' [speed] [grams].\n");
+        }
+    }
+    else if((augerText != NULL) && (cmpStr(augerText, "reset") == 0))
+    {
+        resetPortion();
+        putsUart0("The auger calibration has been cleared.\n");
+    }
+    else if(data->fieldCount > 3)
+    {
+        int32_t speed = getFieldInteger(data, 2);
+        int32_t grams = getFieldInteger(data, 3);
+        bool ok = (speed > 0) && (speed <= 100) && (grams > 0) && (grams <= ACTION_DURATION_M)
+                  && setPortionPoint(speed, rateFromTest(grams, AUGER_TEST_S * 1000, getRampMs()));
+        putsUart0(ok ? "The auger calibration has been updated.\n" : "The auger calibration has not been changed. It holds up to 8 speeds.\n");
+    }
+    putsUart0("Speed \t g/s\n");
+    for(i = 0; i < getPortionCount(); i++)
+    {
+        uint8_t speed = 0;
+        uint32_t rate = 0;
+        getPortionPoint(i, &speed, &rate);
+        printUart0(" %3d%% \t %.3u\n", speed, rate);
+    }
+}
+
+void calibrateWater(USER_DATA* data)        // Adds or removes water level calibration points
+{                                           // Example: "calibrate 300" with 300 ml in the bowl
+    char* calText = getFieldString(data, 1);
+    int32_t first = getFieldInteger(data, 1);
+    int32_t second = getFieldInteger(data, 2);
+    bool ok = false;
+
+    if(cmpStr(calText, "delete") == 0)      // The point number is required, a missing one is not point 0
+    {
+        ok = (data->fieldCount > 2) && (second >= 0) && (second < CAL_POINTS) && deleteCalibrationPoint(second);
+    }
+    else if(cmpStr(calText, "reset") == 0)
+    {
+        ok = resetCalibration();
+    }
+    else if(data->fieldCount > 2)
+    {
+        ok = (first >= 0) && (first <= CAL_TICKS_M) && (second >= 0) && (second <= CAL_ML_M) && setCalibrationPoint(first, second);
+    }
+    else if((lastTicks != 0) && (lastTicks <= CAL_TICKS_M))  // The bowl holds the given volume now
+    {
+        ok = (first >= 0) && (first <= CAL_ML_M) && setCalibrationPoint(lastTicks, first);
+    }
+    putsUart0(ok ? "Calibration has been updated.\n" : "Calibration has not been changed. A table holds 2 to 16 points.\n");
+}
+
+void showCalibration(USER_DATA* data)       // Displays the calibration table and the latest reading
+{
+    uint8_t i = 0;
+    putsUart0("Point \t Ticks \t ml\n");
+    for(i = 0; i < getCalibrationCount(); i++)
+    {
+        uint16_t ticks = 0;
+        uint16_t ml = 0;
+        getCalibrationPoint(i, &ticks, &ml);
+        printUart0("  %d \t %d \t %d\n", i, ticks, ml);
+    }
+    printUart0("Latest reading = %u ticks, %d ml\n", lastTicks, lastLevel);
+}
+
+void setFilter(USER_DATA* data)             // Sets the water level burst size and moving average weight
+{                                           // Example: "filter 5 2" takes the median of 5 and weighs it 1/4
+    int32_t burst = getFieldInteger(data, 1);
+    int32_t shift = getFieldInteger(data, 2);
+    if((burst >= 1) && (burst <= MAX_BURST) && (shift >= 0) && (shift <= MAX_EMA_SHIFT))
+    {
+        changeSetting(SETTING_FILTER, getFilterSetting(burst, shift));
+        putsUart0("The water level filter has been set.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'filter' [1-9 readings] [0-6 shift]\n");
+    }
+}
+
+void showFilter(USER_DATA* data)            // Displays the water level filter and its output
+{
+    FILTER_STATS filter;
+    getFilterStats(&filter);
+    uint32_t deviation = 0;
+    while((deviation + 1) * (deviation + 1) <= filter.variance)   // Integer square root, the variance is small
+    {
+        deviation++;
+    }
+
+    printUart0("Burst = %d readings, average weight = 1/%d\n", filter.burst, 1 << filter.shift);
+    printUart0("Filtered = %u ticks (%d ml), deviation = %u ticks\n",
+               filter.filteredTicks, lastLevel, deviation);
+    printUart0("Bursts = %u, readings = %u, pump starts suppressed = %u\n",
+               filter.bursts, filter.samples, suppressedTriggers);
+}
+
+void setSample(USER_DATA* data)             // Sets the fastest and slowest water level sampling periods
+{                                           // Example: "sample 200 10000"
+    int32_t minMs = getFieldInteger(data, 1);
+    int32_t maxMs = getFieldInteger(data, 2);
+    if((minMs >= SAMPLE_UNIT_MS) && (minMs <= maxMs) && (maxMs <= MAX_SAMPLE_MS))
+    {
+        changeSetting(SETTING_SAMPLE, getSampleSetting(minMs, maxMs));
+        putsUart0("The sampling periods have been set.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'sample' [min ms] [max ms], 10 ms to 100000 ms\n");
+    }
+}
+
+void showSample(USER_DATA* data)            // Displays the water level sampling rate and overshoot
+{
+    SAMPLE_STATS sample;
+    getSampleStats(&sample);
+
+    printUart0("Period = %u ms (%u - %u ms)\n", sample.periodMs, sample.minMs, sample.maxMs);
+    printUart0("Samples = %u, fast = %u\n", sample.samples, sample.fastSamples);
+    printUart0("Overshoot last = %d ml, max = %d ml\n", sample.lastOvershoot, sample.maxOvershoot);
+}
+
+void setPumpSpeed(USER_DATA* data)          // Sets how the pump slows down near the target
+{                                           // Example: "pump speed 40 100", full speed with a taper of 0 ml
+    int32_t minSpeed = getFieldInteger(data, 2);
+    int32_t taper = getFieldInteger(data, 3);
+    if((minSpeed > 0) && (minSpeed <= 100) && (taper >= 0) && (taper <= SPEED_TAPER_M))
+    {
+        changeSetting(SETTING_PUMP_SPEED, getPumpSpeedSetting(minSpeed, taper));
+        putsUart0("The pump speed has been set.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'pump speed' [min 1-100 %] [taper 0-65535 ml]\n");
+    }
+}
+
+void setPump(USER_DATA* data)               // Sets the pump refill band, maximum run and minimum off-time
+{                                           // Example: "pump 20 60 30"
+    int32_t band = getFieldInteger(data, 1);
+    int32_t maxRun = getFieldInteger(data, 2);
+    int32_t minOff = getFieldInteger(data, 3);
+    if((band >= 0) && (band <= PUMP_BAND_M) && (maxRun > 0) && (maxRun <= MAX_RUN_LIMIT_S)
+       && (minOff >= 0) && (minOff <= PUMP_TIME_M))
+    {
+        changeSetting(SETTING_PUMP, getPumpSetting(band, maxRun, minOff));
+        putsUart0("The pump has been set.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'pump' [band 0-255 ml] [max run 1-100 s] [min off 0-4095 s]\n");
+    }
+}
+
+void showPump(USER_DATA* data)              // Displays the pump controller and its run times
+{
+    PUMP_STATS pump;
+    getPumpStats(&pump);
+
+    printUart0("Pump %s, band = %d ml, max run = %d s, min off = %d s\n",
+               pumpStateNames[pump.state], pump.bandMl, pump.maxRunS, pump.minOffS);
+    printUart0("Runs = %u, cut off = %u, last = %u s, longest = %u s\n",
+               pump.starts, pump.cutoffs, pump.lastRunS, pump.longestRunS);
+    printUart0("Speed = %d %% at the target, full %d ml below it, last duty = %d/%d\n",
+               pump.minSpeed, pump.taperMl, pump.lastDuty, PWM_FULL);
+}
+
+void setMotion(USER_DATA* data)             // Sets the PIR minimum presence and hold-off times
+{                                           // Example: "motion 100 2000"
+    int32_t presence = getFieldInteger(data, 1);
+    int32_t holdoff = getFieldInteger(data, 2);
+    if((presence >= 0) && (presence <= MOTION_PRESENCE_M) && (holdoff >= 0) && (holdoff <= MOTION_PRESENCE_M))
+    {
+        changeSetting(SETTING_MOTION, getMotionSetting(presence, holdoff));
+        putsUart0("The motion times have been set.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'motion' [presence ms] [hold-off ms], 0 to 65535 ms\n");
+    }
+}
+
+void showMotion(USER_DATA* data)            // Displays the PIR visits and the edge to pump latency
+{
+    MOTION_STATS motion;
+    getMotionStats(&motion);
+
+    printUart0("PIR %s, presence = %d ms, hold-off = %d ms\n",
+               motionStateNames[motion.state], motion.presenceMs, motion.holdoffMs);
+    printUart0("Edges = %u, visits = %u, glitches = %u, retriggers = %u\n",
+               motion.edges, motion.visits, motion.glitches, motion.retriggers);
+    printUart0("Pump starts = %u, latency last = %u us, max = %u us, avg = %u us\n",
+               motion.pumpStarts, motion.lastLatencyUs, motion.maxLatencyUs,
+               (motion.pumpStarts == 0) ? 0 : motion.sumLatencyUs / motion.pumpStarts);
+}
+
+void showVisits(USER_DATA* data)            // Displays visits per hour over the last 24 h and the latest visits
+{
+    uint32_t now = HIB_RTCC_R;
+    VISIT_HOUR_STATS hourStats;
+    VISIT_STATS visitStats;
+    VISIT recent[5];
+    uint8_t count = 0;
+    uint8_t i = 0;
+    uint32_t total = 0;
+    uint32_t pumped = 0;
+
+    compactVisits(now);
+    for(i = VISIT_HOURS; i > 0; i--)                // Oldest hour first, one bucket read per hour
+    {
+        getVisitHour(now, i - 1, &hourStats);
+        if(hourStats.visits != 0)
+        {
+            printUart0("%02u:00  %3d visits, %3d with pump, %5d s\n",
+                       hourStats.hour % 24, hourStats.visits, hourStats.pumped, hourStats.seconds);
+        }
+        total += hourStats.visits;
+        pumped += hourStats.pumped;
+    }
+    getVisitStats(&visitStats);
+    printUart0("Last 24 h = %u visits, %u with pump, logged since boot = %u, dropped = %u\n",
+               total, pumped, visitStats.logged, visitStats.dropped);
+    count = getRecentVisits(recent, 5);
+    for(i = 0; i < count; i++)
+    {
+        printUart0("Visit at %02u:%02u, %d s%s\n",
+                   (recent[i].start % SECONDS_PER_DAY) / 3600, (recent[i].start % 3600) / 60,
+                   recent[i].seconds, recent[i].pumped ? ", pump ran" : "");
+    }
+}
+
+void setAuger(USER_DATA* data)              // Sets the auger soft start/stop ramp and anti-jam pulses
+{                                           // Example: "auger 500 5 200 200", anti-jam off with 0 s
+    int32_t rampMs = getFieldInteger(data, 1);
+    int32_t jamS = getFieldInteger(data, 2);
+    int32_t pauseMs = getFieldInteger(data, 3);
+    int32_t kickMs = getFieldInteger(data, 4);
+    int32_t limitMs = AUGER_FIELD_MAX * PROFILE_STEP_MS;
+    if((rampMs >= 0) && (rampMs <= limitMs) && (jamS >= 0) && (jamS <= AUGER_FIELD_MAX)
+       && (pauseMs >= 0) && (pauseMs <= limitMs) && (kickMs >= 0) && (kickMs <= limitMs))
+    {
+        changeSetting(SETTING_AUGER, getAugerSetting(rampMs / PROFILE_STEP_MS, jamS, pauseMs / PROFILE_STEP_MS, kickMs / PROFILE_STEP_MS));
+        putsUart0("The auger profile has been set.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'auger' [ramp ms] [anti-jam every s] [pause ms] [kick ms], 0 to 2540 ms, 0 to 254 s\n");
+    }
+}
+
+void showAuger(USER_DATA* data)             // Displays the auger profile and how often it ran
+{
+    AUGER_STATS auger;
+    getAugerStats(&auger);
+
+    printUart0("Ramp = %d ms, anti-jam every %d s (%d ms stop, %d ms kick)\n",
+               auger.rampSteps * PROFILE_STEP_MS, auger.jamEveryS, auger.pauseSteps * PROFILE_STEP_MS, auger.kickSteps * PROFILE_STEP_MS);
+    printUart0("Profiles = %u, anti-jam pulses = %u, duty steps = %u%s\n",
+               auger.profiles, auger.jamPulses, auger.steps, (auger.segment == SEGMENT_DONE) ? "" : ", running");
+}
+
+void setPower(USER_DATA* data)              // Lets the feeder hibernate between feeds and samples
+{
+    char* powerMode = getFieldString(data, 1);
+    if(cmpStr(powerMode, "on") == 0)
+    {
+        changeSetting(SETTING_POWER, 1);
+        putsUart0("Hibernation is on. The console stays up for 60 s after each command.\n");
+    }
+    else if(cmpStr(powerMode, "off") == 0)
+    {
+        changeSetting(SETTING_POWER, 0);
+        putsUart0("Hibernation is off.\n");
+    }
+    else
+    {
+        putsUart0("Usage: 'power' on | off\n");
+    }
+}
+
+void showPower(USER_DATA* data)             // Displays the wake-up latency, duty cycle and energy estimate
+{
+    POWER_STATS power;
+    LOOP_STATS loop;
+    getPowerStats(&power);
+    getLoopStats(&loop);
+
+    uint32_t total = power.awakeSeconds + power.asleepSeconds;
+    uint32_t duty = (total == 0) ? 1000 : (uint32_t)(((uint64_t)power.awakeSeconds * 1000) / total);
+    uint32_t idle = (loop.totalCycles == 0) ? 0 : (uint32_t)((loop.idleCycles * 1000) / loop.totalCycles);
+    uint64_t awakeUa = (((uint64_t)(1000 - idle) * RUN_UA) + ((uint64_t)idle * SLEEP_UA)) / 1000;  // WFI share of this boot
+    uint32_t averageUa = (total == 0) ? awakeUa : (uint32_t)(((awakeUa * power.awakeSeconds) + ((uint64_t)HIBERNATE_UA * power.asleepSeconds)) / total);
+    uint32_t dayUah = averageUa * 24;
+
+    printUart0("Hibernation is %s, last wake = %s\n",
+               (readEepromCache(SETTING_POWER) == 1) ? "on" : "off", wakeNames[power.lastWake]);
+    printUart0("Hibernations = %u, wake latency last = %u us, max = %u us, avg = %u us\n",
+               power.hibernations, power.lastLatencyUs, power.maxLatencyUs,
+               (power.rtcWakes == 0) ? 0 : power.sumLatencyUs / power.rtcWakes);
+    printUart0("Awake = %u s, asleep = %u s, duty cycle = %.1u%%\n",
+               power.awakeSeconds, power.asleepSeconds, duty);
+    printUart0("Estimated average = %u uA, %.1u mAh per day (motor and pump excluded)\n",
+               averageUa, dayUah / 100);
+}
+
+void showStats(USER_DATA* data)             // Displays the EEPROM cache and record log counters
+{
+    EEPROM_STATS stats;
+    getEepromStats(&stats);
+
+    printUart0("Cache reads = %u\nCache writes = %u (%u unchanged)\n",
+               stats.cacheReads, stats.cacheWrites, stats.cacheSkips);
+    printUart0("EEPROM reads = %u\nEEPROM writes = %u (%u unchanged)\n",
+               stats.eepromReads, stats.eepromWrites, stats.eepromSkips);
+    printUart0("Scheduled events = %d/%d\n", getEventCount(), MAX_EVENTS);
+
+    STORE_STATS store;
+    getStoreStats(&store);
+    printUart0("Log head = %d, used = %d/%d, live = %d, generation = %d\n",
+               store.head, store.used, STORE_SLOTS, store.live, store.generation);
+    printUart0("Records = %u, relocated = %u, laps = %u\n",
+               store.appends, store.relocations, store.laps);
+
+    ISR_STATS isr;
+    uint8_t i = 0;
+    getIsrStats(&isr);
+    for(i = 0; i < ISR_COUNT; i++)                  // Worst case time in each interrupt, 40 clocks per us
+    {
+        printUart0("%s ISR calls = %u, max = %u us\n",
+                   isrNames[i], isr.calls[i], CYCLES_TO_US(isr.maxCycles[i]));
+    }
+    printUart0("Work posted = %u, dropped = %u, max depth = %d/%d\n",
+               isr.posted, isr.dropped, isr.maxDepth, WORK_QUEUE_SIZE - 1);
+
+    LOOP_STATS loop;
+    getLoopStats(&loop);
+    uint32_t idle = (loop.totalCycles == 0) ? 0 : (uint32_t)((loop.idleCycles * 1000) / loop.totalCycles);
+    printUart0("Idle = %.1u%%, wakes = %u, timers run = %u\n",
+               idle, loop.wakes, loop.timersRun);
+
+    UART0_STATS uart;
+    getUart0Stats(&uart);
+    printUart0("UART tx max = %u/%d, dropped = %u, stalls = %u, rx max = %u/%d, dropped = %u\n",
+               uart.txHigh, UART0_TX_SIZE, uart.txDropped, uart.txStalls, uart.rxHigh, UART0_RX_SIZE, uart.rxDropped);
+
+    PROTOCOL_STATS frames;
+    getProtocolStats(&frames);
+    printUart0("Frames = %u, bad = %u, responses = %u\n",
+               frames.frames, frames.badFrames, frames.responses);
+}
+
+void showHelp(USER_DATA* data);
+
+void startBinary(USER_DATA* data)           // Switches UART0 to binary frames until MSG_TEXT_MODE
+{
+    putsUart0("Binary mode. Send a MSG_TEXT_MODE frame to return to text.\n");
+    muteUart0Text(true);                    // Messages already queued still go out
+    rxFrame.count = 0;
+    rxFrame.overflow = false;
+    binaryMode = true;
+}
+
+// Sorted by name for findCommand, entries sharing a name are tried in order so subcommands and longer forms come first.
+// Argument types: 'n' number, 'a' word, '?' either.
+const COMMAND commands[] =
+{
+    {"alert",     NULL,     1, 1,        "a",     setAlert,        "alert on | off"},
+    {"auger",     NULL,     4, 4,        "nnnn",  setAuger,        "auger [ramp ms] [anti-jam every s] [pause ms] [kick ms]"},
+    {"auger",     NULL,     0, 0,        "",      showAuger,       "auger"},
+    {"binary",    NULL,     0, 0,        "",      startBinary,     "binary"},
+    {"calibrate", "auger",  1, 3,        "a??",   calibrateAuger,  "calibrate auger test [speed] | [speed] [grams] | reset"},
+    {"calibrate", NULL,     1, 2,        "?n",    calibrateWater,  "calibrate [ml] | [ticks] [ml] | delete [point] | reset"},
+    {"calibrate", NULL,     0, 0,        "",      showCalibration, "calibrate"},
+    {"feed",      NULL,     4, 4,        "nnnt",  addFeed,         "feed [event #] [run s] [speed %] [HH:MM]"},
+    {"feed",      NULL,     5, 5,        "nnnnn", addFeed,         "feed [event #] [run s] [speed %] [HH MM]"},
+    {"feed",      NULL,     2, 2,        "na",    deleteFeed,      "feed [event #] delete"},
+    {"fill",      NULL,     1, 1,        "a",     setFill,         "fill auto | motion"},
+    {"filter",    NULL,     2, 2,        "nn",    setFilter,       "filter [1-9 readings] [0-6 shift]"},
+    {"filter",    NULL,     0, 0,        "",      showFilter,      "filter"},
+    {"help",      NULL,     0, 0,        "",      showHelp,        "help"},
+    {"motion",    NULL,     2, 2,        "nn",    setMotion,       "motion [presence ms] [hold-off ms]"},
+    {"motion",    NULL,     0, 0,        "",      showMotion,      "motion"},
+    {"portion",   NULL,     4, 4,        "nnnt",  addPortion,      "portion [event #] [grams] [speed %] [HH:MM]"},
+    {"portion",   NULL,     5, 5,        "nnnnn", addPortion,      "portion [event #] [grams] [speed %] [HH MM]"},
+    {"power",     NULL,     1, 1,        "a",     setPower,        "power on | off"},
+    {"power",     NULL,     0, 0,        "",      showPower,       "power"},
+    {"pump",      "speed",  3, 3,        "ann",   setPumpSpeed,    "pump speed [min 1-100 %] [taper ml]"},
+    {"pump",      NULL,     3, 3,        "nnn",   setPump,         "pump [band ml] [max run s] [min off s]"},
+    {"pump",      NULL,     0, 0,        "",      showPump,        "pump"},
+    {"repeat",    NULL,     2, ANY_ARGS, "na",    setRepeat,       "repeat [event #] once | daily | every [1-24] | [sun mon tue wed thu fri sat]"},
+    {"sample",    NULL,     2, 2,        "nn",    setSample,       "sample [min ms] [max ms]"},
+    {"sample",    NULL,     0, 0,        "",      showSample,      "sample"},
+    {"schedule",  "export", 1, 1,        "a",     exportSchedule,  "schedule export"},
+    {"schedule",  "import", 2, 4,        "a?nn",  importSchedule,  "schedule import begin | \"records\" | end [count] [check]"},
+    {"schedule",  NULL,     0, 0,        "",      showSchedule,    "schedule"},
+    {"setting",   NULL,     0, 0,        "",      showSettings,    "setting"},
+    {"stats",     NULL,     0, 0,        "",      showStats,       "stats"},
+    {"time",      NULL,     1, 1,        "t",     setTime,         "time [HH:MM]"},
+    {"time",      NULL,     2, 2,        "nn",    setTime,         "time [HH MM]"},
+    {"time",      NULL,     0, 0,        "",      showTime,        "time"},
+    {"visits",    NULL,     0, 0,        "",      showVisits,      "visits"},
+    {"water",     NULL,     1, 1,        "n",     setWater,        "water [ml]"},
+    {"weekday",   NULL,     1, 1,        "a",     setDayOfWeek,    "weekday sun | mon | tue | wed | thu | fri | sat"},
+};
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+void showHelp(USER_DATA* data)              // Lists every form of every command
+{
+    uint8_t i = 0;
+    for(i = 0; i < COMMAND_COUNT; i++)
+    {
+        putsUart0(commands[i].usage);
+        putsUart0("\n");
+    }
+}
+
+void processCommand(USER_DATA* data)        // Runs one command line typed on the interface
+{
+    int16_t first = -1;
+    uint8_t i = 0;
+
+    if((data->fieldCount != 0) && (data->fieldType[0] == 'a'))
+    {
+        first = findCommand(commands, COMMAND_COUNT, getFieldString(data, 0));  // Binary search on the first field only
+    }
+    if(first < 0)                               // Displayed if the user enters invalid commands.
+    {
+        putsUart0("Invalid Command. Please try again.\n");
+        return;
+    }
+    for(i = first; (i < COMMAND_COUNT) && (cmpStr(commands[i].name, commands[first].name) == 0); i++)
+    {
+        if(matchArguments(&commands[i], data))
+        {
+            commands[i].run(data);
+            return;
+        }
+    }
+    for(i = first; (i < COMMAND_COUNT) && (cmpStr(commands[i].name, commands[first].name) == 0); i++)
+    {
+        putsUart0("Usage: ");                   // The command exists but the arguments fit none of its forms
+        putsUart0(commands[i].usage);
+        putsUart0("\n");
+    }
+}
+
+uint8_t getTelemetry(uint8_t* out)          // Water, pump and schedule state for MSG_TELEMETRY, returns its length
+{
+    uint32_t now = HIB_RTCC_R;
+    PUMP_STATS pump;
+    getPumpStats(&pump);
+    putWord(&out[0], now);                  // RTC seconds
+    out[4] = lastLevel;                     // Filtered level in ml
+    out[5] = lastLevel >> 8;
+    putWord(&out[6], lastTicks);            // Filtered comparator reading
+    out[10] = pump.state;
+    out[11] = (PUMP_ON ? 1 : 0) | (profileRunning() ? 2 : 0) | (motionIdle() ? 0 : 4);  // Pump on, auger running, PIR busy
+    out[12] = getEventCount();
+    out[13] = getEventCount() >> 8;
+    putWord(&out[14], (getEventCount() == 0) ? 0xFFFFFFFF : getNextFireTime());
+    return 18;
+}
+
+void processFrame(uint8_t* frame, uint8_t length)   // Runs one binary request, the message types are in protocol.h
+{
+    uint8_t type = frame[0];
+    uint8_t id = frame[1];
+    uint8_t* in = &frame[2];
+    uint8_t size = length - 2;
+    uint8_t out[PAYLOAD_MAX];
+    uint8_t count = 0;
+    uint8_t status = STATUS_OK;
+
+    if(type == MSG_GET_TIME)
+    {
+        while(!(HIB_CTL_R & HIB_CTL_WRC));
+        putWord(out, HIB_RTCC_R);
+        out[4] = getWeekday(getWord(out));
+        count = 5;
+    }
+    else if((type == MSG_SET_TIME) && (size == 2))
+    {
+        uint16_t minutes = in[0] | (in[1] << 8);
+        if(minutes < 24 * 60)
+        {
+            setClock(minutes * 60);
+        }
+        else
+        {
+            status = STATUS_VALUE;
+        }
+    }
+    else if((type == MSG_GET_EVENT) && (size == 1))
+    {
+        putWord(&out[0], readEepromCache(EVENT_TIME(in[0])));
+        putWord(&out[4], readEepromCache(EVENT_ACTION(in[0])));
+        count = 8;
+    }
+    else if((type == MSG_SET_EVENT) && (size == 9))
+    {
+        status = storeEvent(in[0], getWord(&in[1]), getWord(&in[5]));
+    }
+    else if((type == MSG_DELETE_EVENT) && (size == 1))
+    {
+        deleteEvent(in[0]);
+    }
+    else if((type == MSG_LIST_EVENTS) && (size == 2))
+    {
+        uint16_t after = in[0] | (in[1] << 8);
+        uint16_t event = NO_EVENT;
+        if((after != NO_EVENT) && ((after >= MAX_EVENTS) || !eventScheduled(after)))
+        {
+            status = STATUS_VALUE;          // Not an event, or it fired or was deleted since the last page
+        }
+        else
+        {
+            out[0] = getEventCount();
+            out[1] = getEventCount() >> 8;
+            count = 2;
+            startEventWalk();
+            if(after != NO_EVENT)
+            {
+                while(((event = nextWalkEvent()) != NO_EVENT) && (event != after));   // Skips to the page start
+            }
+            while((count < 2 + LIST_PAGE) && ((event = nextWalkEvent()) != NO_EVENT))  // Next to fire first, from after onwards
+            {
+                out[count++] = event;
+            }
+        }
+    }
+    else if((type == MSG_GET_SETTING) && (size == 2))
+    {
+        uint16_t word = in[0] | (in[1] << 8);
+        if(findSetting(word) >= 0)
+        {
+            putWord(out, readEepromCache(word));
+            count = 4;
+        }
+        else
+        {
+            status = STATUS_VALUE;
+        }
+    }
+    else if((type == MSG_SET_SETTING) && (size == 6))
+    {
+        status = changeSetting(in[0] | (in[1] << 8), getWord(&in[2]));
+    }
+    else if(type == MSG_TELEMETRY)
+    {
+        count = getTelemetry(out);
+    }
+    else if(type == MSG_TEXT_MODE)
+    {
+        sendFrame(type | FRAME_RESPONSE, id, STATUS_OK, out, 0);
+        binaryMode = false;
+        muteUart0Text(false);
+        putsUart0("Text mode.\n");
+        return;
+    }
+    else if((type >= MSG_GET_TIME) && (type <= MSG_TELEMETRY))
+    {
+        status = STATUS_LENGTH;
+    }
+    else
+    {
+        status = STATUS_UNKNOWN;
+    }
+    sendFrame(type | FRAME_RESPONSE, id, status, out, count);
+}
+
+bool readyToHibernate()                     // Nothing is running and nobody is at the console
+{
+    return (readEepromCache(SETTING_POWER) == 1) && awakeTimeOver() && !workPending() && !timersRunning()
+           && !PUMP_ON && !pumpBusy(HIB_RTCC_R) && motionIdle() && !profileRunning() && (PWM0_0_CMPB_R == 0) && !(WTIMER1_CTL_R & TIMER_CTL_TAEN)   // No water level measurement running
+           && !kbhitUart0() && (rxLine.charCount == 0) && (rxFrame.count == 0) && !importRunning();
+}
+
+void enterLowPower()                        // Hibernates until the next feed, water sample or PIR edge
+{
+    uint32_t mode = readEepromCache((16*0)+7);
+    uint32_t now = 0;
+    uint32_t wake = 0xFFFFFFFF;
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    now = HIB_RTCC_R;
+
+    if(getEventCount() != 0)
+    {
+        wake = getNextFireTime();
+    }
+    if(mode == 1)                           // AUTO mode wakes for the sample Timer 1 would have taken
+    {
+        uint32_t sample = now + CYCLES_TO_S(TIMER1_TAV_R);
+        if(sample < wake)
+        {
+            wake = sample;
+        }
+    }
+    if((wake != 0xFFFFFFFF) && (wake < now + MIN_HIBERNATE_S))
+    {
+        return;                             // Too soon to be worth a reboot, WFI covers it
+    }
+    saveVisits();                           // RAM is lost in hibernate
+    putsUart0("Hibernating.\n");
+    flushUart0();                           // Let the message out before the power goes
+    hibernate(wake);                        // PIR on the WAKE pin brings MOTION mode back up
+}
+
+void doWork()                               // Drains the work posted by the interrupts
+{
+    WORK_ITEM item;
+    while(getWork(&item))
+    {
+        if(item.type == WORK_ALARM)
+        {
+            startFeed();
+        }
+        else if(item.type == WORK_TICK)
+        {
+            runTimers();
+        }
+        else if(item.type == WORK_RX)
+        {
+            char c;
+            rxPosted = false;               // Characters arriving from here on post again
+            while(tryGetcUart0(&c))
+            {
+                if(binaryMode)
+                {
+                    if(addFrameByte(&rxFrame, c))
+                    {
+                        uint8_t length = decodeFrame(&rxFrame);
+                        if(length != 0)
+                        {
+                            processFrame(rxFrame.buffer, length);
+                        }
+                    }
+                }
+                else if(addCharacter(&rxLine, c))
+                {
+                    uint8_t error = 0;
+                    putcUart0('\n');
+                    error = parseFields(&rxLine, MAX_FIELDS);
+                    if(error == PARSE_OK)
+                    {
+                        processCommand(&rxLine);
+                    }
+                    else
+                    {
+                        printUart0("Field %d: %s\n", rxLine.fieldCount + 1, parseErrorNames[error]);
+                    }
+                }
+            }
+            keepAwake(CONSOLE_AWAKE_S);
+        }
+        else if(item.type == WORK_VISIT)
+        {
+            compactVisits(HIB_RTCC_R);
+        }
+        else if(item.type == WORK_FEED)
+        {
+            endFeed();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+    initHw();
+    initIsrQueue();
+    initEventLoop();
+    initEeprom();
+    initEepromCache();
+    initHIB();
+    initLowPower();                         // Records why the core is running and the wake-up latency
+    initPWM();
+    initSchedule();                         // Builds the heap of stored events, needs the RTC running
+    initCalibration();                      // After initSchedule has moved any old events out of block 1
+    initLevelFilter(readEepromCache(SETTING_FILTER));
+    initSampleRate(readEepromCache(SETTING_SAMPLE));
+    initPumpControl(readEepromCache(SETTING_PUMP));
+    initPumpSpeed(readEepromCache(SETTING_PUMP_SPEED));
+    initAuger(readEepromCache(SETTING_AUGER));
+    initPortion();
+    initMotion(readEepromCache(SETTING_MOTION));
+    initVisits(HIB_RTCC_R);
+    AlarmTime();
+
+    if(SENSOR)                              // Already high, e.g. the PIR woke us through WAKE
+    {
+        armMotionTimer(motionEdge(true, getCycles()));
+    }
+
+    if(getWakeReason() != WAKE_POWER_ON)
+    {
+        NVIC_PEND0_R = 1 << (INT_TIMER1A-16);   // Take a water sample now instead of 10 s from now
+    }
+    putsUart0("Enter instructions:\n");
+
+    while(true)                             // Everything runs from the work queue, the core sleeps in between
+    {
+        doWork();
+        if(readyToHibernate())
+        {
+            enterLowPower();
+        }
+        sleepUntilWork();
     }
 }
@@ -0,0 +1,160 @@
+//Auger drive profiles. A feed ramps the duty up along an S-curve, holds it and ramps it back down, so
+//the 12 V supply never sees the motor jump from stopped to full speed. The ramp is computed into a
+//table when the feed starts; the PWM load interrupt then only counts periods and every 10 ms reads the
+//next duty out of the table. The driver can not reverse the auger, so the anti-jam segment stops it
+//briefly and restarts it at full duty every few seconds of the hold.
+#include <stdint.h>
+#include <stdbool.h>
+#include "auger.h"
+#include "fixedPoint.h"
+
+static uint8_t rampSteps = DEFAULT_RAMP_STEPS;
+static uint8_t jamEveryS = 0;
+static uint8_t pauseSteps = DEFAULT_PAUSE_STEPS;
+static uint8_t kickSteps = DEFAULT_KICK_STEPS;
+
+static uint16_t ramp[MAX_RAMP_STEPS];               // Duty of each step of the ramp up, read backwards for the ramp down
+static uint8_t steps = 0;                           // Ramp length of the running profile
+static uint16_t target = 0;
+static volatile uint8_t segment = SEGMENT_DONE;
+static uint32_t upLeft = 0;                         // Steps left in each part of the profile
+static uint32_t holdLeft = 0;
+static uint32_t downLeft = 0;
+static uint32_t jamEvery = 0;                       // Hold steps between anti-jam pulses, 0 = off
+static uint32_t jamLeft = 0;
+static uint8_t phaseLeft = 0;                       // Steps left in a pause or kick
+static uint16_t loads = 1;
+static uint32_t profiles = 0;
+static uint32_t jamPulses = 0;
+static uint32_t stepCount = 0;
+
+void initAuger(uint32_t setting)                    // setting is the stored word, erased means defaults
+{
+    if(setting == 0xFFFFFFFF)
+    {
+        rampSteps = DEFAULT_RAMP_STEPS;
+        jamEveryS = 0;
+        pauseSteps = DEFAULT_PAUSE_STEPS;
+        kickSteps = DEFAULT_KICK_STEPS;
+    }
+    else
+    {
+        rampSteps = setting & AUGER_FIELD_M;
+        jamEveryS = (setting >> AUGER_JAM_S) & AUGER_FIELD_M;
+        pauseSteps = (setting >> AUGER_PAUSE_S) & AUGER_FIELD_M;
+        kickSteps = (setting >> AUGER_KICK_S) & AUGER_FIELD_M;
+    }
+}
+
+uint32_t getAugerSetting(uint8_t newRamp, uint8_t newJam, uint8_t newPause, uint8_t newKick)
+{
+    return newRamp | ((uint32_t)newJam << AUGER_JAM_S) | ((uint32_t)newPause << AUGER_PAUSE_S) | ((uint32_t)newKick << AUGER_KICK_S);
+}
+
+void startProfile(uint16_t duty, uint32_t ms)       // Main loop only, while no profile is running
+{
+    uint32_t total = ms / PROFILE_STEP_MS;
+    uint8_t i = 0;
+
+    steps = (rampSteps > total / 2) ? total / 2 : rampSteps;
+    for(i = 0; i < steps; i++)                      // Smoothstep 3x^2 - 2x^3 at x = (i + 1) / (steps + 1)
+    {
+        q16_t x = Q16_RATIO(i + 1, steps + 1);
+        q16_t shape = Q16_MUL(Q16_MUL(x, x), Q16_FROM_INT(3) - 2 * x);
+        ramp[i] = Q16_SCALE(shape, duty);
+    }
+    target = duty;
+    upLeft = steps;
+    holdLeft = total - 2 * steps;
+    downLeft = steps;
+    jamEvery = jamEveryS * (1000 / PROFILE_STEP_MS);
+    jamLeft = jamEvery + 1;                         // A pulse after every jamEvery steps held, as after a kick
+    phaseLeft = 0;
+    loads = 1;                                      // First duty on the next load
+    profiles++;
+    segment = (total == 0) ? SEGMENT_DONE : SEGMENT_UP;
+}
+
+static uint16_t nextDuty()
+{
+    if(upLeft != 0)
+    {
+        return ramp[steps - upLeft--];
+    }
+    if(holdLeft != 0)
+    {
+        holdLeft--;
+        if(segment == SEGMENT_UP)
+        {
+            segment = SEGMENT_HOLD;
+        }
+        if((segment == SEGMENT_HOLD) && (jamEvery != 0) && (--jamLeft == 0))
+        {
+            segment = SEGMENT_PAUSE;                // Anti-jam pulse
+            phaseLeft = pauseSteps;
+            jamPulses++;
+        }
+        if((segment == SEGMENT_PAUSE) && (phaseLeft == 0))
+        {
+            segment = SEGMENT_KICK;
+            phaseLeft = kickSteps;
+        }
+        if((segment == SEGMENT_KICK) && (phaseLeft == 0))
+        {
+            segment = SEGMENT_HOLD;
+            jamLeft = jamEvery;
+        }
+        if(segment == SEGMENT_HOLD)
+        {
+            return target;
+        }
+        phaseLeft--;
+        return (segment == SEGMENT_PAUSE) ? 0 : PWM_FULL;
+    }
+    if(downLeft != 0)
+    {
+        segment = SEGMENT_DOWN;
+        return ramp[--downLeft];
+    }
+    segment = SEGMENT_DONE;
+    return 0;
+}
+
+bool profileLoad(uint16_t* duty)                    // Called on every PWM load, true when *duty is the next step
+{
+    if((segment == SEGMENT_DONE) || (--loads != 0))
+    {
+        return false;
+    }
+    loads = PROFILE_STEP_LOADS;
+    *duty = nextDuty();
+    stepCount++;
+    return true;
+}
+
+void stopProfile()
+{
+    segment = SEGMENT_DONE;
+}
+
+bool profileRunning()
+{
+    return segment != SEGMENT_DONE;
+}
+
+uint32_t getRampMs()                                // Length of one full ramp
+{
+    return rampSteps * PROFILE_STEP_MS;
+}
+
+void getAugerStats(AUGER_STATS* stats)
+{
+    stats->segment = segment;
+    stats->rampSteps = rampSteps;
+    stats->jamEveryS = jamEveryS;
+    stats->pauseSteps = pauseSteps;
+    stats->kickSteps = kickSteps;
+    stats->profiles = profiles;
+    stats->jamPulses = jamPulses;
+    stats->steps = stepCount;
+}
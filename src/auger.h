@@ -0,0 +1,55 @@
+/*
+ * auger.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef AUGER_H_
+#define AUGER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "initModules.h"
+
+#define PROFILE_STEP_MS 10
+#define PROFILE_STEP_LOADS 390                      // PWM periods per step, 39.02 kHz x 10 ms
+#define MAX_RAMP_STEPS 255
+#define DEFAULT_RAMP_STEPS 50                       // 500 ms soft start and stop
+#define DEFAULT_PAUSE_STEPS 20                      // Anti-jam: stop for 200 ms,
+#define DEFAULT_KICK_STEPS 20                       // then 200 ms at full duty
+#define AUGER_FIELD_M 0xFF                          // Setting word: ramp steps in bits 0-7, anti-jam period in s
+#define AUGER_JAM_S 8                               // in bits 8-15 (0 = off), pause steps in bits 16-23
+#define AUGER_PAUSE_S 16                            // and kick steps in bits 24-31
+#define AUGER_KICK_S 24
+#define AUGER_FIELD_MAX 254                         // 255 in all four fields is the erased word
+
+// Profile segments
+#define SEGMENT_DONE 0
+#define SEGMENT_UP 1
+#define SEGMENT_HOLD 2
+#define SEGMENT_PAUSE 3                             // Anti-jam stop
+#define SEGMENT_KICK 4                              // Anti-jam full duty pulse
+#define SEGMENT_DOWN 5
+
+typedef struct _AUGER_STATS
+{
+    uint8_t segment;
+    uint8_t rampSteps;
+    uint8_t jamEveryS;
+    uint8_t pauseSteps;
+    uint8_t kickSteps;
+    uint32_t profiles;
+    uint32_t jamPulses;
+    uint32_t steps;                                 // Duty updates since boot
+} AUGER_STATS;
+
+void initAuger(uint32_t setting);
+uint32_t getAugerSetting(uint8_t rampSteps, uint8_t jamEveryS, uint8_t pauseSteps, uint8_t kickSteps);
+void startProfile(uint16_t duty, uint32_t ms);
+bool profileLoad(uint16_t* duty);
+void stopProfile();
+bool profileRunning();
+uint32_t getRampMs();
+void getAugerStats(AUGER_STATS* stats);
+
+#endif /* AUGER_H_ */
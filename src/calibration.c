@@ -0,0 +1,177 @@
+//Comparator ticks to millilitres through a table of calibration points. The level is interpolated
+//between the two points around the reading and clamped to the first and last point outside them.
+//Slopes are worked out in Q16.16 when the table is loaded so the ISR only does a binary search, a
+//multiply and a shift. The table is rebuilt in the spare copy and then switched in, so analogISR never
+//sees one that is half edited.
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+#include "fixedPoint.h"
+#include "calibration.h"
+
+typedef struct _CAL_TABLE
+{
+    uint8_t count;
+    uint16_t ticks[CAL_POINTS];
+    uint16_t ml[CAL_POINTS];
+    q16_t slope[CAL_POINTS];                        // ml per tick from this point to the next
+} CAL_TABLE;
+
+// Centres of the ranges the level used to be snapped to
+static const uint32_t defaultPoints[] = {
+    (0 << CAL_ML_S) | 2050, (50 << CAL_ML_S) | 2737, (100 << CAL_ML_S) | 2850, (200 << CAL_ML_S) | 2965,
+    (300 << CAL_ML_S) | 3112, (400 << CAL_ML_S) | 3237, (500 << CAL_ML_S) | 3325, (600 << CAL_ML_S) | 3437
+};
+#define DEFAULT_POINTS (sizeof(defaultPoints) / sizeof(defaultPoints[0]))
+
+static CAL_TABLE tables[2];
+static volatile uint8_t active = 0;                 // Table used by ticksToLevel
+
+static void loadTable(const uint32_t points[], uint8_t count)
+{
+    CAL_TABLE* table = &tables[active ^ 1];
+    uint8_t i = 0;
+    table->count = count;
+    for(i = 0; i < count; i++)
+    {
+        table->ticks[i] = points[i] & CAL_TICKS_M;
+        table->ml[i] = points[i] >> CAL_ML_S;
+    }
+    for(i = 0; i + 1 < count; i++)
+    {
+        table->slope[i] = Q16_RATIO((int32_t)table->ml[i + 1] - table->ml[i], table->ticks[i + 1] - table->ticks[i]);
+    }
+    active ^= 1;
+}
+
+static uint8_t readPoints(uint32_t points[])        // Stored points up to the first erased word
+{
+    uint8_t count = 0;
+    readEepromCacheBlock(CAL_BASE, points, CAL_POINTS);
+    while((count < CAL_POINTS) && (points[count] != 0xFFFFFFFF))
+    {
+        count++;
+    }
+    return count;
+}
+
+static bool writePoints(const uint32_t points[], uint8_t count)
+{
+    uint32_t words[CAL_POINTS];
+    uint8_t i = 0;
+    for(i = 0; i < CAL_POINTS; i++)
+    {
+        words[i] = (i < count) ? points[i] : 0xFFFFFFFF;
+    }
+    bool ok = writeEepromCacheBlock(CAL_BASE, words, CAL_POINTS);
+    initCalibration();                              // Loads what was stored, even if only part of it fitted
+    return ok;
+}
+
+void initCalibration()
+{
+    uint32_t points[CAL_POINTS];
+    uint8_t count = readPoints(points);
+    if(count < 2)                                   // Nothing calibrated yet, use the old fixed ranges
+    {
+        loadTable(defaultPoints, DEFAULT_POINTS);
+    }
+    else
+    {
+        loadTable(points, count);
+    }
+}
+
+uint16_t ticksToLevel(uint32_t ticks)
+{
+    const CAL_TABLE* table = &tables[active];
+    uint8_t low = 0;
+    uint8_t high = table->count - 1;
+
+    if(ticks <= table->ticks[0])
+    {
+        return table->ml[0];
+    }
+    if(ticks >= table->ticks[high])
+    {
+        return table->ml[high];
+    }
+    while(high - low > 1)                           // ticks[low] <= ticks < ticks[high]
+    {
+        uint8_t middle = (low + high) / 2;
+        if(ticks < table->ticks[middle])
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+    return table->ml[low] + Q16_SCALE(table->slope[low], (int32_t)ticks - table->ticks[low]);
+}
+
+bool setCalibrationPoint(uint16_t ticks, uint16_t ml)  // Adds a point, or moves the one already at those ticks
+{
+    uint32_t points[CAL_POINTS + 1];
+    uint8_t count = 0;
+    uint8_t i = 0;
+    const CAL_TABLE* table = &tables[active];
+
+    for(i = 0; i < table->count; i++)               // Starts from the table in use, which may be the defaults
+    {
+        if(table->ticks[i] != ticks)
+        {
+            points[count++] = ((uint32_t)table->ml[i] << CAL_ML_S) | table->ticks[i];
+        }
+    }
+    if(count == CAL_POINTS)
+    {
+        return false;
+    }
+    i = count;
+    while((i > 0) && ((points[i - 1] & CAL_TICKS_M) > ticks))  // Insertion keeps the table sorted
+    {
+        points[i] = points[i - 1];
+        i--;
+    }
+    points[i] = ((uint32_t)ml << CAL_ML_S) | ticks;
+    return writePoints(points, count + 1);
+}
+
+bool deleteCalibrationPoint(uint8_t point)
+{
+    uint32_t points[CAL_POINTS];
+    uint8_t count = 0;
+    uint8_t i = 0;
+    const CAL_TABLE* table = &tables[active];
+
+    if((point >= table->count) || (table->count <= 2))  // Interpolation needs two points
+    {
+        return false;
+    }
+    for(i = 0; i < table->count; i++)
+    {
+        if(i != point)
+        {
+            points[count++] = ((uint32_t)table->ml[i] << CAL_ML_S) | table->ticks[i];
+        }
+    }
+    return writePoints(points, count);
+}
+
+bool resetCalibration()                             // Back to the built-in points
+{
+    return writePoints(defaultPoints, 0);
+}
+
+uint8_t getCalibrationCount()
+{
+    return tables[active].count;
+}
+
+void getCalibrationPoint(uint8_t point, uint16_t* ticks, uint16_t* ml)
+{
+    *ticks = tables[active].ticks[point];
+    *ml = tables[active].ml[point];
+}
@@ -0,0 +1,29 @@
+/*
+ * calibration.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+
+// Water level calibration points in cache block 1, one word each, sorted by ticks
+#define CAL_BASE (BLOCK_WORDS*1)
+#define CAL_POINTS 16
+#define CAL_TICKS_M 0xFFFF                          // Comparator ticks in the low half
+#define CAL_ML_S 16                                 // Millilitres in the high half
+#define CAL_ML_M 0xFFFF
+
+void initCalibration();
+uint16_t ticksToLevel(uint32_t ticks);
+bool setCalibrationPoint(uint16_t ticks, uint16_t ml);
+bool deleteCalibrationPoint(uint8_t point);
+bool resetCalibration();
+uint8_t getCalibrationCount();
+void getCalibrationPoint(uint8_t point, uint16_t* ticks, uint16_t* ml);
+
+#endif /* CALIBRATION_H_ */
@@ -0,0 +1,261 @@
+//Append-only record log spread over all 32 EEPROM blocks so no word is rewritten more often than any other.
+//Every record is two words: value and header (CRC-16 | generation | key). The head walks through the
+//slots in order and the generation is bumped every time it wraps, so a torn write at power loss only
+//ever invalidates the newest record and boot recovery is a single pass over the log.
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+#include "configStore.h"
+
+#define HEADER_ERASED 0xFFFFFFFF
+#define KEY_MASK 0x3FF
+#define GEN_SHIFT 10
+#define GEN_MASK 0x3F
+#define CRC_SHIFT 16
+#define NO_SLOT 0xFFFF
+
+static uint16_t keySlot[STORE_MAX_KEYS];            // Slot holding the newest record of each key
+static uint16_t keyCount = 0;
+static uint16_t liveCount = 0;
+static uint16_t head = 0;
+static uint16_t tail = 0;
+static uint16_t used = 0;
+static uint8_t generation = 0;
+static uint32_t appends = 0;
+static uint32_t relocations = 0;
+static uint32_t laps = 0;
+
+static uint16_t crc16(uint16_t tag, uint32_t data)  // CRC-16/CCITT over the key/generation and the value
+{
+    uint8_t bytes[6] = {tag >> 8, tag, data >> 24, data >> 16, data >> 8, data};
+    uint16_t crc = 0xFFFF;
+    uint8_t i = 0;
+    uint8_t bit = 0;
+    for(i = 0; i < 6; i++)
+    {
+        crc ^= (uint16_t)bytes[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool readSlot(uint16_t slot, uint16_t* key, uint8_t* gen, uint32_t* data)  // False if the slot is erased or torn
+{
+    uint32_t record[2];
+    readEepromBlock(slot * 2, record, 2);
+    uint32_t header = record[1];
+    if(header == HEADER_ERASED)
+    {
+        return false;
+    }
+    *data = record[0];
+    *key = header & KEY_MASK;
+    *gen = (header >> GEN_SHIFT) & GEN_MASK;
+    return (header >> CRC_SHIFT) == crc16(header & 0xFFFF, *data);
+}
+
+static void programSlot(uint16_t key, uint32_t data) // Value first, then header: a torn record never passes the CRC
+{
+    uint16_t tag = (generation << GEN_SHIFT) | key;
+    uint32_t record[2] = {data, ((uint32_t)crc16(tag, data) << CRC_SHIFT) | tag};
+    writeEepromBlock(head * 2, record, 2);          // A value equal to the one left from the last lap is not reprogrammed
+
+    if(keySlot[key] == NO_SLOT)
+    {
+        liveCount++;
+    }
+    keySlot[key] = head;
+    appends++;
+    used++;
+    head++;
+    if(head == STORE_SLOTS)
+    {
+        head = 0;
+        generation = (generation + 1) & GEN_MASK;
+        laps++;
+    }
+}
+
+static void compact()                               // Reclaims the oldest slots, copying records that are still live to the head
+{
+    while((STORE_SLOTS - used) <= STORE_RESERVE)
+    {
+        uint16_t key = 0;
+        uint8_t gen = 0;
+        uint32_t data = 0;
+        if(readSlot(tail, &key, &gen, &data) && (key < keyCount) && (keySlot[key] == tail))
+        {
+            if(data == HEADER_ERASED)               // An erased key needs no record once every older one of it is reclaimed,
+            {                                       // the head overwrites those older slots before it reaches this one
+                keySlot[key] = NO_SLOT;
+                liveCount--;
+            }
+            else
+            {
+                programSlot(key, data);
+                relocations++;
+            }
+        }
+        tail = (tail + 1) % STORE_SLOTS;
+        used--;
+    }
+}
+
+static void formatStore(uint32_t* words, uint16_t count) // First boot on this layout: take over the old fixed-address words
+{
+    uint16_t i = 0;
+    uint32_t erased = HEADER_ERASED;
+    readEepromBlock(0, words, (count < STORE_WORDS) ? count : STORE_WORDS);
+    for(i = 0; i < STORE_SLOTS; i++)
+    {
+        writeEepromBlock(i * 2 + 1, &erased, 1);
+    }
+    head = 0;
+    tail = 0;
+    used = 0;
+    liveCount = 0;
+    generation = 0;
+    for(i = 0; i < count; i++)
+    {
+        if((words[i] != HEADER_ERASED) && (liveCount < STORE_CAPACITY))
+        {
+            programSlot(i, words[i]);
+        }
+        else
+        {
+            words[i] = HEADER_ERASED;               // Past the capacity old words are dropped instead of wrapping over the first ones
+        }
+    }
+}
+
+void initConfigStore(uint32_t* words, uint16_t count)
+{
+    uint16_t key = 0;
+    uint8_t gen = 0;
+    uint32_t data = 0;
+    uint16_t i = 0;
+
+    keyCount = count;
+    liveCount = 0;
+    for(i = 0; i < count; i++)
+    {
+        keySlot[i] = NO_SLOT;
+        words[i] = HEADER_ERASED;
+    }
+
+    // Find the head: the first slot that is not part of the current lap
+    if(readSlot(0, &key, &gen, &data))
+    {
+        generation = gen;
+        for(head = 1; head < STORE_SLOTS; head++)
+        {
+            if(!readSlot(head, &key, &gen, &data) || (gen != generation))
+            {
+                break;
+            }
+        }
+        if(head == STORE_SLOTS)
+        {
+            head = 0;
+            generation = (generation + 1) & GEN_MASK;
+        }
+    }
+    else if(readSlot(STORE_SLOTS - 1, &key, &gen, &data))
+    {
+        head = 0;                                   // Power was lost while wrapping to slot 0
+        generation = (gen + 1) & GEN_MASK;
+    }
+    else
+    {
+        head = STORE_SLOTS;
+        for(i = 1; i < STORE_SLOTS - 1; i++)
+        {
+            if(readSlot(i, &key, &gen, &data))
+            {
+                head = 0;
+                generation = (gen + 1) & GEN_MASK;
+                break;
+            }
+        }
+        if(head == STORE_SLOTS)
+        {
+            formatStore(words, count);
+            return;
+        }
+    }
+
+    // Replay oldest to newest so the last record of each key wins
+    for(i = 0; i < STORE_SLOTS; i++)
+    {
+        uint16_t slot = (head + i) % STORE_SLOTS;
+        if(readSlot(slot, &key, &gen, &data) && (key < count))
+        {
+            words[key] = data;
+            keySlot[key] = slot;
+        }
+    }
+
+    // Everything older than the oldest live record can be reclaimed
+    uint16_t oldest = STORE_SLOTS;
+    for(i = 0; i < count; i++)
+    {
+        if(keySlot[i] != NO_SLOT)
+        {
+            liveCount++;
+            uint16_t age = (keySlot[i] + STORE_SLOTS - head) % STORE_SLOTS;
+            if(age < oldest)
+            {
+                oldest = age;
+            }
+        }
+    }
+    used = (oldest == STORE_SLOTS) ? 0 : STORE_SLOTS - oldest;
+    tail = (head + STORE_SLOTS - used) % STORE_SLOTS;
+}
+
+bool writeConfig(uint16_t key, uint32_t data)       // False if the log has no room for another key
+{
+    if(key >= keyCount)
+    {
+        return false;
+    }
+    if(keySlot[key] == NO_SLOT)
+    {
+        if(data == HEADER_ERASED)                   // Never written, it already reads as erased
+        {
+            return true;
+        }
+        if(liveCount >= STORE_CAPACITY)
+        {
+            return false;
+        }
+    }
+    compact();
+    programSlot(key, data);
+    return true;
+}
+
+uint16_t getConfigRoom()                            // Keys without a record that can still be given one
+{
+    return STORE_CAPACITY - liveCount;
+}
+
+bool configHasRecord(uint16_t key)                  // Writing such a key never needs room
+{
+    return (key < keyCount) && (keySlot[key] != NO_SLOT);
+}
+
+void getStoreStats(STORE_STATS* stats)
+{
+    stats->head = head;
+    stats->used = used;
+    stats->live = liveCount;
+    stats->generation = generation;
+    stats->appends = appends;
+    stats->relocations = relocations;
+    stats->laps = laps;
+}
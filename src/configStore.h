@@ -0,0 +1,36 @@
+/*
+ * configStore.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CONFIGSTORE_H_
+#define CONFIGSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STORE_WORDS 512                             // 32 EEPROM blocks x 16 words
+#define STORE_SLOTS (STORE_WORDS / 2)               // Each record is a header word followed by the value
+#define STORE_RESERVE 8                             // Slots kept free ahead of the head for compaction
+#define STORE_CAPACITY (STORE_SLOTS - 2 * STORE_RESERVE)  // Most keys that can hold a value at once
+#define STORE_MAX_KEYS 1023                         // Keys are 10 bits, 0x3FF is never used
+
+typedef struct _STORE_STATS
+{
+    uint16_t head;                                  // Slot the next record goes into
+    uint16_t used;                                  // Slots between the oldest live record and the head
+    uint16_t live;                                  // Keys that have a record in the log
+    uint8_t generation;                             // Lap counter stored in every record
+    uint32_t appends;                               // Records written since boot
+    uint32_t relocations;                           // Live records copied forward by compaction since boot
+    uint32_t laps;                                  // Times the head wrapped since boot (each block rewritten once per lap)
+} STORE_STATS;
+
+void initConfigStore(uint32_t* words, uint16_t count);
+bool writeConfig(uint16_t key, uint32_t data);
+uint16_t getConfigRoom();
+bool configHasRecord(uint16_t key);
+void getStoreStats(STORE_STATS* stats);
+
+#endif /* CONFIGSTORE_H_ */
@@ -16,6 +16,14 @@
 #include "tm4c123gh6pm.h"
 #include "eeprom.h"
 
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t eepromReads = 0;
+static uint32_t eepromWrites = 0;
+static uint32_t eepromSkips = 0;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
@@ -32,6 +40,7 @@ void writeEeprom(uint16_t add, uint32_t data)
     EEPROM_EEBLOCK_R = add >> 4;
     EEPROM_EEOFFSET_R = add & 0xF;
     EEPROM_EERDWR_R = data;
+    eepromWrites++;
     while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
 }
 
@@ -39,5 +48,61 @@ uint32_t readEeprom(uint16_t add)
 {
     EEPROM_EEBLOCK_R = add >> 4;
     EEPROM_EEOFFSET_R = add & 0xF;
+    eepromReads++;
     return EEPROM_EERDWR_R;
 }
+
+// Writes consecutive words using the auto-increment register, words that already
+// hold the new value are skipped so they cost neither a program cycle nor wear
+void writeEepromBlock(uint16_t add, const uint32_t data[], uint16_t count)
+{
+    uint16_t i;
+    EEPROM_EEBLOCK_R = add >> 4;
+    EEPROM_EEOFFSET_R = add & 0xF;
+    for (i = 0; i < count; i++, add++)
+    {
+        if ((i > 0) && ((add & 0xF) == 0))             // auto-increment wraps inside a block, move to the next one
+        {
+            EEPROM_EEBLOCK_R = add >> 4;
+            EEPROM_EEOFFSET_R = 0;
+        }
+        eepromReads++;
+        if (EEPROM_EERDWR_R == data[i])
+        {
+            EEPROM_EEOFFSET_R = (add + 1) & 0xF;       // unchanged, step over it
+            eepromSkips++;
+        }
+        else
+        {
+            EEPROM_EERDWRINC_R = data[i];
+            eepromWrites++;
+            while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+        }
+    }
+}
+
+// Reads consecutive words using the auto-increment register
+void readEepromBlock(uint16_t add, uint32_t data[], uint16_t count)
+{
+    uint16_t i;
+    EEPROM_EEBLOCK_R = add >> 4;
+    EEPROM_EEOFFSET_R = add & 0xF;
+    for (i = 0; i < count; i++, add++)
+    {
+        if ((i > 0) && ((add & 0xF) == 0))
+        {
+            EEPROM_EEBLOCK_R = add >> 4;
+            EEPROM_EEOFFSET_R = 0;
+        }
+        data[i] = EEPROM_EERDWRINC_R;
+        eepromReads++;
+    }
+}
+
+// Number of word reads, writes and skipped (unchanged) writes that reached the EEPROM module since boot
+void getEepromCounts(uint32_t* reads, uint32_t* writes, uint32_t* skips)
+{
+    *reads = eepromReads;
+    *writes = eepromWrites;
+    *skips = eepromSkips;
+}
@@ -18,5 +18,8 @@
 void initEeprom(void);
 void writeEeprom(uint16_t add, uint32_t data);
 uint32_t readEeprom(uint16_t add);
+void writeEepromBlock(uint16_t add, const uint32_t data[], uint16_t count);
+void readEepromBlock(uint16_t add, uint32_t data[], uint16_t count);
+void getEepromCounts(uint32_t* reads, uint32_t* writes, uint32_t* skips);
 
 #endif
@@ -0,0 +1,90 @@
+//Write-through RAM copy of the schedule blocks and settings so ISRs and commands never wait on the EEPROM.
+//The words live in the record log of configStore.c, so an address here is a key and not an EEPROM offset.
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+#include "configStore.h"
+#include "eepromCache.h"
+
+static uint32_t cache[CACHE_WORDS];
+static uint32_t cacheReads = 0;
+static uint32_t cacheWrites = 0;
+static uint32_t cacheSkips = 0;
+
+void initEepromCache()                              // Loads the settings and every feeding event once at boot
+{
+    initConfigStore(cache, CACHE_WORDS);
+}
+
+uint32_t readEepromCache(uint16_t add)
+{
+    if(add < CACHE_WORDS)
+    {
+        cacheReads++;
+        return cache[add];
+    }
+    return 0xFFFFFFFF;                              // Nothing is stored outside the cached blocks, read as erased
+}
+
+bool writeEepromCache(uint16_t add, uint32_t data)  // False if the EEPROM has no room left for the word
+{
+    if(add >= CACHE_WORDS)
+    {
+        return false;
+    }
+    if(cache[add] == data)                          // Rewriting the stored value would only cost wear
+    {
+        cacheSkips++;
+        return true;
+    }
+    if(!writeConfig(add, data))                     // Write-through so the EEPROM always matches the cache
+    {
+        return false;
+    }
+    cache[add] = data;
+    cacheWrites++;
+    return true;
+}
+
+void readEepromCacheBlock(uint16_t add, uint32_t data[], uint16_t count)
+{
+    uint16_t i = 0;
+    for(i = 0; i < count; i++)
+    {
+        data[i] = readEepromCache(add + i);
+    }
+}
+
+bool writeEepromCacheBlock(uint16_t add, const uint32_t data[], uint16_t count)  // Only the words that change reach the EEPROM
+{
+    bool ok = true;
+    uint16_t i = 0;
+    for(i = 0; i < count; i++)
+    {
+        ok &= writeEepromCache(add + i, data[i]);
+    }
+    return ok;
+}
+
+bool eepromCacheFits(uint16_t add, const uint32_t data[], uint16_t count)  // True when writing the block cannot run out of room
+{
+    uint16_t newKeys = 0;
+    uint16_t i = 0;
+    for(i = 0; i < count; i++)
+    {
+        if((add + i < CACHE_WORDS) && (cache[add + i] != data[i]) && (data[i] != 0xFFFFFFFF) && !configHasRecord(add + i))
+        {
+            newKeys++;                              // Erasing frees no room until compaction drops the record
+        }
+    }
+    return (add + count <= CACHE_WORDS) && (newKeys <= getConfigRoom());
+}
+
+void getEepromStats(EEPROM_STATS* stats)
+{
+    stats->cacheReads = cacheReads;
+    stats->cacheWrites = cacheWrites;
+    stats->cacheSkips = cacheSkips;
+    getEepromCounts(&stats->eepromReads, &stats->eepromWrites, &stats->eepromSkips);
+}
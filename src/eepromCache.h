@@ -0,0 +1,51 @@
+/*
+ * eepromCache.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef EEPROMCACHE_H_
+#define EEPROMCACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BLOCK_WORDS 16                              // Words per block of the old fixed layout
+#define SETTING_BLOCKS 10                           // Blocks 0-9: settings (block 0 words 6-8), formerly one feeding event per block
+#define MAX_EVENTS 256                              // Feeding events, two words each after the settings blocks
+#define EVENT_WORDS 2
+#define EVENT_BASE (BLOCK_WORDS * SETTING_BLOCKS)
+#define CACHE_WORDS (EVENT_BASE + (MAX_EVENTS * EVENT_WORDS))
+
+// Settings words in block 0 (words 6-8 are volume, fill mode and alert mode)
+#define SETTING_WEEKDAY ((16*0)+9)                  // Weekday of RTC day 0, 0 = Sunday
+#define SETTING_POWER ((16*0)+10)                   // 1 when the feeder may hibernate between wake-ups
+#define SETTING_LAYOUT ((16*0)+11)                  // Erased until the old event blocks have been converted
+#define SETTING_FILTER ((16*0)+12)                  // Water level burst size and moving average shift
+#define SETTING_SAMPLE ((16*0)+13)                  // Fastest and slowest water level sampling periods
+#define SETTING_PUMP ((16*0)+14)                    // Pump refill band, maximum run and minimum off-time
+#define SETTING_MOTION ((16*0)+15)                  // PIR minimum presence and hold-off times
+
+// Settings words in block 4 (block 1 is the calibration table, blocks 2-3 the visit counts)
+#define SETTING_AUGER ((16*4)+0)                    // Auger ramp and anti-jam profile, words 1-8 are the auger calibration
+#define SETTING_PUMP_SPEED ((16*4)+9)               // Pump minimum speed and taper distance
+
+typedef struct _EEPROM_STATS
+{
+    uint32_t cacheReads;                            // Reads served from RAM
+    uint32_t cacheWrites;                           // Writes passed through to the EEPROM
+    uint32_t cacheSkips;                            // Writes dropped because the word already held the value
+    uint32_t eepromReads;                           // Word reads that reached the EEPROM module
+    uint32_t eepromWrites;                          // Word writes that reached the EEPROM module
+    uint32_t eepromSkips;                           // Block writes skipped by the driver, word unchanged
+} EEPROM_STATS;
+
+void initEepromCache();
+uint32_t readEepromCache(uint16_t add);
+bool writeEepromCache(uint16_t add, uint32_t data);
+void readEepromCacheBlock(uint16_t add, uint32_t data[], uint16_t count);
+bool writeEepromCacheBlock(uint16_t add, const uint32_t data[], uint16_t count);
+bool eepromCacheFits(uint16_t add, const uint32_t data[], uint16_t count);
+void getEepromStats(EEPROM_STATS* stats);
+
+#endif /* EEPROMCACHE_H_ */
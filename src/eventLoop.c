@@ -0,0 +1,166 @@
+//Cooperative main loop support. Software timers count SysTick ticks and their callbacks run in the
+//main loop, all timer state is owned by the main loop and the tick ISR only compares against the
+//next deadline. SysTick is stopped while no timer is running so an idle feeder is not woken 100
+//times a second. When there is no work left the core sleeps in WFI until the next interrupt.
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "isrQueue.h"
+#include "eventLoop.h"
+#include "fixedPoint.h"
+
+typedef struct _SOFT_TIMER
+{
+    bool running;
+    bool periodic;
+    uint32_t period;                                // Ticks
+    uint32_t deadline;                              // Tick the timer is due on
+    void (*callback)();
+} SOFT_TIMER;
+
+static SOFT_TIMER timers[SOFT_TIMERS];
+static volatile uint32_t ticks = 0;                 // Written by the tick ISR only
+static volatile uint32_t nextDeadline = 0;          // Written by the main loop only
+static uint32_t wakes = 0;
+static uint32_t timersRun = 0;
+static uint64_t idleCycles = 0;
+static uint64_t totalCycles = 0;
+static uint32_t lastCycles = 0;
+
+static bool due(uint32_t deadline)                  // Wrap-safe compare against the tick count
+{
+    return (int32_t)(ticks - deadline) >= 0;
+}
+
+static void armTick()                               // Points the tick ISR at the earliest running timer
+{
+    uint8_t i = 0;
+    bool running = false;
+    uint32_t earliest = 0;
+    for(i = 0; i < SOFT_TIMERS; i++)
+    {
+        if(timers[i].running && (!running || ((int32_t)(timers[i].deadline - earliest) < 0)))
+        {
+            earliest = timers[i].deadline;
+            running = true;
+        }
+    }
+    if(running)
+    {
+        nextDeadline = earliest;
+        NVIC_ST_CTRL_R |= NVIC_ST_CTRL_INTEN;
+        if(due(earliest))                           // The tick may have passed it while it was set
+        {
+            NVIC_INT_CTRL_R = NVIC_INT_CTRL_PENDSTSET;
+        }
+    }
+    else
+    {
+        NVIC_ST_CTRL_R &= ~NVIC_ST_CTRL_INTEN;      // Nothing to time, let the core sleep
+    }
+}
+
+void initEventLoop()
+{
+    NVIC_ST_CTRL_R = 0;                             // SysTick off while it is set up
+    NVIC_ST_RELOAD_R = MS_TO_CYCLES(TICK_MS) - 1;
+    NVIC_ST_CURRENT_R = 0;
+    NVIC_ST_CTRL_R = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_ENABLE;  // Interrupt is enabled by startTimer
+    lastCycles = getCycles();
+}
+
+void sysTickISR()
+{
+    uint32_t start = isrEnter();
+    ticks++;
+    if(due(nextDeadline))
+    {
+        NVIC_ST_CTRL_R &= ~NVIC_ST_CTRL_INTEN;      // Off until runTimers has looked at the timers
+        postWork(WORK_TICK, 0);
+    }
+    isrExit(ISR_SYSTICK, start);
+}
+
+void startTimer(uint8_t timer, uint32_t ms, bool periodic, void (*callback)())
+{
+    uint32_t period = (ms + TICK_MS - 1) / TICK_MS;
+    if(period == 0)
+    {
+        period = 1;
+    }
+    timers[timer].period = period;
+    timers[timer].periodic = periodic;
+    timers[timer].callback = callback;
+    timers[timer].deadline = ticks + period;
+    timers[timer].running = true;
+    armTick();
+}
+
+void stopTimer(uint8_t timer)
+{
+    timers[timer].running = false;
+    armTick();
+}
+
+bool timersRunning()
+{
+    uint8_t i = 0;
+    for(i = 0; i < SOFT_TIMERS; i++)
+    {
+        if(timers[i].running)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void runTimers()                                    // Runs the callbacks of the timers that are due
+{
+    uint8_t i = 0;
+    for(i = 0; i < SOFT_TIMERS; i++)
+    {
+        if(timers[i].running && due(timers[i].deadline))
+        {
+            if(timers[i].periodic)
+            {
+                timers[i].deadline += timers[i].period;
+            }
+            else
+            {
+                timers[i].running = false;
+            }
+            timersRun++;
+            timers[i].callback();                   // May start or stop timers itself
+        }
+    }
+    armTick();
+}
+
+void sleepUntilWork()
+{
+    uint32_t now = 0;
+    __asm(" cpsid i");                              // An interrupt between the check and WFI still wakes the core
+    if(!workPending())
+    {
+        now = getCycles();
+        totalCycles += now - lastCycles;
+        lastCycles = now;
+        __asm(" wfi");
+        now = getCycles();
+        idleCycles += now - lastCycles;
+        wakes++;
+    }
+    now = getCycles();
+    totalCycles += now - lastCycles;
+    lastCycles = now;
+    __asm(" cpsie i");                              // The pending interrupt runs here
+}
+
+void getLoopStats(LOOP_STATS* stats)
+{
+    stats->wakes = wakes;
+    stats->timersRun = timersRun;
+    stats->idleCycles = idleCycles;
+    stats->totalCycles = totalCycles;
+}
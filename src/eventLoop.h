@@ -0,0 +1,32 @@
+/*
+ * eventLoop.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TICK_MS 10                                  // SysTick period while a software timer is running
+#define SOFT_TIMERS 4
+
+typedef struct _LOOP_STATS
+{
+    uint32_t wakes;                                 // Times the core left WFI
+    uint32_t timersRun;                             // Software timer callbacks run
+    uint64_t idleCycles;                            // System clocks spent asleep
+    uint64_t totalCycles;                           // System clocks since the loop started
+} LOOP_STATS;
+
+void initEventLoop();
+void startTimer(uint8_t timer, uint32_t ms, bool periodic, void (*callback)());
+void stopTimer(uint8_t timer);
+bool timersRunning();
+void runTimers();
+void sleepUntilWork();
+void getLoopStats(LOOP_STATS* stats);
+
+#endif /* EVENTLOOP_H_ */
@@ -0,0 +1,47 @@
+/*
+ * fixedPoint.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FIXEDPOINT_H_
+#define FIXEDPOINT_H_
+
+#include <stdint.h>
+
+//Integer fixed-point helpers so the interrupts never touch soft-float. Q16.16 holds ratios and slopes,
+//Q8.8 holds averaged sensor ticks. The Q8 macros only shift, so they also work on a 32 bit Q24.8.
+//Q16() and Q8() are for constants only, the compiler folds them and no float code is generated.
+
+typedef int32_t q16_t;                              // Q16.16
+typedef int16_t q8_t;                               // Q8.8
+
+#define Q16_SHIFT 16
+#define Q16_ONE (1 << Q16_SHIFT)
+#define Q16_HALF (1 << (Q16_SHIFT - 1))
+#define Q16(x) ((q16_t)((x) * Q16_ONE + (((x) >= 0) ? 0.5 : -0.5)))
+#define Q16_FROM_INT(i) ((q16_t)(i) * Q16_ONE)
+#define Q16_TO_INT(q) (((q) + Q16_HALF) >> Q16_SHIFT)       // Rounded to nearest
+#define Q16_TRUNC(q) ((q) >> Q16_SHIFT)
+#define Q16_MUL(a, b) ((q16_t)((((int64_t)(a) * (b)) + Q16_HALF) >> Q16_SHIFT))
+#define Q16_DIV(a, b) ((q16_t)(((int64_t)(a) * Q16_ONE) / (b)))
+#define Q16_RATIO(n, d) ((q16_t)(((int64_t)(n) * Q16_ONE) / (d)))  // n/d of two integers
+#define Q16_SCALE(q, i) ((int32_t)Q16_TO_INT((int64_t)(q) * (i)))  // Integer times a Q16.16 ratio, rounded, 64-bit product
+
+#define Q8_SHIFT 8
+#define Q8_ONE (1 << Q8_SHIFT)
+#define Q8_HALF (1 << (Q8_SHIFT - 1))
+#define Q8(x) ((q8_t)((x) * Q8_ONE + (((x) >= 0) ? 0.5 : -0.5)))
+#define Q8_FROM_INT(i) ((i) * Q8_ONE)
+#define Q8_TO_INT(q) (((q) + Q8_HALF) >> Q8_SHIFT)
+#define Q8_TRUNC(q) ((q) >> Q8_SHIFT)
+#define Q8_MUL(a, b) ((q8_t)((((int32_t)(a) * (b)) + Q8_HALF) >> Q8_SHIFT))
+
+// Compile-time time scaling for the 40 MHz system clock
+#define CLOCK_HZ 40000000
+#define MS_TO_CYCLES(ms) ((uint32_t)(ms) * (uint32_t)(CLOCK_HZ / 1000))
+#define S_TO_CYCLES(s) ((uint32_t)(s) * (uint32_t)CLOCK_HZ)
+#define CYCLES_TO_US(c) ((uint32_t)(((uint32_t)(c) + (CLOCK_HZ / 1000000) - 1) / (CLOCK_HZ / 1000000)))  // Rounded up
+#define CYCLES_TO_S(c) ((uint32_t)(c) / (uint32_t)CLOCK_HZ)
+
+#endif /* FIXEDPOINT_H_ */
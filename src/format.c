@@ -0,0 +1,144 @@
+//Small printf for the console. Characters go straight from the format to the UART transmit ring, so a
+//report needs no line buffer on the stack and the libc printf with its float support stays out of flash.
+//Only what the firmware prints is supported; integers are 32 bits and decimals are fixed point.
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "uart0.h"
+#include "format.h"
+
+static const char lowerDigits[] = "0123456789abcdef";
+static const char upperDigits[] = "0123456789ABCDEF";
+
+static void putNumber(void (*put)(char c), bool negative, uint32_t value, uint8_t base, const char* digits,
+                      uint8_t width, bool zero, uint8_t places)
+{
+    char text[12];                                  // 32 bits in decimal, least significant digit first
+    uint8_t count = 0;
+    uint8_t length = 0;
+
+    do
+    {
+        text[count++] = digits[value % base];
+        value /= base;
+    } while(((value != 0) || (count <= places)) && (count < sizeof(text)));  // 0.05 needs its leading 0
+
+    length = count + (negative ? 1 : 0) + ((places != 0) ? 1 : 0);
+    if(negative && zero)
+    {
+        put('-');
+    }
+    while(width > length)
+    {
+        put(zero ? '0' : ' ');
+        width--;
+    }
+    if(negative && !zero)
+    {
+        put('-');
+    }
+    while(count > 0)
+    {
+        if((count == places) && (places != 0))
+        {
+            put('.');
+        }
+        put(text[--count]);
+    }
+}
+
+void formatText(void (*put)(char c), const char* format, va_list args)
+{
+    while(*format != '\0')
+    {
+        char c = *format++;
+        bool zero = false;
+        uint8_t width = 0;
+        uint8_t places = 0;
+
+        if(c != '%')
+        {
+            put(c);
+            continue;
+        }
+        if(*format == '0')
+        {
+            zero = true;
+            format++;
+        }
+        while((*format >= '0') && (*format <= '9'))
+        {
+            width = (width * 10) + (*format++ - '0');
+        }
+        if(*format == '.')
+        {
+            format++;
+            while((*format >= '0') && (*format <= '9'))
+            {
+                places = (places * 10) + (*format++ - '0');
+            }
+        }
+        while(*format == 'l')                       // long is int sized here
+        {
+            format++;
+        }
+
+        c = *format;
+        if(c == '\0')
+        {
+            return;
+        }
+        format++;
+        if(c == 'd')
+        {
+            int32_t value = va_arg(args, int32_t);
+            putNumber(put, value < 0, (value < 0) ? 0u - (uint32_t)value : (uint32_t)value, 10, lowerDigits, width, zero, places);
+        }
+        else if(c == 'u')
+        {
+            putNumber(put, false, va_arg(args, uint32_t), 10, lowerDigits, width, zero, places);
+        }
+        else if((c == 'x') || (c == 'X'))
+        {
+            putNumber(put, false, va_arg(args, uint32_t), 16, (c == 'x') ? lowerDigits : upperDigits, width, zero, 0);
+        }
+        else if(c == 's')
+        {
+            const char* text = va_arg(args, const char*);
+            uint8_t length = 0;
+            while(text[length] != '\0')
+            {
+                length++;
+            }
+            while(width > length)
+            {
+                put(' ');
+                width--;
+            }
+            while(*text != '\0')
+            {
+                put(*text++);
+            }
+        }
+        else if(c == 'c')
+        {
+            put((char)va_arg(args, int));
+        }
+        else                                        // %% and anything unknown are printed as they are
+        {
+            if(c != '%')
+            {
+                put('%');
+            }
+            put(c);
+        }
+    }
+}
+
+void printUart0(const char* format, ...)            // Formats straight into the transmit ring, muted with putsUart0
+{
+    va_list args;
+    va_start(args, format);
+    formatText(putTextUart0, format, args);
+    va_end(args);
+}
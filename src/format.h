@@ -0,0 +1,21 @@
+/*
+ * format.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+// Conversions: %d %u %x %X %s %c %%, with an optional '0' flag and width (%02d, %3d).
+// A precision prints a fixed-point decimal: %.1u of 123 is "12.3", %.3d of -5 is "-0.005".
+// 'l' is accepted and ignored on the target where int and long are both 32 bits.
+
+void formatText(void (*put)(char c), const char* format, va_list args);
+void printUart0(const char* format, ...);
+
+#endif /* FORMAT_H_ */
@@ -7,100 +7,194 @@
 #include "clock.h"
 #include "uart0.h"
 #include "tm4c123gh6pm.h"
+#include "getInput.h"
 
-//STRUCT:
-#define MAX_CHARS 80
-#define MAX_FIELDS 5
-typedef struct _USER_DATA
+
+void getsUart0(USER_DATA* data)
 {
-    char buffer[MAX_CHARS+1];
-    uint8_t fieldCount;
-    uint8_t fieldPosition[MAX_FIELDS];
-    char fieldType[MAX_FIELDS];
-} USER_DATA;
+    data->charCount = 0;
+    while(!addCharacter(data, getcUart0()));     //getting serial data until the line is complete
+}
 
+//Adds one received character to the line, returns true once the line is complete.
+//The line is assembled a character at a time so it can be fed from the UART interrupt.
+bool addCharacter(USER_DATA* data, char c)
+{
+    if((c == 8 || c == 127) && (data->charCount > 0))   //Checking if the character is a backspace (ASCII code 8 or 127) and count > 0
+    {
+        data->charCount--;                              //decrement the last character
+    }
 
+    else if(c == 13)                          //Adding a null terminator at the end of string after carriage return (ASCII code 13
+    {
+        data->buffer[data->charCount] = '\0';
+        data->charCount = 0;
+        return true;
+    }
 
-void getsUart0(USER_DATA* data)
-{
-    uint8_t count = 0;
-    while(true)
+    else if (c >= 32)                         //Incrementing count when space (ASCII code 32) is pressed
     {
-        char c = getcUart0();                     //getting serial data
-        if((c == 8 || c == 127) && (count > 0))   //Checking if the character is a backspace (ASCII code 8 or 127) and count > 0
-        {
-            count--;                              //decrement the last character
-        }
+        data->buffer[data->charCount] = c;
+        data->charCount++;
 
-        else if(c == 13)                          //Adding a null terminator at the end of string after carriage return (ASCII code 13
+        if (data->charCount == MAX_CHARS)     //MAX chars [80] typed results in returning the whole string in the next line.
         {
-            data -> buffer[count] = '\0';
-            return;
+            putcUart0('\n');
+            data->buffer[data->charCount] = '\0';
+            data->charCount = 0;
+            return true;
         }
+    }
+    return false;
+}
 
-        else if (c >= 32)                         //Incrementing count when space (ASCII code 32) is pressed
-        {
-            data->buffer[count] = c;
-            count++;
+//Checks for the characters that separate fields
+bool isDelimiter(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == ',') || (c == '\0');
+}
 
-            if (count == MAX_CHARS)               //MAX chars [80] typed results in returning the whole string in the next line.
-            {
-                putcUart0('\n');
-                data->buffer[count] = '\0';
-                return;
-            }
+//Reads an unsigned decimal number at text, stops at the first non digit. Returns false when it exceeds limit.
+bool readDigits(const char* text, uint8_t* length, uint32_t limit, uint32_t* value)
+{
+    uint8_t i = 0;
+    *value = 0;
+    while((text[i] >= '0') && (text[i] <= '9'))
+    {
+        uint32_t digit = text[i] - '0';
+        if(*value > (limit - digit) / 10)        //value * 10 + digit would pass the limit
+        {
+            return false;
         }
+        *value = (*value * 10) + digit;
+        i++;
     }
+    *length = i;
+    return i > 0;
 }
 
-//Parsing the strings input by the user.
-void parseFields(USER_DATA* data)
+//Splits the line into typed fields in one pass, in place: each field stays in the buffer and is
+//NUL terminated where its delimiter was. Numbers and times are converted here so the commands do not
+//parse them again. Returns PARSE_OK, or the error with fieldCount holding the index of the bad field.
+uint8_t parseFields(USER_DATA* data, uint8_t maxFields)
 {
-    data->fieldCount = 0;
     uint8_t i = 0;
-    int prevCh = 0;
-    uint8_t indexcount= 0;
+    data->fieldCount = 0;
+    if(maxFields > MAX_FIELDS)
+    {
+        maxFields = MAX_FIELDS;
+    }
 
-    while(data->buffer[i]) // != '\0' && data->fieldCount < MAX_FIELDS)   When data buffer is not empty, the while loop is true
+    while(true)
     {
-        if (((data->buffer[i] >= 'a') && (data->buffer[i] <= 'z')) || ((data->buffer[i] >= 'A') && (data->buffer[i] <= 'Z'))) //checking if the char given is alphanumeric
+        char c;
+        uint8_t start = 0;
+        uint8_t field = data->fieldCount;
+        uint8_t error = PARSE_OK;
+
+        while(isDelimiter(data->buffer[i]) && (data->buffer[i] != '\0'))    //Skipping to the next field
         {
-            if (prevCh == 0) //Transition from delimiter to alpha char
-            {
-                data->fieldType[indexcount] = 'a';      //Assigns 'a' if the string is alphanumeric
-                data->fieldPosition[indexcount] = i;    //The char position of the string is assigned to 'i'.
-                data->fieldCount++;
-                prevCh = 1;
-                indexcount++;
+            i++;
+        }
+        if(data->buffer[i] == '\0')
+        {
+            return PARSE_OK;
+        }
+        if(field == maxFields)
+        {
+            return PARSE_TOO_MANY;
+        }
 
+        start = i;
+        c = data->buffer[i];
+        data->fieldValue[field] = 0;
+        if(((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')))    //Identifier, a letter then letters, digits or '_'
+        {
+            data->fieldType[field] = 'a';
+            do
+            {
+                c = data->buffer[++i];
+            } while(((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '_'));
+            error = PARSE_BAD_CHAR;
+        }
+        else if(c == '"')                                                   //Quoted string, the field starts after the quote
+        {
+            data->fieldType[field] = 's';
+            start = ++i;
+            while((data->buffer[i] != '"') && (data->buffer[i] != '\0'))
+            {
+                i++;
+            }
+            if(data->buffer[i] == '\0')
+            {
+                data->fieldCount = field;
+                return PARSE_BAD_STRING;
             }
+            data->buffer[i++] = '\0';                                      //The closing quote ends the field
+            error = PARSE_BAD_CHAR;
         }
-
-        else if (((data->buffer[i] >= '0') && (data->buffer[i] <= '9')) || (data->buffer[i] == '-') || (data->buffer[i] == '.')) //printing 'n' if numeric
+        else if(((c >= '0') && (c <= '9')) || (c == '-'))                  //Integer, or HH:MM when a colon follows
         {
-           if(prevCh == 0) //Transition from delimiter to numeric char
-           {
-               data->fieldType[indexcount] = 'n';
-               data->fieldPosition[indexcount] = i;
-               data->fieldCount++;
-               prevCh = 1;
-               indexcount++;
-
+            bool negative = (c == '-');
+            uint8_t length = 0;
+            uint32_t value = 0;
+            data->fieldType[field] = 'n';
+            error = PARSE_BAD_NUMBER;
+            if(negative)
+            {
+                i++;
+            }
+            if(readDigits(&data->buffer[i], &length, negative ? 2147483648u : 2147483647u, &value))
+            {
+                i += length;
+                data->fieldValue[field] = negative ? (int32_t)(0u - value) : (int32_t)value;
+                if((data->buffer[i] == ':') && !negative)
+                {
+                    uint32_t mins = 0;
+                    data->fieldType[field] = 't';
+                    error = PARSE_BAD_TIME;
+                    if((length <= 2) && (value < 24) && readDigits(&data->buffer[i + 1], &length, 59, &mins) && (length == 2))
+                    {
+                        i += length + 1;
+                        data->fieldValue[field] = (value * 60) + mins;  //Minutes after midnight
+                    }
+                    else
+                    {
+                        data->fieldCount = field;
+                        return PARSE_BAD_TIME;
+                    }
+                }
+            }
+            else
+            {
+                data->fieldCount = field;
+                return PARSE_BAD_NUMBER;
             }
         }
-        else                              //If its not a alphanumeric or numeric
+        else
         {
-            data->buffer[i] = '\0';       //the end is given a NULL
-            prevCh = 0;
+            data->fieldCount = field;
+            return PARSE_BAD_CHAR;
+        }
+
+        if(!isDelimiter(data->buffer[i]))          //Something like "12ab" or "on!"
+        {
+            data->fieldCount = field;
+            return error;
+        }
+        data->fieldPosition[field] = start;
+        data->fieldCount++;
+        if(data->buffer[i] != '\0')
+        {
+            data->buffer[i++] = '\0';             //Terminating the field in place
         }
-        i++;
     }
 }
 
 //Gets the string typed
 char* getFieldString(USER_DATA* data, uint8_t fieldNumber)
 {
-    if(fieldNumber <= MAX_FIELDS)
+    if(fieldNumber < data->fieldCount)
     {
         return &(data->buffer[data->fieldPosition[fieldNumber]]);
     }
@@ -110,62 +204,89 @@ char* getFieldString(USER_DATA* data, uint8_t fieldNumber)
     }
 }
 
+//Gets a number field, 0 when the field is missing or not a number
 int32_t getFieldInteger(USER_DATA* data, uint8_t fieldNumber)
 {
-    int32_t i = 0;
-    int32_t fieldint = 0;
-    char *strtoi;
-
-    if((fieldNumber <= data -> fieldCount) && (data->fieldType[fieldNumber] == 'n'))
+    if((fieldNumber < data->fieldCount) && (data->fieldType[fieldNumber] == 'n'))
     {
-        strtoi = &(data->buffer[data->fieldPosition[fieldNumber]]);
-        while(strtoi[i])
-        {
-            fieldint = fieldint * 10 + (strtoi[i] - '0');
-            i++;
-        }
-        return fieldint;
+        return data->fieldValue[fieldNumber];
     }
     return 0;
 }
 
-//Function to compare the
-bool isCommand (USER_DATA * data, const char strCommand[], uint8_t minArguments)
+//Gets a time of day either from one HH:MM field or from two number fields "HH MM".
+//Returns false when the fields are not a time or it is out of range.
+bool getFieldTime(USER_DATA* data, uint8_t fieldNumber, uint16_t* hour, uint16_t* mins)
 {
-    uint8_t argCount = (data->fieldCount)-1;  // number of arguments (excluding the command field)
-    uint8_t i;
-    uint8_t index = 0;
-
-    int strSize = 0;
-    while (strCommand[strSize] != '\0')
+    int32_t h = 0;
+    int32_t m = 0;
+    if((fieldNumber < data->fieldCount) && (data->fieldType[fieldNumber] == 't'))
+    {
+        h = data->fieldValue[fieldNumber] / 60;
+        m = data->fieldValue[fieldNumber] % 60;
+    }
+    else if((fieldNumber + 1 < data->fieldCount) && (data->fieldType[fieldNumber] == 'n') && (data->fieldType[fieldNumber + 1] == 'n'))
+    {
+        h = data->fieldValue[fieldNumber];
+        m = data->fieldValue[fieldNumber + 1];
+    }
+    else
     {
-        ++strSize;
+        return false;
     }
+    *hour = h;
+    *mins = m;
+    return (h >= 0) && (h < 24) && (m >= 0) && (m < 60);
+}
 
-    while (data ->buffer[index] != '\0')
+//Returns the first entry named like the command, or -1. The table is sorted on the name,
+//so a line costs one string compare per halving instead of a scan per command.
+int16_t findCommand(const COMMAND table[], uint8_t count, const char* name)
+{
+    int16_t low = 0;
+    int16_t high = count;                           // One past the last candidate
+
+    while(low < high)                               // Lower bound, lands on the first of several entries with the name
     {
-        for(i = 0; i < strSize ; i++)
+        int16_t middle = (low + high) / 2;
+        if(cmpStr(table[middle].name, name) < 0)
         {
-            if (data->buffer[index + i] != strCommand[i])
-            {
-                break;
-            }
+            low = middle + 1;
         }
+        else
+        {
+            high = middle;
+        }
+    }
+    if((low < count) && (cmpStr(table[low].name, name) == 0))
+    {
+        return low;
+    }
+    return -1;
+}
+
+//Checks the argument count, the subcommand and the type of each argument against one table entry
+bool matchArguments(const COMMAND* command, USER_DATA* data)
+{
+    uint8_t argCount = data->fieldCount - 1;        // number of arguments (excluding the command field)
+    uint8_t i = 0;
 
-        if (i == strSize)
+    if((argCount < command->minArgs) || (argCount > command->maxArgs))
+    {
+        return false;
+    }
+    if((command->sub != NULL) && (cmpStr(getFieldString(data, 1), command->sub) != 0))
+    {
+        return false;
+    }
+    for(i = 0; (i < argCount) && (command->argTypes[i] != '\0'); i++)
+    {
+        if((command->argTypes[i] != '?') && (command->argTypes[i] != data->fieldType[i + 1]))
         {
-            if (argCount >= minArguments)
-            {
-                return 1;  // Command found and has enough arguments
-            }
-            else
-            {
-                return 0;  // Command found but not enough arguments
-            }
+            return false;
         }
-        index++;
     }
-    return 0;
+    return true;
 }
 
 //Function to compare the strings (Custom strcmp)
@@ -13,21 +13,46 @@
 #include <stdbool.h>
 
 #define MAX_CHARS 80
-#define MAX_FIELDS 5
+#define MAX_FIELDS 10
 typedef struct _USER_DATA
 {
     char buffer[MAX_CHARS+1];
+    uint8_t charCount;                  // Characters typed so far, used while the line is assembled
     uint8_t fieldCount;
     uint8_t fieldPosition[MAX_FIELDS];
-    char fieldType[MAX_FIELDS];
+    char fieldType[MAX_FIELDS];         // 'a' word, 'n' number, 't' HH:MM, 's' quoted string
+    int32_t fieldValue[MAX_FIELDS];     // Numbers, and times as minutes after midnight
 } USER_DATA;
 
+// Results of parseFields
+#define PARSE_OK         0
+#define PARSE_TOO_MANY   1              // More fields than the limit
+#define PARSE_BAD_NUMBER 2              // Does not fit in 32 bits, or letters after the digits
+#define PARSE_BAD_TIME   3              // Not HH:MM between 00:00 and 23:59
+#define PARSE_BAD_STRING 4              // No closing quote
+#define PARSE_BAD_CHAR   5              // A character that cannot start or continue a field
+
+#define ANY_ARGS (MAX_FIELDS - 1)
+typedef struct _COMMAND
+{
+    const char* name;                   // First field, tables are sorted on it
+    const char* sub;                    // Second field when it selects a subcommand, otherwise NULL
+    uint8_t minArgs;                    // Fields after the name
+    uint8_t maxArgs;
+    const char* argTypes;               // One type per argument as in fieldType, '?' any
+    void (*run)(USER_DATA* data);
+    const char* usage;
+} COMMAND;
+
 
 void getsUart0(USER_DATA* data);
-void parseFields(USER_DATA* data);
+bool addCharacter(USER_DATA* data, char c);
+uint8_t parseFields(USER_DATA* data, uint8_t maxFields);
 char* getFieldString(USER_DATA* data, uint8_t fieldNumber);
 int32_t getFieldInteger(USER_DATA* data, uint8_t fieldNumber);
-bool isCommand (USER_DATA * data, const char strCommand[], uint8_t minArguments);
+bool getFieldTime(USER_DATA* data, uint8_t fieldNumber, uint16_t* hour, uint16_t* mins);
+int16_t findCommand(const COMMAND table[], uint8_t count, const char* name);
+bool matchArguments(const COMMAND* command, USER_DATA* data);
 int cmpStr(const char* string1, const char* string2);
 
 #endif /* GETINPUT_H_ */
@@ -6,6 +6,7 @@
 #include "eeprom.h"
 #include "uart0.h"
 #include "tm4c123gh6pm.h"
+#include "initModules.h"
 
 //Hibernation Module
 void initHIB()
@@ -23,19 +24,30 @@ void initHIB()
     NVIC_EN1_R = 1 << (INT_HIBERNATE-16-32);    //Enables the Hibernate interrupt and ISR to be triggered
 }
 
-// PWM SETUP FOR M0PWM1
+// PWM SETUP FOR M0PWM1 (AUGER) AND M1PWM4 (PUMP)
 void initPWM()
 {
-    SYSCTL_SRPWM_R = SYSCTL_SRPWM_R0;                // reset PWM0 module
+    SYSCTL_SRPWM_R = SYSCTL_SRPWM_R0 | SYSCTL_SRPWM_R1;  // reset PWM0 and PWM1 modules
     SYSCTL_SRPWM_R = 0;                              // leave reset state
     PWM0_0_CTL_R = 0;                                // turn-off PWM0 generator 1 (drives outs 0, 1)
 
     PWM0_0_GENB_R = PWM_0_GENB_ACTCMPBD_ONE | PWM_0_GENB_ACTLOAD_ZERO;
                                                      // output 5 on PWM1, gen 0b, cmpb
-    PWM0_0_LOAD_R = 1024;                            // set frequency to 40 MHz sys clock / 2 / 1024 = 19.53125 kHz
+    PWM0_0_LOAD_R = PWM_LOAD;                        // set frequency to 40 MHz sys clock / 1025 = 39.02 kHz (no PWM divider, count down)
 
     PWM0_0_CMPB_R = 0;                               //sets the Compare register to 0 therefore no bogus value.
 
     PWM0_0_CTL_R = PWM_0_CTL_ENABLE;                 // turn-on PWM1 generator 0
     PWM0_ENABLE_R = PWM_ENABLE_PWM1EN;               // enable outputs
+
+    PWM0_INTEN_R = PWM_INTEN_INTPWM0;                // generator 0 interrupts reach the NVIC, the load interrupt
+    NVIC_EN0_R = 1 << (INT_PWM0_0-16);               // itself is only on while an auger profile runs
+
+    PWM1_2_CTL_R = 0;                                // turn-off PWM1 generator 2 (drives outs 4, 5)
+    PWM1_2_GENA_R = PWM_2_GENA_ACTCMPAD_ONE | PWM_2_GENA_ACTLOAD_ZERO;
+                                                     // output 4 on PWM1, gen 2a, cmpa
+    PWM1_2_LOAD_R = PWM_LOAD;                        // same 39.02 kHz as the auger
+    PWM1_2_CMPA_R = 0;
+    PWM1_2_CTL_R = PWM_2_CTL_ENABLE;                 // turn-on PWM1 generator 2
+    PWM1_ENABLE_R &= ~PWM_ENABLE_PWM4EN;             // pump output stays low until drivePump turns it on
 }
@@ -2,6 +2,9 @@
 #ifndef INITMODULES_H_
 #define INITMODULES_H_
 
+#define PWM_LOAD 1024                               // Both generators count down from here, 40 MHz / 1025 = 39 kHz
+#define PWM_FULL 1023                               // Compare value for 100 %
+
 void initHIB();
 void initPWM();
 
@@ -0,0 +1,104 @@
+//Single-producer/single-consumer ring that moves work out of the interrupts. An ISR only clears its
+//hardware and posts a small typed item, the main loop takes the items off and does the slow part
+//(EEPROM, scheduler heap, UART). Only the ISR writes the head and only the main loop writes the tail,
+//so neither side has to disable interrupts. The interrupts all run at the default priority and never
+//preempt each other, so together they act as the single producer.
+//Timer 5 runs free at the system clock and is used to time every ISR.
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "isrQueue.h"
+
+#define WORK_QUEUE_MASK (WORK_QUEUE_SIZE - 1)
+
+static volatile WORK_ITEM queue[WORK_QUEUE_SIZE];
+static volatile uint8_t head = 0;                   // Next free slot, written by the ISRs
+static volatile uint8_t tail = 0;                   // Oldest item, written by the main loop
+static uint32_t calls[ISR_COUNT];
+static uint32_t maxCycles[ISR_COUNT];
+static uint32_t posted = 0;
+static uint32_t dropped = 0;
+static uint8_t maxDepth = 0;
+
+void initIsrQueue()
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R5;
+    _delay_cycles(3);
+    TIMER5_CTL_R &= ~TIMER_CTL_TAEN;                            // turn-off timer before reconfiguring
+    TIMER5_CFG_R = TIMER_CFG_32_BIT_TIMER;                      // 32-bit count, wraps every 107 s at 40 MHz
+    TIMER5_TAMR_R = TIMER_TAMR_TAMR_PERIOD | TIMER_TAMR_TACDIR; // periodic, count up, no interrupt
+    TIMER5_TAILR_R = 0xFFFFFFFF;
+    TIMER5_CTL_R |= TIMER_CTL_TAEN;
+}
+
+bool postWork(uint8_t type, uint16_t data)         // Called from interrupts only
+{
+    uint8_t next = (head + 1) & WORK_QUEUE_MASK;
+    uint8_t depth = 0;
+    if(next == tail)
+    {
+        dropped++;
+        return false;
+    }
+    queue[head].type = type;
+    queue[head].data = data;
+    head = next;                                    // Publishes the item, written after the contents
+    posted++;
+
+    depth = (head - tail) & WORK_QUEUE_MASK;
+    if(depth > maxDepth)
+    {
+        maxDepth = depth;
+    }
+    return true;
+}
+
+bool getWork(WORK_ITEM* item)                       // Called from the main loop only
+{
+    if(tail == head)
+    {
+        return false;
+    }
+    item->type = queue[tail].type;
+    item->data = queue[tail].data;
+    tail = (tail + 1) & WORK_QUEUE_MASK;            // Frees the slot after it has been copied
+    return true;
+}
+
+bool workPending()
+{
+    return tail != head;
+}
+
+uint32_t getCycles()                                // System clocks since boot, modulo 2^32
+{
+    return TIMER5_TAV_R;
+}
+
+uint32_t isrEnter()
+{
+    return TIMER5_TAV_R;
+}
+
+void isrExit(uint8_t isr, uint32_t start)
+{
+    uint32_t cycles = TIMER5_TAV_R - start;
+    calls[isr]++;
+    if(cycles > maxCycles[isr])
+    {
+        maxCycles[isr] = cycles;
+    }
+}
+
+void getIsrStats(ISR_STATS* stats)
+{
+    uint8_t i = 0;
+    for(i = 0; i < ISR_COUNT; i++)
+    {
+        stats->calls[i] = calls[i];
+        stats->maxCycles[i] = maxCycles[i];
+    }
+    stats->posted = posted;
+    stats->dropped = dropped;
+    stats->maxDepth = maxDepth;
+}
@@ -0,0 +1,58 @@
+/*
+ * isrQueue.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef ISRQUEUE_H_
+#define ISRQUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WORK_QUEUE_SIZE 16                          // Power of two, one slot is always left empty
+
+// Work posted by the interrupts for the main loop
+#define WORK_ALARM      0                           // RTC alarm 0 matched, a feed is due
+#define WORK_TICK       1                           // A software timer is due
+#define WORK_RX         2                           // UART0 has put characters in the rx ring
+#define WORK_VISIT      3                           // A pet visit has ended
+#define WORK_FEED       4                           // The auger profile has finished
+
+// Interrupts timed by the instrumentation
+#define ISR_TIMER1      0
+#define ISR_COMP0       1
+#define ISR_UART0       2
+#define ISR_TIMER3      3
+#define ISR_HIB         4
+#define ISR_WTIMER4     5
+#define ISR_SYSTICK     6
+#define ISR_PIR         7
+#define ISR_PWM0        8
+#define ISR_COUNT       9
+
+typedef struct _WORK_ITEM
+{
+    uint8_t type;
+    uint16_t data;
+} WORK_ITEM;
+
+typedef struct _ISR_STATS
+{
+    uint32_t calls[ISR_COUNT];
+    uint32_t maxCycles[ISR_COUNT];                  // Longest time spent in each interrupt, system clocks
+    uint32_t posted;
+    uint32_t dropped;                               // Items lost because the queue was full
+    uint8_t maxDepth;                               // Most items waiting at once
+} ISR_STATS;
+
+void initIsrQueue();
+bool postWork(uint8_t type, uint16_t data);
+bool getWork(WORK_ITEM* item);
+bool workPending();
+uint32_t getCycles();
+uint32_t isrEnter();
+void isrExit(uint8_t isr, uint32_t start);
+void getIsrStats(ISR_STATS* stats);
+
+#endif /* ISRQUEUE_H_ */
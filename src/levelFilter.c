@@ -0,0 +1,125 @@
+//Burst filter for the capacitive water level sensor. Every sampling cycle takes a burst of back-to-back
+//measurements, the median of the burst throws out single spikes and an exponential moving average of
+//the medians smooths what is left. A moving average of the squared deviation gives the noise level.
+//Everything is integer: the average is kept in Q8 ticks and the variance in Q4 ticks^2.
+#include <stdint.h>
+#include <stdbool.h>
+#include "levelFilter.h"
+#include "fixedPoint.h"
+
+#define MAX_DEVIATION 0xFFF                         // Keeps the Q4 square inside 32 bits
+
+static uint8_t burst = DEFAULT_BURST;
+static uint8_t shift = DEFAULT_EMA_SHIFT;
+static uint32_t samples[MAX_BURST];
+static uint8_t count = 0;
+static bool seeded = false;
+static uint32_t average = 0;                        // Q8
+static uint32_t variance = 0;                       // Q4
+static uint32_t bursts = 0;
+static uint32_t sampleCount = 0;
+static uint32_t first = 0;                          // First measurement of the last complete burst
+static uint32_t nextFirst = 0;
+
+bool validFilterSetting(uint32_t setting)
+{
+    uint8_t newBurst = setting & FILTER_BURST_M;
+    return (newBurst >= 1) && (newBurst <= MAX_BURST) && ((setting >> FILTER_SHIFT_S) <= MAX_EMA_SHIFT);
+}
+
+void initLevelFilter(uint32_t setting)              // setting is the stored word, erased means defaults
+{
+    uint8_t newBurst = setting & FILTER_BURST_M;
+    uint8_t newShift = (setting >> FILTER_SHIFT_S) & FILTER_BURST_M;
+    if(!validFilterSetting(setting))
+    {
+        newBurst = DEFAULT_BURST;
+        newShift = DEFAULT_EMA_SHIFT;
+    }
+    burst = newBurst;
+    shift = newShift;
+    count = 0;
+    seeded = false;                                 // The average starts over at the next median
+}
+
+uint32_t getFilterSetting(uint8_t newBurst, uint8_t newShift)
+{
+    return newBurst | ((uint32_t)newShift << FILTER_SHIFT_S);
+}
+
+bool addSample(uint32_t ticks)                      // Returns true when the burst is complete and the outputs are new
+{
+    uint8_t i = 0;
+    uint32_t median = 0;
+    int32_t deviation = 0;
+
+    if(count >= burst)                              // Burst size was lowered mid-burst
+    {
+        count = 0;
+    }
+    if(count == 0)
+    {
+        nextFirst = ticks;
+    }
+    i = count++;                                    // Insertion sort as the samples arrive
+    while((i > 0) && (samples[i - 1] > ticks))
+    {
+        samples[i] = samples[i - 1];
+        i--;
+    }
+    samples[i] = ticks;
+    sampleCount++;
+    if(count < burst)
+    {
+        return false;
+    }
+
+    median = samples[burst / 2];
+    first = nextFirst;
+    count = 0;
+    bursts++;
+    if(!seeded)
+    {
+        average = Q8_FROM_INT(median);
+        variance = 0;
+        seeded = true;
+        return true;
+    }
+    deviation = (int32_t)median - (int32_t)Q8_TRUNC(average);
+    if(deviation < 0)
+    {
+        deviation = -deviation;
+    }
+    if(deviation > MAX_DEVIATION)
+    {
+        deviation = MAX_DEVIATION;
+    }
+    average += ((int32_t)Q8_FROM_INT(median) - (int32_t)average) >> shift;
+    variance += ((int32_t)(((uint32_t)deviation * deviation) << 4) - (int32_t)variance) >> shift;
+    return true;
+}
+
+uint32_t getFirstSample()                           // What the old single measurement would have read
+{
+    return first;
+}
+
+uint32_t getFilteredTicks()
+{
+    return Q8_TO_INT(average);
+}
+
+uint32_t getVariance()
+{
+    return (variance + 0x8) >> 4;
+}
+
+void getFilterStats(FILTER_STATS* stats)
+{
+    stats->burst = burst;
+    stats->shift = shift;
+    stats->bursts = bursts;
+    stats->samples = sampleCount;
+    stats->filteredTicks = getFilteredTicks();
+    stats->variance = getVariance();
+}
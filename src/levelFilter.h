@@ -0,0 +1,39 @@
+/*
+ * levelFilter.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LEVELFILTER_H_
+#define LEVELFILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAX_BURST 9                                 // Most measurements per sampling cycle
+#define DEFAULT_BURST 5
+#define DEFAULT_EMA_SHIFT 2                         // New median weighs 1/4
+#define MAX_EMA_SHIFT 6
+#define FILTER_BURST_M 0xFF                         // Setting word: burst size in the low byte
+#define FILTER_SHIFT_S 8                            // and EMA shift in the next
+
+typedef struct _FILTER_STATS
+{
+    uint8_t burst;
+    uint8_t shift;
+    uint32_t bursts;                                // Sampling cycles completed
+    uint32_t samples;                               // Measurements taken
+    uint32_t filteredTicks;                         // EMA of the burst medians
+    uint32_t variance;                              // EMA of the squared deviation from it, ticks^2
+} FILTER_STATS;
+
+bool validFilterSetting(uint32_t setting);
+void initLevelFilter(uint32_t setting);
+uint32_t getFilterSetting(uint8_t burst, uint8_t shift);
+bool addSample(uint32_t ticks);
+uint32_t getFirstSample();
+uint32_t getFilteredTicks();
+uint32_t getVariance();
+void getFilterStats(FILTER_STATS* stats);
+
+#endif /* LEVELFILTER_H_ */
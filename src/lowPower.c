@@ -0,0 +1,145 @@
+//Hibernation between feeds, water samples and PIR edges. The core is powered off with only the RTC
+//running, the RTC alarm or the WAKE pin powers it back up and the firmware boots again. The counters
+//that have to live through hibernation are kept in the battery-backed HIB data registers.
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "lowPower.h"
+
+// HIB battery-backed data registers
+#define HIB_DATA(i) ((&HIB_DATA_R)[i])          // 16 words from HIB_DATA_R
+#define DATA_MAGIC          0
+#define DATA_HIBERNATIONS   1
+#define DATA_AWAKE          2                       // Seconds awake before the last hibernation
+#define DATA_ASLEEP         3
+#define DATA_SLEEP_START    4                       // RTC second hibernation started
+#define DATA_WAKE_AT        5                       // RTC second the alarm was set for
+#define DATA_LAST_LATENCY   6
+#define DATA_MAX_LATENCY    7
+#define DATA_SUM_LATENCY    8
+#define DATA_RTC_WAKES      9
+#define POWER_MAGIC 0x50455446                      // "PETF", anything else means the battery was lost
+
+static uint8_t wakeReason = WAKE_POWER_ON;
+static uint32_t awakeStart = 0;                     // RTC second this boot started counting awake time
+static uint32_t awakeUntil = 0;
+
+static void writeData(uint8_t word, uint32_t data)
+{
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    HIB_DATA(word) = data;
+}
+
+static uint32_t readRtc()
+{
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    return HIB_RTCC_R;
+}
+
+void initLowPower()                                 // Works out why the core is running, call straight after initHIB
+{
+    uint32_t seconds = 0;
+    uint32_t subSeconds = 0;
+    uint32_t wakeAt = 0;
+    uint32_t latency = 0;
+
+    do                                              // Seconds and sub-seconds read as one value
+    {
+        seconds = HIB_RTCC_R;
+        subSeconds = HIB_RTCSS_R & HIB_RTCSS_RTCSSC_M;
+    } while(seconds != HIB_RTCC_R);
+
+    if((HIB_DATA(DATA_MAGIC) == POWER_MAGIC) && (HIB_RIS_R & (HIB_RIS_RTCALT0 | HIB_RIS_EXTW)))
+    {
+        wakeReason = (HIB_RIS_R & HIB_RIS_EXTW) ? WAKE_PIN : WAKE_RTC;
+        writeData(DATA_ASLEEP, HIB_DATA(DATA_ASLEEP) + (seconds - HIB_DATA(DATA_SLEEP_START)));
+        if(wakeReason == WAKE_RTC)
+        {
+            wakeAt = HIB_DATA(DATA_WAKE_AT);
+            latency = ((uint64_t)(((seconds - wakeAt) * 32768) + subSeconds) * 15625) / 512;  // 1/32768 s to us
+            writeData(DATA_RTC_WAKES, HIB_DATA(DATA_RTC_WAKES) + 1);
+            writeData(DATA_LAST_LATENCY, latency);
+            writeData(DATA_SUM_LATENCY, HIB_DATA(DATA_SUM_LATENCY) + latency);
+            if(latency > HIB_DATA(DATA_MAX_LATENCY))
+            {
+                writeData(DATA_MAX_LATENCY, latency);
+            }
+        }
+        while(!(HIB_CTL_R & HIB_CTL_WRC));
+        HIB_IC_R |= HIB_RIS_EXTW;                   // The RTC alarm flag is left for alarmISR
+        awakeUntil = seconds + ((wakeReason == WAKE_RTC) ? WAKE_AWAKE_S : CONSOLE_AWAKE_S);
+    }
+    else
+    {
+        uint8_t i = 0;
+        wakeReason = WAKE_POWER_ON;
+        for(i = DATA_HIBERNATIONS; i <= DATA_RTC_WAKES; i++)
+        {
+            writeData(i, 0);
+        }
+        writeData(DATA_MAGIC, POWER_MAGIC);
+        awakeUntil = seconds + CONSOLE_AWAKE_S;
+    }
+    awakeStart = seconds;
+}
+
+uint8_t getWakeReason()
+{
+    return wakeReason;
+}
+
+void keepAwake(uint32_t seconds)                    // Holds off hibernation, e.g. while someone is typing
+{
+    uint32_t until = readRtc() + seconds;
+    if((int32_t)(until - awakeUntil) > 0)
+    {
+        awakeUntil = until;
+    }
+}
+
+bool awakeTimeOver()
+{
+    return (int32_t)(readRtc() - awakeUntil) >= 0;
+}
+
+void restartAwakeClock(uint32_t before)             // Call after the RTC is loaded, before is the RTC value it replaced
+{
+    writeData(DATA_AWAKE, HIB_DATA(DATA_AWAKE) + (before - awakeStart));
+    awakeStart = readRtc();
+    awakeUntil = awakeStart + CONSOLE_AWAKE_S;
+}
+
+void hibernate(uint32_t wake)                       // Powers the core off until the RTC reaches wake or the WAKE pin goes low
+{
+    uint32_t now = readRtc();
+    if(wake - now > MAX_HIBERNATE_S)                // Also caps 0xFFFFFFFF, nothing scheduled
+    {
+        wake = now + MAX_HIBERNATE_S;
+    }
+    writeData(DATA_HIBERNATIONS, HIB_DATA(DATA_HIBERNATIONS) + 1);
+    writeData(DATA_AWAKE, HIB_DATA(DATA_AWAKE) + (now - awakeStart));
+    writeData(DATA_SLEEP_START, now);
+    writeData(DATA_WAKE_AT, wake);
+
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    HIB_RTCM0_R = wake;
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    HIB_IC_R |= HIB_RIS_RTCALT0 | HIB_RIS_EXTW;
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    HIB_CTL_R |= HIB_CTL_RTCWEN | HIB_CTL_PINWEN;   // PIR or a button on WAKE
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    HIB_CTL_R |= HIB_CTL_HIBREQ;
+    while(true);                                    // Power is removed from the core here
+}
+
+void getPowerStats(POWER_STATS* stats)
+{
+    stats->lastWake = wakeReason;
+    stats->hibernations = HIB_DATA(DATA_HIBERNATIONS);
+    stats->rtcWakes = HIB_DATA(DATA_RTC_WAKES);
+    stats->awakeSeconds = HIB_DATA(DATA_AWAKE) + (readRtc() - awakeStart);
+    stats->asleepSeconds = HIB_DATA(DATA_ASLEEP);
+    stats->lastLatencyUs = HIB_DATA(DATA_LAST_LATENCY);
+    stats->maxLatencyUs = HIB_DATA(DATA_MAX_LATENCY);
+    stats->sumLatencyUs = HIB_DATA(DATA_SUM_LATENCY);
+}
@@ -0,0 +1,48 @@
+/*
+ * lowPower.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LOWPOWER_H_
+#define LOWPOWER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MIN_HIBERNATE_S 5                           // Shorter gaps are not worth a reboot, WFI is used instead
+#define MAX_HIBERNATE_S 3600                        // The console comes back at least once an hour
+#define WAKE_AWAKE_S 3                              // Time kept awake after an RTC wake-up
+#define CONSOLE_AWAKE_S 60                          // Time kept awake after power-up, a WAKE pin edge or a command
+
+// Typical supply currents used for the energy estimate, motor and pump excluded
+#define RUN_UA 25000                                // 40 MHz run mode
+#define SLEEP_UA 13000                              // WFI sleep mode at 40 MHz
+#define HIBERNATE_UA 2                              // Hibernate with the RTC running
+
+// Reasons for the last wake-up
+#define WAKE_POWER_ON 0
+#define WAKE_RTC 1
+#define WAKE_PIN 2
+
+typedef struct _POWER_STATS
+{
+    uint8_t lastWake;
+    uint32_t hibernations;
+    uint32_t rtcWakes;                              // Wake-ups the latency was measured on
+    uint32_t awakeSeconds;                          // Totals since the first power-up
+    uint32_t asleepSeconds;
+    uint32_t lastLatencyUs;                         // Alarm match to main(), measured with the RTC sub-seconds
+    uint32_t maxLatencyUs;
+    uint32_t sumLatencyUs;
+} POWER_STATS;
+
+void initLowPower();
+uint8_t getWakeReason();
+void keepAwake(uint32_t seconds);
+bool awakeTimeOver();
+void restartAwakeClock(uint32_t before);
+void hibernate(uint32_t wake);
+void getPowerStats(POWER_STATS* stats);
+
+#endif /* LOWPOWER_H_ */
@@ -0,0 +1,161 @@
+//PIR debounce for the edge interrupt on PA2. A rising edge only counts as a visit once the output has
+//stayed high for the presence time, shorter pulses are glitches. After the output drops the visit is
+//held for the hold-off time so a pet that keeps still for a moment is not counted twice. Both waits
+//run on one one-shot timer, the functions return how long to arm it for (0 stops it).
+//Times are Timer 5 cycles from getCycles(), called from the interrupts only.
+#include <stdint.h>
+#include <stdbool.h>
+#include "motion.h"
+#include "fixedPoint.h"
+
+static uint8_t state = MOTION_IDLE;
+static uint16_t presenceMs = DEFAULT_PRESENCE_MS;
+static uint16_t holdoffMs = DEFAULT_HOLDOFF_MS;
+static uint32_t visitEdge = 0;                      // Rising edge that started the visit
+static bool confirmed = false;                      // Visit confirmed since the last motionDemand
+static bool timing = false;                         // Visit has not started the pump yet
+static uint8_t change = VISIT_SAME;                 // Visit started or ended by the last call
+static uint32_t edges = 0;
+static uint32_t visits = 0;
+static uint32_t glitches = 0;
+static uint32_t retriggers = 0;
+static uint32_t pumpStarts = 0;
+static uint32_t lastLatencyUs = 0;
+static uint32_t maxLatencyUs = 0;
+static uint32_t sumLatencyUs = 0;
+
+void initMotion(uint32_t setting)                   // setting is the stored word, erased means defaults
+{
+    if(setting == 0xFFFFFFFF)
+    {
+        presenceMs = DEFAULT_PRESENCE_MS;
+        holdoffMs = DEFAULT_HOLDOFF_MS;
+    }
+    else
+    {
+        presenceMs = setting & MOTION_PRESENCE_M;
+        holdoffMs = setting >> MOTION_HOLDOFF_S;
+    }
+}
+
+uint32_t getMotionSetting(uint16_t newPresence, uint16_t newHoldoff)
+{
+    return newPresence | ((uint32_t)newHoldoff << MOTION_HOLDOFF_S);
+}
+
+static uint16_t confirm()
+{
+    state = MOTION_PRESENT;
+    change = VISIT_STARTED;
+    confirmed = true;
+    timing = true;
+    visits++;
+    return 0;
+}
+
+uint16_t motionEdge(bool high, uint32_t cycles)     // PA2 changed, high is the new level
+{
+    edges++;
+    if(high)
+    {
+        if(state == MOTION_IDLE)
+        {
+            state = MOTION_PENDING;
+            visitEdge = cycles;
+            return (presenceMs == 0) ? confirm() : presenceMs;
+        }
+        if(state == MOTION_HOLDOFF)                 // Back before the hold-off ran out
+        {
+            state = MOTION_PRESENT;
+            retriggers++;
+        }
+        return 0;
+    }
+    if(state == MOTION_PENDING)
+    {
+        state = MOTION_IDLE;
+        glitches++;
+        return 0;
+    }
+    if(state == MOTION_PRESENT)
+    {
+        state = MOTION_HOLDOFF;
+        if(holdoffMs == 0)
+        {
+            state = MOTION_IDLE;
+            change = VISIT_ENDED;
+            timing = false;
+        }
+        return holdoffMs;
+    }
+    return 0;
+}
+
+uint16_t motionTimeout(bool high)                   // The timer armed by motionEdge ran out
+{
+    if(state == MOTION_PENDING)
+    {
+        if(high)
+        {
+            return confirm();
+        }
+        state = MOTION_IDLE;                        // Missed the falling edge
+        glitches++;
+    }
+    else if(state == MOTION_HOLDOFF)
+    {
+        state = high ? MOTION_PRESENT : MOTION_IDLE;
+        change = high ? VISIT_SAME : VISIT_ENDED;
+        timing = high && timing;                    // Visit over, a later pump start is not its latency
+    }
+    return 0;
+}
+
+uint8_t motionChange()                              // Whether the last edge or timeout started or ended a visit
+{
+    uint8_t last = change;
+    change = VISIT_SAME;
+    return last;
+}
+
+bool motionDemand()                                 // A pet is there or has been since the last call
+{
+    bool demand = confirmed || (state == MOTION_PRESENT) || (state == MOTION_HOLDOFF);
+    confirmed = false;
+    return demand;
+}
+
+bool motionIdle()
+{
+    return state == MOTION_IDLE;
+}
+
+void motionPumpStarted(uint32_t cycles)             // The pump started on a visit
+{
+    if(timing)
+    {
+        timing = false;
+        pumpStarts++;
+        lastLatencyUs = CYCLES_TO_US(cycles - visitEdge);
+        if(lastLatencyUs > maxLatencyUs)
+        {
+            maxLatencyUs = lastLatencyUs;
+        }
+        sumLatencyUs += lastLatencyUs;
+    }
+}
+
+void getMotionStats(MOTION_STATS* stats)
+{
+    stats->state = state;
+    stats->presenceMs = presenceMs;
+    stats->holdoffMs = holdoffMs;
+    stats->edges = edges;
+    stats->visits = visits;
+    stats->glitches = glitches;
+    stats->retriggers = retriggers;
+    stats->pumpStarts = pumpStarts;
+    stats->lastLatencyUs = lastLatencyUs;
+    stats->maxLatencyUs = maxLatencyUs;
+    stats->sumLatencyUs = sumLatencyUs;
+}
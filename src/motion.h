@@ -0,0 +1,54 @@
+/*
+ * motion.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef MOTION_H_
+#define MOTION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEFAULT_PRESENCE_MS 100                     // PIR must stay high this long to count
+#define DEFAULT_HOLDOFF_MS 2000                     // Gaps shorter than this are the same visit
+#define MOTION_PRESENCE_M 0xFFFF                    // Setting word: presence in bits 0-15, hold-off in 16-31
+#define MOTION_HOLDOFF_S 16
+
+// Debounce states
+#define MOTION_IDLE 0
+#define MOTION_PENDING 1                            // High, waiting out the minimum presence time
+#define MOTION_PRESENT 2                            // Confirmed visit, PIR high
+#define MOTION_HOLDOFF 3                            // PIR went low, visit ends unless it comes back
+
+// Returned by motionChange
+#define VISIT_SAME 0
+#define VISIT_STARTED 1
+#define VISIT_ENDED 2
+
+typedef struct _MOTION_STATS
+{
+    uint8_t state;
+    uint16_t presenceMs;
+    uint16_t holdoffMs;
+    uint32_t edges;
+    uint32_t visits;                                // Confirmed visits
+    uint32_t glitches;                              // Pulses shorter than the presence time
+    uint32_t retriggers;                            // Visits extended during the hold-off
+    uint32_t pumpStarts;                            // Pump runs started by a visit
+    uint32_t lastLatencyUs;                         // Rising edge to pump start
+    uint32_t maxLatencyUs;
+    uint32_t sumLatencyUs;
+} MOTION_STATS;
+
+void initMotion(uint32_t setting);
+uint32_t getMotionSetting(uint16_t presenceMs, uint16_t holdoffMs);
+uint16_t motionEdge(bool high, uint32_t cycles);
+uint16_t motionTimeout(bool high);
+uint8_t motionChange();
+bool motionDemand();
+bool motionIdle();
+void motionPumpStarted(uint32_t cycles);
+void getMotionStats(MOTION_STATS* stats);
+
+#endif /* MOTION_H_ */
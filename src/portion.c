@@ -0,0 +1,131 @@
+//Grams to auger run time. Each calibration point is the feed rate in mg/s measured at one motor speed,
+//rates between points are interpolated and outside them scaled in proportion to the speed. The rate is
+//that of the hold part of the drive profile: the smoothstep ramps up and down together deliver about
+//what one ramp length at full speed would, so the ramp length is taken off a test run and added back
+//onto a portion.
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+#include "portion.h"
+
+static uint8_t speeds[PORTION_POINTS];
+static uint32_t rates[PORTION_POINTS];
+static uint8_t count = 0;
+
+void initPortion()                                  // Stored points up to the first erased word
+{
+    uint32_t points[PORTION_POINTS];
+    count = 0;
+    readEepromCacheBlock(PORTION_BASE, points, PORTION_POINTS);
+    while((count < PORTION_POINTS) && (points[count] != 0xFFFFFFFF))
+    {
+        speeds[count] = points[count] & PORTION_SPEED_M;
+        rates[count] = points[count] >> PORTION_RATE_S;
+        count++;
+    }
+}
+
+uint32_t getPortionRate(uint8_t speed)              // mg/s at the speed, 0 when the auger is not calibrated
+{
+    uint8_t i = 1;
+    if((count == 0) || (speed == 0))
+    {
+        return 0;
+    }
+    if(speed <= speeds[0])
+    {
+        return (uint32_t)(((uint64_t)rates[0] * speed) / speeds[0]);
+    }
+    if(speed >= speeds[count - 1])
+    {
+        return (uint32_t)(((uint64_t)rates[count - 1] * speed) / speeds[count - 1]);
+    }
+    while(speeds[i] < speed)                        // speeds[i - 1] < speed <= speeds[i]
+    {
+        i++;
+    }
+    return rates[i - 1] + (int32_t)(((int64_t)((int32_t)rates[i] - (int32_t)rates[i - 1]) * (speed - speeds[i - 1]))
+                                    / (speeds[i] - speeds[i - 1]));
+}
+
+uint32_t portionToMs(uint16_t grams, uint8_t speed, uint32_t rampMs)  // 0 when the rate is not known
+{
+    uint32_t rate = getPortionRate(speed);
+    if(rate == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)((((uint64_t)grams * 1000000) + (rate / 2)) / rate) + rampMs;
+}
+
+uint32_t rateFromTest(uint16_t grams, uint32_t testMs, uint32_t rampMs)  // mg/s of a test run that dispensed grams
+{
+    if(testMs <= rampMs)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)grams * 1000000) / (testMs - rampMs));
+}
+
+static bool writePoints()
+{
+    uint32_t words[PORTION_POINTS];
+    uint8_t i = 0;
+    for(i = 0; i < PORTION_POINTS; i++)
+    {
+        words[i] = (i < count) ? (speeds[i] | (rates[i] << PORTION_RATE_S)) : 0xFFFFFFFF;
+    }
+    bool ok = writeEepromCacheBlock(PORTION_BASE, words, PORTION_POINTS);
+    initPortion();                                  // Loads what was stored, even if only part of it fitted
+    return ok;
+}
+
+bool setPortionPoint(uint8_t speed, uint32_t mgPerS)  // Adds a point, or replaces the one at that speed
+{
+    uint8_t i = 0;
+    uint8_t j = 0;
+    if((speed == 0) || (mgPerS == 0) || (mgPerS > PORTION_RATE_M))
+    {
+        return false;
+    }
+    for(i = 0; i < count; i++)
+    {
+        if(speeds[i] == speed)
+        {
+            rates[i] = mgPerS;
+            return writePoints();
+        }
+    }
+    if(count == PORTION_POINTS)
+    {
+        return false;
+    }
+    i = count;
+    for(j = count; (j > 0) && (speeds[j - 1] > speed); j--)  // Insertion keeps the table sorted
+    {
+        speeds[j] = speeds[j - 1];
+        rates[j] = rates[j - 1];
+        i = j - 1;
+    }
+    speeds[i] = speed;
+    rates[i] = mgPerS;
+    count++;
+    return writePoints();
+}
+
+bool resetPortion()
+{
+    count = 0;
+    return writePoints();
+}
+
+uint8_t getPortionCount()
+{
+    return count;
+}
+
+void getPortionPoint(uint8_t point, uint8_t* speed, uint32_t* mgPerS)
+{
+    *speed = speeds[point];
+    *mgPerS = rates[point];
+}
@@ -0,0 +1,31 @@
+/*
+ * portion.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef PORTION_H_
+#define PORTION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+
+// Auger calibration points in cache block 4 after the auger setting, one word each, sorted by speed
+#define PORTION_BASE ((BLOCK_WORDS*4)+1)
+#define PORTION_POINTS 8
+#define PORTION_SPEED_M 0xFF                        // Motor speed in percent in the low byte
+#define PORTION_RATE_S 8                            // Milligrams per second of the hold in bits 8-31
+#define PORTION_RATE_M 0xFFFFFF
+#define AUGER_TEST_S 10                             // Length of a "calibrate auger test" run
+
+void initPortion();
+uint32_t getPortionRate(uint8_t speed);
+uint32_t portionToMs(uint16_t grams, uint8_t speed, uint32_t rampMs);
+uint32_t rateFromTest(uint16_t grams, uint32_t testMs, uint32_t rampMs);
+bool setPortionPoint(uint8_t speed, uint32_t mgPerS);
+bool resetPortion();
+uint8_t getPortionCount();
+void getPortionPoint(uint8_t point, uint8_t* speed, uint32_t* mgPerS);
+
+#endif /* PORTION_H_ */
@@ -0,0 +1,145 @@
+//Binary framing for machine control over UART0. Frames are COBS encoded so a 0 byte always marks the end
+//of one and a receiver that starts mid-frame or sees line noise resynchronises at the next 0. A CRC-16
+//(CCITT, 0x1021, initial 0xFFFF) over type, id and payload rejects corrupted frames. The frame is
+//assembled a byte at a time from the UART receive ring like a text line, and decoded in place.
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart0.h"
+#include "protocol.h"
+
+static const uint16_t crcNibbles[16] =              // CRC of each 4-bit value, half the loop of a bitwise CRC
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static uint32_t frames = 0;
+static uint32_t badFrames = 0;
+static uint32_t responses = 0;
+
+uint16_t crc16(uint16_t crc, const uint8_t* data, uint8_t length)    // Start with CRC_START, or chain the previous result
+{
+    uint8_t i = 0;
+    for(i = 0; i < length; i++)
+    {
+        crc = (crc << 4) ^ crcNibbles[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ crcNibbles[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+bool addFrameByte(FRAME* frame, uint8_t c)          // Returns true when a 0 byte has ended a frame
+{
+    if(c == 0)
+    {
+        return true;
+    }
+    if(frame->count < sizeof(frame->buffer))
+    {
+        frame->buffer[frame->count++] = c;
+    }
+    else
+    {
+        frame->overflow = true;
+    }
+    return false;
+}
+
+uint8_t decodeFrame(FRAME* frame)                   // Returns the bytes before the CRC, 0 for a bad frame, and resets for the next one
+{
+    uint8_t in = 0;
+    uint8_t out = 0;
+    uint8_t length = 0;
+    bool ok = !frame->overflow && (frame->count != 0);
+
+    while(ok && (in < frame->count))                // Decoding in place, the output never passes the input
+    {
+        uint8_t code = frame->buffer[in++];
+        uint8_t i = 0;
+        if(in + code - 1 > frame->count)
+        {
+            ok = false;
+            break;
+        }
+        for(i = 1; i < code; i++)
+        {
+            frame->buffer[out++] = frame->buffer[in++];
+        }
+        if((code != 0xFF) && (in < frame->count))   // A full block of 254 has no implied 0 after it
+        {
+            frame->buffer[out++] = 0;
+        }
+    }
+    if(ok && (out >= 4) && (crc16(CRC_START, frame->buffer, out - 2) == (frame->buffer[out - 2] | (frame->buffer[out - 1] << 8))))
+    {
+        length = out - 2;
+        frames++;
+    }
+    else if(frame->count != 0)                      // Back-to-back 0 bytes are only padding
+    {
+        badFrames++;
+    }
+    frame->count = 0;
+    frame->overflow = false;
+    return length;
+}
+
+void sendFrame(uint8_t type, uint8_t id, uint8_t status, const uint8_t* payload, uint8_t length)
+{
+    uint8_t data[FRAME_MAX];
+    uint8_t i = 0;
+    uint8_t start = 0;                              // Start of the run the next code byte describes
+    uint16_t crc = 0;
+
+    if(length > PAYLOAD_MAX - 1)
+    {
+        length = PAYLOAD_MAX - 1;
+    }
+    data[0] = type;
+    data[1] = id;
+    data[2] = status;
+    for(i = 0; i < length; i++)
+    {
+        data[3 + i] = payload[i];
+    }
+    length += 3;
+    crc = crc16(CRC_START, data, length);
+    data[length++] = crc & 0xFF;
+    data[length++] = crc >> 8;
+
+    for(i = 0; i <= length; i++)                    // Frames are shorter than 254, every run ends at a 0 or the end
+    {
+        if((i == length) || (data[i] == 0))
+        {
+            uint8_t j = 0;
+            putcUart0(i - start + 1);
+            for(j = start; j < i; j++)
+            {
+                putcUart0(data[j]);
+            }
+            start = i + 1;
+        }
+    }
+    putcUart0(0);
+    responses++;
+}
+
+void putWord(uint8_t* data, uint32_t value)         // Little endian
+{
+    data[0] = value;
+    data[1] = value >> 8;
+    data[2] = value >> 16;
+    data[3] = value >> 24;
+}
+
+uint32_t getWord(const uint8_t* data)
+{
+    return data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+void getProtocolStats(PROTOCOL_STATS* stats)
+{
+    stats->frames = frames;
+    stats->badFrames = badFrames;
+    stats->responses = responses;
+}
@@ -0,0 +1,64 @@
+/*
+ * protocol.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// A frame is type, request id, payload and a CRC-16 (low byte first), COBS encoded and ended by a 0 byte.
+// Multi-byte fields are little endian. A response has the request type with bit 7 set, the same id and a status byte.
+#define FRAME_MAX 40                                // Decoded bytes, CRC included
+#define PAYLOAD_MAX (FRAME_MAX - 4)
+#define FRAME_RESPONSE 0x80
+#define CRC_START 0xFFFF
+
+// Requests
+#define MSG_GET_TIME      0x01                      // -> RTC seconds (4), weekday (1)
+#define MSG_SET_TIME      0x02                      // minutes after midnight (2)
+#define MSG_GET_EVENT     0x03                      // event (1) -> time word (4), action word (4), 0xFFFFFFFF when free
+#define MSG_SET_EVENT     0x04                      // event (1), time word (4), action word (4)
+#define MSG_DELETE_EVENT  0x05                      // event (1)
+#define MSG_LIST_EVENTS   0x06                      // after (2), 0xFFFF for the first -> count (2), events next to fire first (1 each),
+                                                    // STATUS_VALUE when after is not scheduled
+#define MSG_GET_SETTING   0x07                      // setting word (2) -> value (4)
+#define MSG_SET_SETTING   0x08                      // setting word (2), value (4)
+#define MSG_TELEMETRY     0x09                      // -> see sendTelemetry
+#define MSG_TEXT_MODE     0x7F                      // Back to the text console
+
+// Response status
+#define STATUS_OK         0
+#define STATUS_UNKNOWN    1                         // Request type not known
+#define STATUS_LENGTH     2                         // Payload too short or too long for the type
+#define STATUS_VALUE      3                         // A field is out of range
+#define STATUS_FULL       4                         // The EEPROM log has no room
+
+#define LIST_PAGE 16                                // Events per MSG_LIST_EVENTS response
+
+typedef struct _FRAME
+{
+    uint8_t buffer[FRAME_MAX + 1];                  // COBS adds one byte per 254
+    uint8_t count;
+    bool overflow;                                  // Too long, dropped when its 0 byte arrives
+} FRAME;
+
+typedef struct _PROTOCOL_STATS
+{
+    uint32_t frames;                                // Frames that passed the CRC
+    uint32_t badFrames;                             // CRC, COBS or length errors
+    uint32_t responses;
+} PROTOCOL_STATS;
+
+uint16_t crc16(uint16_t crc, const uint8_t* data, uint8_t length);
+bool addFrameByte(FRAME* frame, uint8_t c);
+uint8_t decodeFrame(FRAME* frame);
+void sendFrame(uint8_t type, uint8_t id, uint8_t status, const uint8_t* payload, uint8_t length);
+void putWord(uint8_t* data, uint32_t value);
+uint32_t getWord(const uint8_t* data);
+void getProtocolStats(PROTOCOL_STATS* stats);
+
+#endif /* PROTOCOL_H_ */
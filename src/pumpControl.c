@@ -0,0 +1,161 @@
+//Water pump controller driven by the filtered bowl level. The pump starts once the level has dropped
+//a band below the target and runs until the target is reached, so a level hovering at the target does
+//not toggle it. Every run is followed by a minimum off-time, and Timer 3 cuts off a run that takes
+//longer than the maximum in case the level never gets there (empty tank, blocked hose, bad sensor).
+//While it runs, the speed falls off linearly over the last few ml so small bowls are not overshot.
+//Called from the interrupts only, all times are RTC seconds.
+#include <stdint.h>
+#include <stdbool.h>
+#include "pumpControl.h"
+#include "initModules.h"
+#include "fixedPoint.h"
+
+static uint8_t state = PUMP_IDLE;
+static uint8_t bandMl = DEFAULT_BAND_ML;
+static uint16_t maxRunS = DEFAULT_MAX_RUN_S;
+static uint16_t minOffS = DEFAULT_MIN_OFF_S;
+static uint32_t startTime = 0;
+static uint32_t stopTime = 0;
+static uint32_t starts = 0;
+static uint32_t cutoffs = 0;
+static uint32_t lastRunS = 0;
+static uint32_t longestRunS = 0;
+static uint8_t minSpeed = DEFAULT_MIN_SPEED;
+static uint16_t taperMl = DEFAULT_TAPER_ML;
+static uint16_t lastDuty = 0;
+
+bool validPumpSetting(uint32_t setting)
+{
+    uint16_t newRun = (setting >> PUMP_RUN_S) & PUMP_TIME_M;
+    return (newRun != 0) && (newRun <= MAX_RUN_LIMIT_S);
+}
+
+void initPumpControl(uint32_t setting)              // setting is the stored word, erased means defaults
+{
+    uint8_t newBand = setting & PUMP_BAND_M;
+    uint16_t newRun = (setting >> PUMP_RUN_S) & PUMP_TIME_M;
+    uint16_t newOff = (setting >> PUMP_OFF_S) & PUMP_TIME_M;
+    if(!validPumpSetting(setting))
+    {
+        newBand = DEFAULT_BAND_ML;
+        newRun = DEFAULT_MAX_RUN_S;
+        newOff = DEFAULT_MIN_OFF_S;
+    }
+    bandMl = newBand;
+    maxRunS = newRun;
+    minOffS = newOff;
+}
+
+uint32_t getPumpSetting(uint8_t newBand, uint16_t newRun, uint16_t newOff)
+{
+    return newBand | ((uint32_t)(newRun & PUMP_TIME_M) << PUMP_RUN_S) | ((uint32_t)(newOff & PUMP_TIME_M) << PUMP_OFF_S);
+}
+
+static void stop(uint32_t now)
+{
+    state = PUMP_RESTING;
+    stopTime = now;
+    lastRunS = now - startTime;
+    if(lastRunS > longestRunS)
+    {
+        longestRunS = lastRunS;
+    }
+}
+
+bool updatePump(uint16_t level, uint16_t target, bool demand, uint32_t now)  // Returns whether the pump should run
+{
+    if(state == PUMP_FILLING)
+    {
+        if((level >= target) || (target == 0))      // A target of 0 turns water off
+        {
+            stop(now);
+        }
+    }
+    else
+    {
+        if((state == PUMP_RESTING) && (now - stopTime >= minOffS))
+        {
+            state = PUMP_IDLE;
+        }
+        if((state == PUMP_IDLE) && demand && (level + bandMl < target))
+        {
+            state = PUMP_FILLING;
+            startTime = now;
+            starts++;
+        }
+    }
+    return state == PUMP_FILLING;
+}
+
+bool validPumpSpeedSetting(uint32_t setting)
+{
+    uint8_t newMin = setting & SPEED_MIN_M;
+    return (newMin >= 1) && (newMin <= 100) && ((setting >> SPEED_TAPER_S) <= SPEED_TAPER_M);
+}
+
+void initPumpSpeed(uint32_t setting)                // setting is the stored word, erased means defaults
+{
+    uint8_t newMin = setting & SPEED_MIN_M;
+    if(!validPumpSpeedSetting(setting))
+    {
+        minSpeed = DEFAULT_MIN_SPEED;
+        taperMl = DEFAULT_TAPER_ML;
+        return;
+    }
+    minSpeed = newMin;
+    taperMl = (setting >> SPEED_TAPER_S) & SPEED_TAPER_M;
+}
+
+uint32_t getPumpSpeedSetting(uint8_t newMin, uint16_t newTaper)
+{
+    return newMin | ((uint32_t)newTaper << SPEED_TAPER_S);
+}
+
+uint16_t getPumpDuty(uint16_t level, uint16_t target)  // PWM compare value for the distance left to fill
+{
+    uint16_t minDuty = Q16_SCALE(Q16_RATIO(minSpeed, 100), PWM_FULL);
+    uint16_t distance = (level >= target) ? 0 : target - level;
+    if((taperMl == 0) || (distance >= taperMl))
+    {
+        lastDuty = PWM_FULL;
+    }
+    else
+    {
+        lastDuty = minDuty + Q16_SCALE(Q16_RATIO(distance, taperMl), PWM_FULL - minDuty);
+    }
+    return lastDuty;
+}
+
+void cutoffPump(uint32_t now)                       // The run hit the maximum time
+{
+    if(state == PUMP_FILLING)
+    {
+        cutoffs++;
+        stop(now);
+    }
+}
+
+bool pumpBusy(uint32_t now)                         // Running or still inside the minimum off-time
+{
+    return (state == PUMP_FILLING) || ((state == PUMP_RESTING) && (now - stopTime < minOffS));
+}
+
+uint16_t getMaxRun()
+{
+    return maxRunS;
+}
+
+void getPumpStats(PUMP_STATS* stats)
+{
+    stats->state = state;
+    stats->bandMl = bandMl;
+    stats->maxRunS = maxRunS;
+    stats->minOffS = minOffS;
+    stats->starts = starts;
+    stats->cutoffs = cutoffs;
+    stats->lastRunS = lastRunS;
+    stats->longestRunS = longestRunS;
+    stats->minSpeed = minSpeed;
+    stats->taperMl = taperMl;
+    stats->lastDuty = lastDuty;
+}
@@ -0,0 +1,60 @@
+/*
+ * pumpControl.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef PUMPCONTROL_H_
+#define PUMPCONTROL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEFAULT_BAND_ML 20                          // Refill once the level is this far below the target
+#define DEFAULT_MAX_RUN_S 60                        // Safety cutoff, Timer 3 holds 107 s at 40 MHz
+#define DEFAULT_MIN_OFF_S 30                        // Rest between runs
+#define MAX_RUN_LIMIT_S 100
+#define PUMP_BAND_M 0xFF                            // Setting word: band in bits 0-7,
+#define PUMP_RUN_S 8                                // max run in bits 8-19
+#define PUMP_OFF_S 20                               // and min off-time in bits 20-31
+#define PUMP_TIME_M 0xFFF
+#define DEFAULT_MIN_SPEED 40                        // Percent at the target
+#define DEFAULT_TAPER_ML 100                        // Full speed from this far below the target
+#define SPEED_MIN_M 0xFF                            // Speed setting word: minimum percent in bits 0-7,
+#define SPEED_TAPER_S 8                             // taper distance in ml in bits 8-23
+#define SPEED_TAPER_M 0xFFFF
+
+// Controller states
+#define PUMP_IDLE 0
+#define PUMP_FILLING 1
+#define PUMP_RESTING 2                              // Off for the minimum off-time
+
+typedef struct _PUMP_STATS
+{
+    uint8_t state;
+    uint8_t bandMl;
+    uint16_t maxRunS;
+    uint16_t minOffS;
+    uint8_t minSpeed;
+    uint16_t taperMl;
+    uint16_t lastDuty;                              // Compare value of the last update
+    uint32_t starts;
+    uint32_t cutoffs;                               // Runs stopped by the safety cutoff
+    uint32_t lastRunS;
+    uint32_t longestRunS;
+} PUMP_STATS;
+
+bool validPumpSetting(uint32_t setting);
+void initPumpControl(uint32_t setting);
+uint32_t getPumpSetting(uint8_t bandMl, uint16_t maxRunS, uint16_t minOffS);
+bool updatePump(uint16_t level, uint16_t target, bool demand, uint32_t now);
+bool validPumpSpeedSetting(uint32_t setting);
+void initPumpSpeed(uint32_t setting);
+uint32_t getPumpSpeedSetting(uint8_t minSpeed, uint16_t taperMl);
+uint16_t getPumpDuty(uint16_t level, uint16_t target);
+void cutoffPump(uint32_t now);
+bool pumpBusy(uint32_t now);
+uint16_t getMaxRun();
+void getPumpStats(PUMP_STATS* stats);
+
+#endif /* PUMPCONTROL_H_ */
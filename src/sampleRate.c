@@ -0,0 +1,109 @@
+//Decides how long Timer 1 waits before the next water level sample. While the pump runs, while the
+//level is moving and for a few samples after motion or after the pump stops the bowl is sampled at the
+//minimum period. Once the level holds still the period doubles every sample up to the maximum.
+//The samples after the pump stops also measure how far the level overshot the target.
+#include <stdint.h>
+#include <stdbool.h>
+#include "sampleRate.h"
+
+static uint32_t minMs = DEFAULT_MIN_MS;
+static uint32_t maxMs = DEFAULT_MAX_MS;
+static uint32_t periodMs = DEFAULT_MAX_MS;
+static uint16_t lastLevel = 0;
+static uint8_t fastHold = 0;
+static bool wasPumping = false;
+static uint8_t overshootHold = 0;                   // Samples left to watch the level after the pump stopped
+static uint16_t overshootTarget = 0;
+static uint32_t samples = 0;
+static uint32_t fastSamples = 0;
+static uint16_t lastOvershoot = 0;
+static uint16_t maxOvershoot = 0;
+
+bool validSampleSetting(uint32_t setting)
+{
+    uint32_t newMin = (setting & SAMPLE_MIN_M) * SAMPLE_UNIT_MS;
+    uint32_t newMax = (setting >> SAMPLE_MAX_S) * SAMPLE_UNIT_MS;
+    return (newMin != 0) && (newMin <= newMax) && (newMax <= MAX_SAMPLE_MS);
+}
+
+void initSampleRate(uint32_t setting)               // setting is the stored word, erased means defaults
+{
+    uint32_t newMin = (setting & SAMPLE_MIN_M) * SAMPLE_UNIT_MS;
+    uint32_t newMax = (setting >> SAMPLE_MAX_S) * SAMPLE_UNIT_MS;
+    if(!validSampleSetting(setting))
+    {
+        newMin = DEFAULT_MIN_MS;
+        newMax = DEFAULT_MAX_MS;
+    }
+    minMs = newMin;
+    maxMs = newMax;
+    if(periodMs > maxMs)
+    {
+        periodMs = maxMs;
+    }
+}
+
+uint32_t getSampleSetting(uint32_t newMin, uint32_t newMax)
+{
+    return (newMin / SAMPLE_UNIT_MS) | ((newMax / SAMPLE_UNIT_MS) << SAMPLE_MAX_S);
+}
+
+uint32_t nextSamplePeriod(uint16_t level, uint16_t target, bool pumpOn)  // Called with every filtered level, returns ms
+{
+    uint16_t change = (level > lastLevel) ? level - lastLevel : lastLevel - level;
+    samples++;
+
+    if(wasPumping && !pumpOn)                       // Pump just stopped, watch where the level settles
+    {
+        overshootHold = FAST_HOLD;
+        overshootTarget = target;
+        lastOvershoot = 0;
+    }
+    if(overshootHold > 0)
+    {
+        overshootHold--;
+        if((level > overshootTarget) && (level - overshootTarget > lastOvershoot))
+        {
+            lastOvershoot = level - overshootTarget;
+            if(lastOvershoot > maxOvershoot)
+            {
+                maxOvershoot = lastOvershoot;
+            }
+        }
+    }
+    wasPumping = pumpOn;
+    lastLevel = level;
+
+    if(pumpOn || (overshootHold > 0) || (fastHold > 0) || (change > STEADY_ML))
+    {
+        if(fastHold > 0)
+        {
+            fastHold--;
+        }
+        periodMs = minMs;
+        fastSamples++;
+    }
+    else                                            // Steady, back off
+    {
+        periodMs = (periodMs * 2 > maxMs) ? maxMs : periodMs * 2;
+    }
+    return periodMs;
+}
+
+uint32_t sampleSoon()                               // Motion was seen, returns the period to switch to now
+{
+    fastHold = FAST_HOLD;
+    periodMs = minMs;
+    return periodMs;
+}
+
+void getSampleStats(SAMPLE_STATS* stats)
+{
+    stats->minMs = minMs;
+    stats->maxMs = maxMs;
+    stats->periodMs = periodMs;
+    stats->samples = samples;
+    stats->fastSamples = fastSamples;
+    stats->lastOvershoot = lastOvershoot;
+    stats->maxOvershoot = maxOvershoot;
+}
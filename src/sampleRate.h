@@ -0,0 +1,40 @@
+/*
+ * sampleRate.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SAMPLERATE_H_
+#define SAMPLERATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEFAULT_MIN_MS 200                          // While filling or after motion
+#define DEFAULT_MAX_MS 10000                        // The old fixed Timer 1 period
+#define MAX_SAMPLE_MS 100000                        // Timer 1 holds 107 s at 40 MHz
+#define SAMPLE_UNIT_MS 10                           // Setting word: min and max in 10 ms units
+#define SAMPLE_MAX_S 16
+#define SAMPLE_MIN_M 0xFFFF
+#define STEADY_ML 5                                 // Change between samples that still counts as steady
+#define FAST_HOLD 10                                // Fast samples taken after motion or the pump stopping
+
+typedef struct _SAMPLE_STATS
+{
+    uint32_t minMs;
+    uint32_t maxMs;
+    uint32_t periodMs;                              // Time to the next sample
+    uint32_t samples;
+    uint32_t fastSamples;                           // Samples taken at the minimum period
+    uint16_t lastOvershoot;                         // ml above the target after the pump stopped
+    uint16_t maxOvershoot;
+} SAMPLE_STATS;
+
+bool validSampleSetting(uint32_t setting);
+void initSampleRate(uint32_t setting);
+uint32_t getSampleSetting(uint32_t minMs, uint32_t maxMs);
+uint32_t nextSamplePeriod(uint16_t level, uint16_t target, bool pumpOn);
+uint32_t sampleSoon();
+void getSampleStats(SAMPLE_STATS* stats);
+
+#endif /* SAMPLERATE_H_ */
@@ -0,0 +1,206 @@
+//Moves the whole feeding schedule in and out as text. "schedule export" prints the table as import lines
+//carrying three records of hex each and a closing line with the record count and a CRC-16, so the output
+//can be pasted back. The records of an import are staged and checked in RAM; nothing reaches the EEPROM
+//until the closing line matches and the log has room for every changed word, and then the changed words
+//are written and the heap is rebuilt and the alarm armed once for the whole table instead of once per event.
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+#include "sortEvent.h"
+#include "AlarmTIme.h"
+#include "protocol.h"
+#include "scheduleTransfer.h"
+
+static uint32_t staged[MAX_EVENTS * EVENT_WORDS];   // Time and action word of every event, all ones when free
+static bool importing = false;
+static uint16_t received = 0;
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+static int8_t hexValue(char c)
+{
+    if((c >= '0') && (c <= '9'))
+    {
+        return c - '0';
+    }
+    if((c >= 'A') && (c <= 'F'))
+    {
+        return c - 'A' + 10;
+    }
+    if((c >= 'a') && (c <= 'f'))
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static bool readHex(const char* text, uint8_t digits, uint32_t* value)
+{
+    uint8_t i = 0;
+    *value = 0;
+    for(i = 0; i < digits; i++)
+    {
+        int8_t nibble = hexValue(text[i]);
+        if(nibble < 0)
+        {
+            return false;
+        }
+        *value = (*value << 4) | nibble;
+    }
+    return true;
+}
+
+static void writeHex(char* text, uint8_t digits, uint32_t value)
+{
+    while(digits > 0)
+    {
+        digits--;
+        text[digits] = hexDigits[value & 0xF];
+        value >>= 4;
+    }
+}
+
+static uint16_t checkStaged(uint16_t* count)        // CRC-16 over the active records in event order
+{
+    uint16_t crc = CRC_START;
+    uint16_t event = 0;
+    *count = 0;
+    for(event = 0; event < MAX_EVENTS; event++)
+    {
+        if(staged[event * EVENT_WORDS] != 0xFFFFFFFF)
+        {
+            uint8_t record[9];
+            record[0] = event;
+            putWord(&record[1], staged[event * EVENT_WORDS]);
+            putWord(&record[5], staged[(event * EVENT_WORDS) + 1]);
+            crc = crc16(crc, record, sizeof(record));
+            (*count)++;
+        }
+    }
+    return crc;
+}
+
+void beginImport()
+{
+    uint16_t i = 0;
+    for(i = 0; i < MAX_EVENTS * EVENT_WORDS; i++)
+    {
+        staged[i] = 0xFFFFFFFF;                     // Events the import leaves out are deleted
+    }
+    importing = true;
+    received = 0;
+}
+
+uint8_t importRecords(const char* hex)
+{
+    uint8_t error = IMPORT_OK;
+    if(!importing)
+    {
+        return IMPORT_NOT_BEGUN;
+    }
+    while((*hex != '\0') && (error == IMPORT_OK))
+    {
+        uint32_t event = 0;
+        uint32_t time = 0;
+        uint32_t action = 0;
+        if(!readHex(hex, 2, &event) || !readHex(hex + 2, 8, &time) || !readHex(hex + 10, 8, &action))
+        {
+            error = IMPORT_BAD_HEX;                 // Also stops at a short record, the NUL is not a digit
+        }
+        else if(!validEventRecord(time, action))  // The checks of "feed", "repeat" and MSG_SET_EVENT
+        {
+            error = IMPORT_BAD_RECORD;
+        }
+        else if(staged[event * EVENT_WORDS] != 0xFFFFFFFF)
+        {
+            error = IMPORT_DUPLICATE;
+        }
+        else
+        {
+            staged[event * EVENT_WORDS] = time;
+            staged[(event * EVENT_WORDS) + 1] = action;
+            received++;
+            hex += RECORD_HEX;
+        }
+    }
+    if(error != IMPORT_OK)
+    {
+        importing = false;                          // A bad line spoils the whole import
+    }
+    return error;
+}
+
+uint8_t endImport(uint16_t count, uint16_t check)
+{
+    uint16_t stagedCount = 0;
+    uint16_t event = 0;
+    bool ok = true;
+    if(!importing)
+    {
+        return IMPORT_NOT_BEGUN;
+    }
+    importing = false;
+    if((checkStaged(&stagedCount) != check) || (stagedCount != count) || (received != count))
+    {
+        return IMPORT_MISMATCH;
+    }
+    if(!eepromCacheFits(EVENT_BASE, staged, MAX_EVENTS * EVENT_WORDS))
+    {
+        return IMPORT_FULL;                         // Refused before the first write, the old schedule stands
+    }
+
+    for(event = 0; ok && (event < MAX_EVENTS); event++)   // The cache skips words that already hold the value
+    {
+        uint32_t* record = &staged[event * EVENT_WORDS];
+        if(record[0] == 0xFFFFFFFF)
+        {
+            ok = writeEepromCacheBlock(EVENT_TIME(event), record, EVENT_WORDS);   // Time first, the event goes inactive
+        }
+        else
+        {
+            ok = writeEepromCache(EVENT_ACTION(event), record[1]) && writeEepromCache(EVENT_TIME(event), record[0]);  // The time word activates it
+        }
+    }
+    sortEvent();                                    // One rebuild and one alarm for the whole table
+    AlarmTime();
+    return ok ? IMPORT_OK : IMPORT_FULL;
+}
+
+void cancelImport()
+{
+    importing = false;
+}
+
+bool importRunning()
+{
+    return importing;
+}
+
+uint16_t loadExport(uint16_t* check)                // Stages the stored table for exportLine, returns the event count
+{
+    uint16_t count = 0;
+    importing = false;                              // The staging table is shared with import
+    readEepromCacheBlock(EVENT_BASE, staged, MAX_EVENTS * EVENT_WORDS);
+    *check = checkStaged(&count);
+    return count;
+}
+
+bool exportLine(uint16_t* event, char* line)        // Writes up to RECORDS_PER_LINE records from *event on, line holds RECORDS_PER_LINE * RECORD_HEX + 1
+{
+    uint8_t records = 0;
+    while((*event < MAX_EVENTS) && (records < RECORDS_PER_LINE))
+    {
+        uint32_t* record = &staged[*event * EVENT_WORDS];
+        if(record[0] != 0xFFFFFFFF)
+        {
+            writeHex(line, 2, *event);
+            writeHex(line + 2, 8, record[0]);
+            writeHex(line + 10, 8, record[1]);
+            line += RECORD_HEX;
+            records++;
+        }
+        (*event)++;
+    }
+    *line = '\0';
+    return records != 0;
+}
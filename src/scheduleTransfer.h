@@ -0,0 +1,33 @@
+/*
+ * scheduleTransfer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SCHEDULETRANSFER_H_
+#define SCHEDULETRANSFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RECORD_HEX 18                               // Event (2 hex digits), time word (8) and action word (8)
+#define RECORDS_PER_LINE 3                          // Keeps an import line under MAX_CHARS
+
+// Results of the import steps
+#define IMPORT_OK         0
+#define IMPORT_NOT_BEGUN  1                         // Records or end without "begin"
+#define IMPORT_BAD_HEX    2                         // Not a whole number of records of hex digits
+#define IMPORT_BAD_RECORD 3                         // A time or action word "feed" and "repeat" would refuse
+#define IMPORT_DUPLICATE  4                         // The same event twice
+#define IMPORT_MISMATCH   5                         // Count or check differ from what was received
+#define IMPORT_FULL       6                         // The EEPROM log has no room for the new words, nothing was written
+
+void beginImport();
+uint8_t importRecords(const char* hex);
+uint8_t endImport(uint16_t count, uint16_t check);
+void cancelImport();
+bool importRunning();
+uint16_t loadExport(uint16_t* check);
+bool exportLine(uint16_t* event, char* line);
+
+#endif /* SCHEDULETRANSFER_H_ */
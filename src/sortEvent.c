@@ -1,52 +1,323 @@
-//File created in order to sort the events using the hours and minutes values and updating the index.
+//File created in order to sort the events by the time they fire next.
+//The events stay where they are stored, a min-heap of event numbers keyed by the RTC second of the next
+//fire is kept in RAM so the earliest event is always at the top and insert/delete are O(log n).
+//Repeating events are moved to their next occurrence when they fire, nothing is written to the EEPROM.
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "tm4c123gh6pm.h"
 #include "eeprom.h"
+#include "eepromCache.h"
+#include "sortEvent.h"
 
-void sortEvent()
+static uint32_t heapTime[MAX_EVENTS];       // RTC second the event fires next
+static uint16_t heapEvent[MAX_EVENTS];      // Event number at each heap position
+static uint16_t heapPos[MAX_EVENTS];        // Heap position of each event, NO_EVENT if not scheduled
+static uint16_t heapSize = 0;
+static uint16_t walk[(MAX_EVENTS / 2) + 1];  // Heap positions still to be listed, a min-heap of its own
+static uint16_t walkSize = 0;
+
+static uint32_t readRtc()
 {
-    uint16_t TOTAL_BLOCKS = 10;
-    uint8_t fo;
-    uint8_t block = 0;
-    for (block = 0; block < TOTAL_BLOCKS; block++)
+    while(!(HIB_CTL_R & HIB_CTL_WRC));
+    return HIB_RTCC_R;
+}
+
+uint8_t getWeekday(uint32_t seconds)        // Day of the week of an RTC time, 0 = Sunday
+{
+    uint32_t day0 = readEepromCache(SETTING_WEEKDAY);
+    if(day0 > 6)
+    {
+        day0 = 0;
+    }
+    return (day0 + (seconds / SECONDS_PER_DAY)) % 7;
+}
+
+void setWeekday(uint8_t weekday)            // Sets today's weekday by storing the one of RTC day 0
+{
+    uint32_t today = (readRtc() / SECONDS_PER_DAY) % 7;
+    writeEepromCache(SETTING_WEEKDAY, (weekday + 7 - today) % 7);
+}
+
+bool validEventRecord(uint32_t time, uint32_t action)    // Same ranges for "feed", "repeat", the binary protocol and imports
+{
+    uint8_t rule = (time >> TIME_RULE_S) & TIME_RULE_M;
+    uint8_t arg = (time >> TIME_ARG_S) & TIME_ARG_M;
+    bool argOk = (arg == 0);                // Once and daily take none
+    if(rule == RULE_HOURS)
+    {
+        argOk = (arg >= 1) && (arg <= 24);
+    }
+    else if(rule == RULE_WEEKDAYS)
+    {
+        argOk = (arg != 0);
+    }
+    return ((time & TIME_MINUTES_M) < 24 * 60) && ((time >> TIME_ARG_S) <= TIME_ARG_M) && argOk
+           && (((action & ~ACTION_GRAMS) >> ACTION_PWM_S) <= ACTION_PWM_MAX);   // Also no bits between the PWM and ACTION_GRAMS
+}
+
+static uint32_t nextFireTime(uint16_t event, uint32_t after)  // First occurrence of the event at or after an RTC time
+{
+    uint32_t time = readEepromCache(EVENT_TIME(event));
+    uint32_t start = (time & TIME_MINUTES_M) * 60;
+    uint8_t rule = (time >> TIME_RULE_S) & TIME_RULE_M;
+    uint8_t arg = (time >> TIME_ARG_S) & TIME_ARG_M;
+    uint32_t fire = (after - (after % SECONDS_PER_DAY)) + start;
+
+    if(rule == RULE_HOURS)                  // start, start + N hours, ... counted from RTC day 0
     {
-        int ActiveFlag = readEeprom(16 * block + 5);
+        uint32_t period = ((arg == 0) || (arg > 24) ? 24 : arg) * 3600;
+        if(after <= start)
+        {
+            return start;
+        }
+        return start + (((after - start + period - 1) / period) * period);
+    }
 
-        if (ActiveFlag == 1)
+    if(fire < after)
+    {
+        fire += SECONDS_PER_DAY;
+    }
+    if((rule == RULE_WEEKDAYS) && (arg != 0))
+    {
+        uint8_t days = 0;
+        while(!(arg & (1 << getWeekday(fire))) && (days++ < 7))  // At most a week ahead
         {
-            uint8_t i = 0;
-            for (i = 0; i < TOTAL_BLOCKS - 1; i++)
-            {
-                uint8_t j = 0;
-                for (j = 0; j < TOTAL_BLOCKS - i -1; j++)
-                {
-                    uint32_t currentHours = (readEeprom(16 * j + 3));
-                    uint32_t currentMinutes = (readEeprom(16 * j + 4));
-
-                    uint32_t nextHours = (readEeprom(16 * (j + 1) + 3));
-                    uint32_t nextMinutes = (readEeprom(16 * (j + 1) + 4));
-
-                    if ((currentHours > nextHours) || (currentHours == nextHours && currentMinutes > nextMinutes))
-                    {
-                        uint8_t k = 0;
-                        for (k = 0; k < 16; k++)    //Swap the entire block
-                        {
-                            uint32_t temp = readEeprom(16 * j + k);
-                            writeEeprom(16 * j + k, readEeprom(16 * (j + 1) + k));
-                            writeEeprom(16 * (j + 1) + k, temp);
-                        }
-                    }
-                }
-            }
-            // Update the event field on the eeprom
+            fire += SECONDS_PER_DAY;
+        }
+    }
+    return fire;
+}
 
-            for (fo = 0; fo < 10; fo++)
+static bool earlier(uint16_t a, uint16_t b)  // Heap order: fire time, then event number for equal times
+{
+    return (heapTime[a] < heapTime[b]) || ((heapTime[a] == heapTime[b]) && (heapEvent[a] < heapEvent[b]));
+}
+
+static void swapEntries(uint16_t a, uint16_t b)
+{
+    uint32_t time = heapTime[a];
+    uint16_t event = heapEvent[a];
+    heapTime[a] = heapTime[b];
+    heapEvent[a] = heapEvent[b];
+    heapTime[b] = time;
+    heapEvent[b] = event;
+    heapPos[heapEvent[a]] = a;
+    heapPos[heapEvent[b]] = b;
+}
+
+static void siftUp(uint16_t i)
+{
+    while(i > 0 && earlier(i, (i - 1) / 2))
+    {
+        swapEntries(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void siftDown(uint16_t i)
+{
+    while(true)
+    {
+        uint16_t smallest = i;
+        uint16_t left = (2 * i) + 1;
+        uint16_t right = left + 1;
+        if(left < heapSize && earlier(left, smallest))
+        {
+            smallest = left;
+        }
+        if(right < heapSize && earlier(right, smallest))
+        {
+            smallest = right;
+        }
+        if(smallest == i)
+        {
+            return;
+        }
+        swapEntries(i, smallest);
+        i = smallest;
+    }
+}
+
+void initSchedule()                         // Moves events from the old one-block-per-event layout, then builds the heap
+{
+    uint8_t block = 0;
+    const uint32_t cleared[6] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+    if(readEepromCache(SETTING_LAYOUT) == 0xFFFFFFFF)
+    {
+        for(block = 0; block < SETTING_BLOCKS; block++)
+        {
+            uint32_t legacy[6];             // index, duration, pwm, hours, minutes, active flag
+            readEepromCacheBlock(BLOCK_WORDS * block, legacy, 6);
+            if(legacy[5] == 1)
             {
-                uint8_t sorted = 16* fo;
-                writeEeprom(sorted, fo);  //Event address
+                uint32_t record[2];
+                record[0] = ((legacy[3] % 24) * 60) + legacy[4];
+                record[1] = (legacy[1] & ACTION_DURATION_M) | ((legacy[2] & ACTION_PWM_M) << ACTION_PWM_S);
+                writeEepromCache(EVENT_ACTION(block), record[1]);
+                writeEepromCache(EVENT_TIME(block), record[0]);
             }
+            writeEepromCacheBlock(BLOCK_WORDS * block, cleared, 6);  // Frees the words, nothing is written once they are erased
+        }
+        writeEepromCache(SETTING_LAYOUT, 1);    // Blocks 1-9 are free for other settings from now on
+    }
+    sortEvent();
+}
+
+void sortEvent()                            // Rebuilds the heap from the stored events, needed when the RTC is set
+{
+    uint32_t now = readRtc();
+    uint16_t event = 0;
+    heapSize = 0;
+    for(event = 0; event < MAX_EVENTS; event++)
+    {
+        heapPos[event] = NO_EVENT;
+        if(readEepromCache(EVENT_TIME(event)) != 0xFFFFFFFF)
+        {
+            heapTime[heapSize] = nextFireTime(event, now);
+            heapEvent[heapSize] = event;
+            heapPos[event] = heapSize;
+            heapSize++;
+        }
+    }
+    for(event = heapSize / 2; event > 0; event--)
+    {
+        siftDown(event - 1);
+    }
+}
+
+static void queueEvent(uint16_t event, uint32_t after)
+{
+    if(readEepromCache(EVENT_TIME(event)) == 0xFFFFFFFF)
+    {
+        removeEvent(event);
+        return;
+    }
+
+    uint16_t i = heapPos[event];
+    if(i == NO_EVENT)
+    {
+        i = heapSize++;
+        heapEvent[i] = event;
+        heapPos[event] = i;
+    }
+    heapTime[i] = nextFireTime(event, after);
+    siftUp(i);
+    siftDown(heapPos[event]);
+}
+
+void insertEvent(uint16_t event)            // Schedules a new event or moves a changed one to its new place
+{
+    queueEvent(event, readRtc());
+}
+
+void rescheduleEvent(uint16_t event)        // Moves a repeating event that is firing now to its next occurrence
+{
+    queueEvent(event, readRtc() + 1);
+}
+
+void removeEvent(uint16_t event)
+{
+    uint16_t i = heapPos[event];
+    if(i == NO_EVENT)
+    {
+        return;
+    }
+    heapPos[event] = NO_EVENT;
+    heapSize--;
+    if(i != heapSize)                       // Fill the hole with the last entry and restore the heap order
+    {
+        uint16_t moved = heapEvent[heapSize];
+        heapTime[i] = heapTime[heapSize];
+        heapEvent[i] = moved;
+        heapPos[moved] = i;
+        siftUp(i);
+        siftDown(heapPos[moved]);
+    }
+}
+
+uint16_t getEventCount()
+{
+    return heapSize;
+}
+
+uint16_t getNextEvent()                     // Event at the top of the heap, NO_EVENT if nothing is scheduled
+{
+    return (heapSize > 0) ? heapEvent[0] : NO_EVENT;
+}
+
+uint32_t getNextFireTime()
+{
+    return heapTime[0];
+}
+
+bool eventScheduled(uint16_t event)
+{
+    return (event < MAX_EVENTS) && (heapPos[event] != NO_EVENT);
+}
+
+static void walkPush(uint16_t position)
+{
+    uint16_t i = walkSize++;
+    while((i > 0) && earlier(position, walk[(i - 1) / 2]))
+    {
+        walk[i] = walk[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    walk[i] = position;
+}
+
+static uint16_t walkPop()
+{
+    uint16_t top = walk[0];
+    uint16_t last = walk[--walkSize];
+    uint16_t i = 0;
+    while(true)
+    {
+        uint16_t child = (2 * i) + 1;
+        if(child >= walkSize)
+        {
+            break;
         }
+        if((child + 1 < walkSize) && earlier(walk[child + 1], walk[child]))
+        {
+            child++;
+        }
+        if(!earlier(walk[child], last))
+        {
+            break;
+        }
+        walk[i] = walk[child];
+        i = child;
+    }
+    walk[i] = last;
+    return top;
+}
+
+void startEventWalk()                       // Lists the events in fire order without touching the heap, see nextWalkEvent
+{
+    walkSize = 0;
+    if(heapSize > 0)
+    {
+        walkPush(0);
     }
 }
 
+uint16_t nextWalkEvent()                    // Next event in fire order, NO_EVENT at the end. A heap entry is only
+{                                           // earlier than its children, so they join the walk once it is listed.
+    uint16_t position = 0;
+    if(walkSize == 0)
+    {
+        return NO_EVENT;
+    }
+    position = walkPop();
+    if((2 * position) + 1 < heapSize)
+    {
+        walkPush((2 * position) + 1);
+    }
+    if((2 * position) + 2 < heapSize)
+    {
+        walkPush((2 * position) + 2);
+    }
+    return heapEvent[position];
+}
@@ -8,6 +8,46 @@
 #ifndef SORTEVENT_H_
 #define SORTEVENT_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+
+#define NO_EVENT 0xFFFF
+#define SECONDS_PER_DAY 86400
+
+// Feeding event record, two cache words per event
+#define EVENT_TIME(e)   (EVENT_BASE + ((e) * EVENT_WORDS))  // Minutes after midnight and repeat rule, 0xFFFFFFFF when the event is free
+#define EVENT_ACTION(e) (EVENT_TIME(e) + 1)                 // Duration in seconds and motor PWM
+#define TIME_MINUTES_M    0x000007FF
+#define TIME_RULE_S       11
+#define TIME_RULE_M       0x3
+#define TIME_ARG_S        13                                // Weekday mask (bit 0 = Sunday) or period in hours
+#define TIME_ARG_M        0x7F
+#define ACTION_DURATION_M 0x0000FFFF
+#define ACTION_PWM_S      16
+#define ACTION_PWM_M      0xFF
+#define ACTION_PWM_MAX    100                               // Motor speed in percent
+#define ACTION_GRAMS      0x80000000                        // Duration field is a portion in grams, see "portion"
+
+// Repeat rules
+#define RULE_ONCE         0                                 // Fires at the next HH:MM and is deleted
+#define RULE_DAILY        1
+#define RULE_WEEKDAYS     2                                 // HH:MM on the days set in the mask
+#define RULE_HOURS        3                                 // HH:MM and every N hours after it
+
+bool validEventRecord(uint32_t time, uint32_t action);
+void initSchedule();
 void sortEvent();
+void insertEvent(uint16_t event);
+void rescheduleEvent(uint16_t event);
+void removeEvent(uint16_t event);
+uint16_t getEventCount();
+uint16_t getNextEvent();
+uint32_t getNextFireTime();
+bool eventScheduled(uint16_t event);
+void startEventWalk();
+uint16_t nextWalkEvent();
+uint8_t getWeekday(uint32_t seconds);
+void setWeekday(uint8_t weekday);
 
 #endif /* SORTEVENT_H_ */
@@ -27,10 +27,27 @@
 #define UART_TX_MASK 2
 #define UART_RX_MASK 1
 
+#define TX_MASK (UART0_TX_SIZE - 1)
+#define RX_MASK (UART0_RX_SIZE - 1)
+
 //-----------------------------------------------------------------------------
 // Global variables
 //-----------------------------------------------------------------------------
 
+// Both rings use free running indices, the difference is the number of characters held.
+// The TX head is advanced by any caller with interrupts masked, the tail only by the UART
+// side. The RX head is advanced only by serviceUart0 and the tail only by the main loop.
+// Masked sections save PRIMASK and restore it rather than ending with cpsie, so a caller
+// that already had interrupts masked, such as another critical section, keeps them masked.
+char txRing[UART0_TX_SIZE];
+volatile uint32_t txHead = 0;
+volatile uint32_t txTail = 0;
+char rxRing[UART0_RX_SIZE];
+volatile uint32_t rxHead = 0;
+volatile uint32_t rxTail = 0;
+UART0_STATS uartStats;
+bool textMuted = false;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
@@ -59,6 +76,7 @@ void initUart0()
     UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;    // configure for 8N1 w/ 16-level FIFO
     UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN;
                                                         // enable TX, RX, and module
+    UART0_IM_R = UART_IM_RXIM | UART_IM_RTIM;           // receive and receive timeout fill the rx ring, TXIM is set while the tx ring holds data
 }
 
 // Set baud rate as function of instruction cycle frequency
@@ -75,30 +93,148 @@ void setUart0BaudRate(uint32_t baudRate, uint32_t fcyc)
                                                         // turn-on UART0
 }
 
-// Blocking function that writes a serial character when the UART buffer is not full
+// Moves characters from the tx ring into the tx fifo, call with interrupts masked
+void fillTxFifo()
+{
+    while ((txTail != txHead) && !(UART0_FR_R & UART_FR_TXFF))
+        UART0_DR_R = txRing[txTail++ & TX_MASK];
+    if (txTail == txHead)
+        UART0_IM_R &= ~UART_IM_TXIM;                 // nothing left to send
+    else
+        UART0_IM_R |= UART_IM_TXIM;                  // interrupt again when the fifo drains below its trigger
+}
+
+// Non-blocking function that queues a serial character, returns false and counts a drop when the ring is full
+bool tryPutcUart0(char c)
+{
+    bool ok;
+    uint32_t used;
+    uint32_t primask = _disable_interrupts();        // interrupts may queue output too
+    used = txHead - txTail;
+    ok = used < UART0_TX_SIZE;
+    if (ok)
+    {
+        txRing[txHead++ & TX_MASK] = c;
+        if (used + 1 > uartStats.txHigh)
+            uartStats.txHigh = used + 1;
+        fillTxFifo();                                // starts the transmitter when it is idle
+    }
+    else
+        uartStats.txDropped++;
+    _restore_interrupts(primask);
+    return ok;
+}
+
+// Queues a serial character. In an interrupt a full ring drops the character, otherwise the
+// caller waits for room (backpressure) while the fifo is fed directly so it cannot stall.
 void putcUart0(char c)
 {
-    while (UART0_FR_R & UART_FR_TXFF);               // wait if uart0 tx fifo full
-    UART0_DR_R = c;                                  // write character to fifo
+    bool stalled = false;
+    if (NVIC_INT_CTRL_R & NVIC_INT_CTRL_VEC_ACT_M)   // in an interrupt, never wait on the uart
+    {
+        tryPutcUart0(c);
+        return;
+    }
+    while ((txHead - txTail) >= UART0_TX_SIZE)
+    {
+        if (!stalled)
+            uartStats.txStalls++;
+        stalled = true;
+        uint32_t primask = _disable_interrupts();
+        fillTxFifo();
+        _restore_interrupts(primask);
+    }
+    tryPutcUart0(c);
 }
 
-// Blocking function that writes a string when the UART buffer is not full
-void putsUart0(char* str)
+// Queues a string, see putcUart0 for what happens when the ring is full. Dropped while text is muted.
+void putsUart0(const char* str)
 {
     uint8_t i = 0;
+    if (textMuted)
+        return;
     while (str[i] != '\0')
         putcUart0(str[i++]);
 }
 
-// Blocking function that returns with serial data once the buffer is not empty
+// Queues one character of text, dropped while text is muted like putsUart0
+void putTextUart0(char c)
+{
+    if (!textMuted)
+        putcUart0(c);
+}
+
+// Non-blocking function that returns true with the oldest received character, false when none is waiting
+bool tryGetcUart0(char* c)
+{
+    if (rxTail == rxHead)
+        return false;
+    *c = rxRing[rxTail & RX_MASK];
+    rxTail++;                                        // frees the slot only after it has been read
+    return true;
+}
+
+// Blocking function that returns with serial data once the ring is not empty
 char getcUart0()
 {
-    while (UART0_FR_R & UART_FR_RXFE);               // wait if uart0 rx fifo empty
-    return UART0_DR_R & 0xFF;                        // get character from fifo
+    char c;
+    while (!tryGetcUart0(&c));                       // wait for serviceUart0 to fill the rx ring
+    return c;
 }
 
-// Returns the status of the receive buffer
+// Returns the status of the receive ring
 bool kbhitUart0()
 {
-    return !(UART0_FR_R & UART_FR_RXFE);
+    return rxTail != rxHead;
+}
+
+// Called from the UART0 interrupt, moves received characters into the rx ring and refills
+// the tx fifo. Returns true when characters were received.
+bool serviceUart0()
+{
+    bool received = false;
+    uint32_t used;
+    UART0_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC | UART_ICR_TXIC;
+    while (!(UART0_FR_R & UART_FR_RXFE))
+    {
+        char c = UART0_DR_R & 0xFF;
+        used = rxHead - rxTail;
+        if (used < UART0_RX_SIZE)
+        {
+            rxRing[rxHead & RX_MASK] = c;
+            rxHead++;                                // publishes the character after it is stored
+            if (used + 1 > uartStats.rxHigh)
+                uartStats.rxHigh = used + 1;
+        }
+        else
+            uartStats.rxDropped++;                   // the main loop is too far behind
+        received = true;
+    }
+    fillTxFifo();
+    return received;
+}
+
+// Blocking function that returns once everything queued has left the transmitter
+void flushUart0()
+{
+    while (txTail != txHead)
+    {
+        uint32_t primask = _disable_interrupts();
+        fillTxFifo();
+        _restore_interrupts(primask);
+    }
+    while (UART0_FR_R & UART_FR_BUSY);               // last character still shifting out
+}
+
+// Stops putsUart0 output while binary frames, written with putcUart0, own the line
+void muteUart0Text(bool mute)
+{
+    textMuted = mute;
+}
+
+void getUart0Stats(UART0_STATS* stats)
+{
+    uint32_t primask = _disable_interrupts();
+    *stats = uartStats;
+    _restore_interrupts(primask);
 }
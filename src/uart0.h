@@ -21,6 +21,21 @@
 #ifndef UART0_H_
 #define UART0_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART0_TX_SIZE 256                           // power of two, about 22 ms of output at 115200 baud
+#define UART0_RX_SIZE 64                            // power of two, holds a typed line while a command runs
+
+typedef struct _UART0_STATS
+{
+    uint32_t txHigh;                                // most characters ever waiting in the tx ring
+    uint32_t rxHigh;                                // most characters ever waiting in the rx ring
+    uint32_t txDropped;                             // characters an interrupt could not queue
+    uint32_t rxDropped;                             // characters lost because the rx ring was full
+    uint32_t txStalls;                              // times the main loop waited for room in the tx ring
+} UART0_STATS;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
@@ -28,8 +43,15 @@
 void initUart0();
 void setUart0BaudRate(uint32_t baudRate, uint32_t fcyc);
 void putcUart0(char c);
-void putsUart0(char* str);
+void putsUart0(const char* str);
+void putTextUart0(char c);
+bool tryPutcUart0(char c);
 char getcUart0();
+bool tryGetcUart0(char* c);
 bool kbhitUart0();
+bool serviceUart0();
+void flushUart0();
+void muteUart0Text(bool mute);
+void getUart0Stats(UART0_STATS* stats);
 
 #endif
@@ -0,0 +1,210 @@
+//Pet visit log. The PIR interrupts append every finished visit to a RAM ring, and the main loop folds
+//the ring into 24 hourly buckets, so "visits" reads each hour straight out of its bucket instead of
+//scanning a history. Buckets are indexed by hour of day and cleared as the clock moves past them.
+//They are written to the EEPROM cache when the hour changes and before hibernating, never per visit.
+//Setting the clock moves the buckets along with it, so they keep counting when the RTC goes backwards.
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+#include "visits.h"
+
+#define SECONDS_PER_HOUR 3600
+
+static VISIT ring[VISIT_RING];
+static volatile uint32_t written = 0;               // Visits appended, the ISR side owns it
+static volatile uint32_t folded = 0;                // Visits already in the buckets, the main loop owns it
+static uint32_t openStart = 0;                      // Visit in progress
+static bool visitOpen = false;
+static bool openPumped = false;
+static uint32_t buckets[VISIT_HOURS];
+static uint32_t hour = 0;                           // RTC hour of the newest bucket
+static uint32_t savedHour = 0;
+static bool dirty = false;
+static uint32_t dropped = 0;
+static uint32_t saves = 0;
+
+static void clearBuckets(uint32_t newHour)
+{
+    uint8_t i = 0;
+    for(i = 0; i < VISIT_HOURS; i++)
+    {
+        buckets[i] = 0;
+    }
+    hour = newHour;
+    dirty = true;
+}
+
+void initVisits(uint32_t now)
+{
+    readEepromCacheBlock(VISIT_BASE, buckets, VISIT_HOURS);
+    hour = readEepromCache(VISIT_HOUR);
+    savedHour = hour;
+    dirty = false;
+    if((hour == 0xFFFFFFFF) || (hour > now / SECONDS_PER_HOUR))   // Never saved, or the RTC restarted since
+    {
+        clearBuckets(now / SECONDS_PER_HOUR);
+    }
+}
+
+static void rollTo(uint32_t newHour)                // Clears the buckets the clock has moved past
+{
+    uint32_t h = 0;
+    if(newHour <= hour)
+    {
+        return;
+    }
+    if(newHour - hour >= VISIT_HOURS)
+    {
+        clearBuckets(newHour);
+        return;
+    }
+    for(h = hour + 1; h <= newHour; h++)
+    {
+        buckets[h % VISIT_HOURS] = 0;
+    }
+    hour = newHour;
+    dirty = true;
+}
+
+void startVisit(uint32_t now)                       // PIR confirmed a visit
+{
+    openStart = now;
+    visitOpen = true;
+    openPumped = false;
+}
+
+void visitPumped()                                  // The pump started during the visit
+{
+    openPumped = true;
+}
+
+bool endVisit(uint32_t now)                         // The visit is over, false when the ring was full
+{
+    VISIT* visit = &ring[written % VISIT_RING];
+    uint32_t seconds = now - openStart;
+    if(!visitOpen)
+    {
+        return false;
+    }
+    visitOpen = false;
+    if(written - folded >= VISIT_RING)              // Not folded yet, keep the older ones
+    {
+        dropped++;
+        return false;
+    }
+    visit->start = openStart;
+    visit->seconds = (seconds > VISIT_SECONDS_M) ? VISIT_SECONDS_M : seconds;
+    visit->pumped = openPumped;
+    written++;
+    return true;
+}
+
+static void addToBucket(const VISIT* visit)
+{
+    uint32_t visitHour = visit->start / SECONDS_PER_HOUR;
+    uint32_t* bucket = &buckets[visitHour % VISIT_HOURS];
+    uint32_t count = 0;
+    uint32_t pumped = 0;
+    uint32_t seconds = 0;
+
+    rollTo(visitHour);
+    if(hour - visitHour >= VISIT_HOURS)             // Older than the buckets reach
+    {
+        return;
+    }
+    count = *bucket & VISIT_COUNT_M;
+    pumped = (*bucket >> VISIT_PUMPED_S) & VISIT_COUNT_M;
+    seconds = *bucket >> VISIT_SECONDS_S;
+    count += (count < VISIT_COUNT_M);
+    pumped += (visit->pumped && (pumped < VISIT_COUNT_M));
+    seconds = (seconds + visit->seconds > VISIT_SECONDS_M) ? VISIT_SECONDS_M : seconds + visit->seconds;
+    *bucket = count | (pumped << VISIT_PUMPED_S) | (seconds << VISIT_SECONDS_S);
+    dirty = true;
+}
+
+void compactVisits(uint32_t now)                    // Folds new visits into the buckets, saves once per hour
+{
+    while(folded != written)
+    {
+        addToBucket(&ring[folded % VISIT_RING]);
+        folded++;
+    }
+    rollTo(now / SECONDS_PER_HOUR);
+    if(hour != savedHour)
+    {
+        saveVisits();
+    }
+}
+
+void saveVisits()
+{
+    if(dirty)
+    {
+        writeEepromCacheBlock(VISIT_BASE, buckets, VISIT_HOURS);   // The cache skips unchanged words
+        writeEepromCache(VISIT_HOUR, hour);
+        savedHour = hour;
+        dirty = false;
+        saves++;
+    }
+}
+
+void rebaseVisits(uint32_t before, uint32_t now)    // The RTC was loaded with now in place of before, main loop only
+{
+    uint32_t moved[VISIT_HOURS];
+    int32_t shift = (int32_t)(now / SECONDS_PER_HOUR) - (int32_t)(before / SECONDS_PER_HOUR);
+    uint8_t rotate = ((shift % VISIT_HOURS) + VISIT_HOURS) % VISIT_HOURS;
+    uint8_t i = 0;
+
+    compactVisits(before);                          // Visits still in the ring carry the old clock
+    openStart += now - before;
+    if((int32_t)hour + shift < 0)                   // Even the newest bucket would be before RTC hour 0
+    {
+        clearBuckets(now / SECONDS_PER_HOUR);
+        saveVisits();
+        return;
+    }
+    for(i = 0; i < VISIT_HOURS; i++)                // Each hour keeps its age, the hour of day follows the clock
+    {
+        moved[(i + rotate) % VISIT_HOURS] = buckets[i];
+    }
+    hour += shift;
+    for(i = 0; i < VISIT_HOURS; i++)
+    {
+        buckets[i] = ((hour < VISIT_HOURS - 1) && (i > hour)) ? 0 : moved[i];   // Hours before RTC hour 0 are dropped
+    }
+    dirty = true;
+    saveVisits();
+}
+
+void getVisitHour(uint32_t now, uint8_t hoursAgo, VISIT_HOUR_STATS* stats)  // Call compactVisits first
+{
+    uint32_t wanted = (now / SECONDS_PER_HOUR) - hoursAgo;
+    uint32_t bucket = 0;
+    if((hoursAgo < VISIT_HOURS) && (wanted <= hour) && (hour - wanted < VISIT_HOURS))
+    {
+        bucket = buckets[wanted % VISIT_HOURS];
+    }
+    stats->hour = wanted;
+    stats->visits = bucket & VISIT_COUNT_M;
+    stats->pumped = (bucket >> VISIT_PUMPED_S) & VISIT_COUNT_M;
+    stats->seconds = bucket >> VISIT_SECONDS_S;
+}
+
+uint8_t getRecentVisits(VISIT visits[], uint8_t max)  // Newest first, only what is still in the ring
+{
+    uint32_t newest = written;
+    uint8_t count = 0;
+    while((count < max) && (count < VISIT_RING) && (count < newest))
+    {
+        visits[count] = ring[(newest - 1 - count) % VISIT_RING];
+        count++;
+    }
+    return count;
+}
+
+void getVisitStats(VISIT_STATS* stats)
+{
+    stats->logged = written;
+    stats->dropped = dropped;
+    stats->saves = saves;
+}
@@ -0,0 +1,56 @@
+/*
+ * visits.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef VISITS_H_
+#define VISITS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+
+#define VISIT_RING 32                               // Latest visits kept in RAM
+#define VISIT_HOURS 24                              // Hourly buckets, one word each
+#define VISIT_BASE (BLOCK_WORDS*2)                  // Buckets in cache block 2 and the first half of block 3
+#define VISIT_HOUR (VISIT_BASE + VISIT_HOURS)       // RTC hour of the newest bucket
+#define VISIT_COUNT_M 0xFF                          // Bucket word: visits in bits 0-7,
+#define VISIT_PUMPED_S 8                            // visits the pump ran for in bits 8-15
+#define VISIT_SECONDS_S 16                          // and seconds spent at the bowl in bits 16-31
+#define VISIT_SECONDS_M 0xFFFF
+
+typedef struct _VISIT
+{
+    uint32_t start;                                 // RTC seconds
+    uint16_t seconds;
+    bool pumped;                                    // A pump run started during the visit
+} VISIT;
+
+typedef struct _VISIT_HOUR_STATS
+{
+    uint32_t hour;                                  // RTC hour, hour of day is hour % 24
+    uint8_t visits;
+    uint8_t pumped;
+    uint16_t seconds;
+} VISIT_HOUR_STATS;
+
+typedef struct _VISIT_STATS
+{
+    uint32_t logged;                                // Visits since boot
+    uint32_t dropped;                               // Lost because the ring was full
+    uint32_t saves;                                 // Bucket saves to the EEPROM
+} VISIT_STATS;
+
+void initVisits(uint32_t now);
+void startVisit(uint32_t now);
+void visitPumped();
+bool endVisit(uint32_t now);
+void compactVisits(uint32_t now);
+void saveVisits();
+void rebaseVisits(uint32_t before, uint32_t now);
+void getVisitHour(uint32_t now, uint8_t hoursAgo, VISIT_HOUR_STATS* stats);
+uint8_t getRecentVisits(VISIT visits[], uint8_t max);
+void getVisitStats(VISIT_STATS* stats);
+
+#endif /* VISITS_H_ */
@@ -0,0 +1,159 @@
+//Auger drive profiles step by step, as augerISR sees them on the PWM loads: the S-curve up, the hold, the
+//mirrored ramp down and the final 0, one step every PROFILE_STEP_LOADS loads; ramps shortened to fit a
+//short run; the anti-jam pause and full-duty kick at their period during the hold; and a profile stopped
+//by endFeed.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "initModules.h"
+#include "auger.h"
+#include "hostTest.h"
+
+#define MAX_STEPS 2000
+#define DUTY 800
+
+static uint16_t duties[MAX_STEPS];
+
+static uint16_t runProfile(uint16_t duty, uint32_t ms, bool* evenLoads)  // Steps until the profile ends, the last one is 0
+{
+    uint16_t count = 0;
+    uint32_t loads = 0;
+    *evenLoads = true;
+    startProfile(duty, ms);
+    while(profileRunning() && (count < MAX_STEPS))
+    {
+        loads++;
+        if(profileLoad(&duties[count]))
+        {
+            *evenLoads &= (count == 0) ? (loads == 1) : (loads == PROFILE_STEP_LOADS);
+            loads = 0;
+            count++;
+        }
+    }
+    return count;
+}
+
+static bool rampsMirror(uint16_t count, uint8_t steps, uint16_t duty)  // Rising S-curve below the duty, the way down the reverse
+{
+    bool ok = true;
+    uint8_t i = 0;
+    for(i = 0; i < steps; i++)
+    {
+        ok &= (duties[i] < duty) && ((i == 0) || (duties[i] > duties[i - 1]));
+        ok &= (duties[count - 2 - i] == duties[i]);
+    }
+    ok &= (steps == 0) || ((duties[0] < duty / 20) && (duties[steps - 1] > duty - (duty / 20)));  // Starts near 0, ends near the duty
+    return ok && (duties[count - 1] == 0);
+}
+
+static bool holds(uint16_t from, uint16_t to, uint16_t duty)
+{
+    bool ok = true;
+    uint16_t i = 0;
+    for(i = from; i < to; i++)
+    {
+        ok &= (duties[i] == duty);
+    }
+    return ok;
+}
+
+static void testDefault()                           // 5 s at 800: 50 steps up, 400 held, 50 down and the 0
+{
+    bool evenLoads = false;
+    uint16_t count = 0;
+    initAuger(0xFFFFFFFF);
+    count = runProfile(DUTY, 5000, &evenLoads);
+    CHECK(count == 501);
+    CHECK(evenLoads);
+    CHECK(rampsMirror(count, DEFAULT_RAMP_STEPS, DUTY));
+    CHECK(holds(DEFAULT_RAMP_STEPS, 450, DUTY));
+    CHECK((duties[25] - duties[24] > duties[1] - duties[0]) && (duties[25] - duties[24] > duties[49] - duties[48]));   // Steepest mid-ramp
+    CHECK(getRampMs() == DEFAULT_RAMP_STEPS * PROFILE_STEP_MS);
+}
+
+static void testShort()                             // Runs shorter than two ramps split into ramps only
+{
+    bool evenLoads = false;
+    uint16_t count = 0;
+    initAuger(0xFFFFFFFF);
+    count = runProfile(DUTY, 600, &evenLoads);      // 60 steps: 30 up and 30 down
+    CHECK(count == 61);
+    CHECK(rampsMirror(count, 30, DUTY));
+    count = runProfile(PWM_FULL, 10, &evenLoads);   // One step, no ramp
+    CHECK((count == 2) && (duties[0] == PWM_FULL) && (duties[1] == 0));
+    startProfile(DUTY, 0);                          // Nothing to run, runAuger ends the feed straight away
+    CHECK(!profileRunning());
+}
+
+static void testAntiJam()                           // After every 1 s held: 200 ms at 0, then 200 ms at full duty
+{
+    AUGER_STATS stats;
+    bool evenLoads = false;
+    bool ok = true;
+    uint16_t count = 0;
+    uint16_t i = 0;
+    uint16_t jam = 0;
+    uint32_t pulses = 0;
+    uint16_t hold = 0;                              // Hold steps since the last pulse
+
+    initAuger(getAugerSetting(10, 1, 20, 20));
+    getAugerStats(&stats);
+    pulses = stats.jamPulses;
+    count = runProfile(DUTY, 3500, &evenLoads);     // 10 up, 330 in the hold, 10 down
+    CHECK(count == 351);
+    CHECK(rampsMirror(count, 10, DUTY));
+    for(i = 10; i < 340; i++)
+    {
+        if(duties[i] == DUTY)
+        {
+            hold++;
+            continue;
+        }
+        ok &= (hold == 100) && holds(i, i + 20, 0) && holds(i + 20, i + 40, PWM_FULL);   // The same period every time
+        hold = 0;
+        jam++;
+        i += 39;
+    }
+    getAugerStats(&stats);
+    printf("  3.5 s at %d with a pulse every 1 s of hold: %u pulses\n", DUTY, jam);
+    CHECK(ok);
+    CHECK((jam == 2) && (hold == 50));
+    CHECK(stats.jamPulses - pulses == jam);
+}
+
+static void testStop()                              // endFeed stops the profile wherever it is
+{
+    uint16_t duty = 0;
+    uint16_t i = 0;
+    initAuger(0xFFFFFFFF);
+    startProfile(DUTY, 5000);
+    for(i = 0; i < 1000; i++)
+    {
+        profileLoad(&duty);
+    }
+    CHECK(profileRunning());
+    stopProfile();
+    CHECK(!profileRunning());
+    CHECK(!profileLoad(&duty));
+}
+
+static void testLimits()                            // The largest profile "auger" takes still reads back, not as the defaults
+{
+    AUGER_STATS stats;
+    uint32_t setting = getAugerSetting(AUGER_FIELD_MAX, AUGER_FIELD_MAX, AUGER_FIELD_MAX, AUGER_FIELD_MAX);
+    CHECK(setting != 0xFFFFFFFF);
+    initAuger(setting);
+    getAugerStats(&stats);
+    CHECK((stats.rampSteps == AUGER_FIELD_MAX) && (stats.jamEveryS == AUGER_FIELD_MAX));
+    CHECK((stats.pauseSteps == AUGER_FIELD_MAX) && (stats.kickSteps == AUGER_FIELD_MAX));
+}
+
+int main()
+{
+    testDefault();
+    testShort();
+    testAntiJam();
+    testStop();
+    testLimits();
+    return finishTest("augerTest");
+}
@@ -0,0 +1,163 @@
+//EEPROM traffic of the interrupt paths once the cache is loaded. The water level path of analogISR,
+//the alarm and the feed it starts, and the PIR edge and timeout paths of pirISR and Wide4ISR are run
+//the way PetFeeder.c runs them, many times over, and the driver counters must not move: every setting
+//and event they read comes out of RAM. The reads served by the cache are counted to show they happened.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "fixedPoint.h"
+#include "eeprom.h"
+#include "eepromCache.h"
+#include "calibration.h"
+#include "levelFilter.h"
+#include "sampleRate.h"
+#include "pumpControl.h"
+#include "motion.h"
+#include "visits.h"
+#include "sortEvent.h"
+#include "AlarmTIme.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/cacheTest.img"
+#define ROUNDS 1000
+#define EVENTS 10
+
+static uint32_t suppressed = 0;
+
+static uint32_t eepromReads(uint32_t* writes)       // Word reads and writes that reached the EEPROM module
+{
+    EEPROM_STATS stats;
+    getEepromStats(&stats);
+    *writes = stats.eepromWrites;
+    return stats.eepromReads;
+}
+
+static uint32_t cacheReads()
+{
+    EEPROM_STATS stats;
+    getEepromStats(&stats);
+    return stats.cacheReads;
+}
+
+static void levelPath(uint32_t round)               // analogISR: a burst, the lookup, the settings, the pump
+{
+    uint16_t level = 0;
+    uint16_t volume = 0;
+    uint8_t mode = 0;
+    while(!addSample(2400 + (round % 50)));
+    level = ticksToLevel(getFilteredTicks());
+    mode = readEepromCache((16*0)+7);
+    volume = readEepromCache((16*0)+6);
+    if((mode == 1) && (ticksToLevel(getFirstSample()) < volume) && (level >= volume))
+    {
+        suppressed++;
+    }
+    updatePump(level, volume, (mode == 1) || ((mode == 2) && motionDemand()), HIB_RTCC_R);
+    getPumpDuty(level, volume);
+    nextSamplePeriod(level, volume, false);
+}
+
+static bool alarmPath()                             // WORK_ALARM: the due event is moved on and the alarm set again
+{
+    uint16_t event = getNextEvent();
+    uint32_t action = 0;
+    HIB_RTCC_R = getNextFireTime();
+    rescheduleEvent(event);
+    action = readEepromCache(EVENT_ACTION(event));
+    AlarmTime();
+    return (action & ACTION_DURATION_M) != 0;
+}
+
+static void checkVisit(uint32_t now)                // pirISR and Wide4ISR after the state machine
+{
+    uint8_t change = motionChange();
+    if(change == VISIT_STARTED)
+    {
+        startVisit(now);
+        if(readEepromCache((16*0)+7) == 2)
+        {
+            sampleSoon();
+        }
+    }
+    else if(change == VISIT_ENDED)
+    {
+        endVisit(now);
+    }
+}
+
+static void pirPath(uint32_t round)                 // A visit: rising edge, presence timeout, falling edge, hold-off timeout
+{
+    uint32_t cycles = MS_TO_CYCLES(round * 10);
+    uint32_t now = HIB_RTCC_R;
+    motionEdge(true, cycles);
+    checkVisit(now);
+    motionTimeout(true);
+    checkVisit(now);
+    motionEdge(false, cycles + MS_TO_CYCLES(DEFAULT_PRESENCE_MS));
+    checkVisit(now + 1);
+    motionTimeout(false);
+    checkVisit(now + 3);
+}
+
+static void setUp()                                 // A stored schedule and settings, then a boot
+{
+    uint16_t event = 0;
+    eraseEepromImage();
+    initEepromCache();
+    writeEepromCache((16*0)+6, 300);                // 300 ml in motion mode, so every path reads its settings
+    writeEepromCache((16*0)+7, 2);
+    for(event = 0; event < EVENTS; event++)
+    {
+        writeEepromCache(EVENT_ACTION(event), 5 | (60 << ACTION_PWM_S));
+        writeEepromCache(EVENT_TIME(event), ((7 * 60) + (event * 45)) | (RULE_DAILY << TIME_RULE_S));
+    }
+    initEepromCache();                              // Boot: the one load of every word
+    initCalibration();
+    initLevelFilter(readEepromCache(SETTING_FILTER));
+    initSampleRate(readEepromCache(SETTING_SAMPLE));
+    initPumpControl(readEepromCache(SETTING_PUMP));
+    initPumpSpeed(readEepromCache(SETTING_PUMP_SPEED));
+    initMotion(readEepromCache(SETTING_MOTION));
+    HIB_RTCC_R = 6 * 3600;
+    initVisits(HIB_RTCC_R);
+    sortEvent();
+}
+
+static void testPaths()
+{
+    uint32_t writes = 0;
+    uint32_t reads = 0;
+    uint32_t writesAfter = 0;
+    uint32_t served = 0;
+    uint32_t round = 0;
+    bool fed = true;
+
+    setUp();
+    reads = eepromReads(&writes);
+    served = cacheReads();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        levelPath(round);
+        fed &= alarmPath();
+        pirPath(round);
+    }
+    served = cacheReads() - served;
+    reads = eepromReads(&writesAfter) - reads;
+    writes = writesAfter - writes;
+    printf("  %d rounds of the level, alarm and PIR paths: %u reads from the cache, %u EEPROM reads, %u writes\n",
+           ROUNDS, (unsigned)served, (unsigned)reads, (unsigned)writes);
+    CHECK(fed);
+    CHECK(served >= 4 * ROUNDS);                    // Mode and volume twice, an event time and action each round
+    CHECK(reads == 0);
+    CHECK(writes == 0);
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testPaths();
+    closeEepromImage();
+    return finishTest("cacheTest");
+}
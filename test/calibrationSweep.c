@@ -0,0 +1,143 @@
+//Sweep of every comparator reading from 0 to 5000 ticks through ticksToLevel with the built-in table,
+//next to the if/else chain analogISR used before it, copied here as it was. Counts the readings the chain
+//dropped to 0 ml inside its own span, checks the table is monotonic and lands on the old levels at the
+//range centres, and times both over the sweep.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+#include "calibration.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/calibrationSweep.img"
+#define SWEEP_TICKS 5000
+#define SPAN_LOW 2000                               // First and last reading the chain had a range for
+#define SPAN_HIGH 3499
+#define ROUNDS 200
+#define SCATTER 2749                                 // Steps the sweep out of order, prime to 5001
+
+static volatile uint32_t sink;
+
+static float legacyLevel(uint32_t time)             // The chain from analogISR
+{
+    float level = 0.0;
+    if(time >= 2000 && time <= 2100)
+    {
+        level = 0;
+    }
+    else if(time >= 2700 && time <= 2775)
+    {
+        level = 50;
+    }
+    else if(time >= 2800 && time <= 2900)
+    {
+        level = 100;
+    }
+    else if(time >= 2901 && time <= 3030)
+    {
+        level = 200;
+    }
+    else if(time >= 3075 && time <= 3150)
+    {
+        level = 300;
+    }
+    else if(time >= 3200 && time <= 3275)
+    {
+        level = 400;
+    }
+    else if(time >= 3276 && time <= 3375)
+    {
+        level = 500;
+    }
+    else if(time >= 3376 && time <= 3499)
+    {
+        level = 600;
+    }
+    else
+    {
+        level = 0;
+    }
+    return level;
+}
+
+static uint32_t tableLevel(uint32_t ticks)
+{
+    return ticksToLevel(ticks);
+}
+
+static uint32_t chainLevel(uint32_t ticks)
+{
+    return (uint32_t)legacyLevel(ticks);
+}
+
+static double timeSweep(uint32_t (*convert)(uint32_t), uint32_t step)   // ns per conversion
+{
+    uint32_t round = 0;
+    uint32_t i = 0;
+    uint64_t start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        for(i = 0; i <= SWEEP_TICKS; i++)
+        {
+            sink = convert((i * step) % (SWEEP_TICKS + 1));
+        }
+    }
+    return (double)(getNanoseconds() - start) / ((double)ROUNDS * (SWEEP_TICKS + 1));
+}
+
+static void testSweep()
+{
+    const uint16_t centres[][2] = {{2050, 0}, {2737, 50}, {2850, 100}, {2965, 200}, {3112, 300}, {3237, 400}, {3325, 500}, {3437, 600}};
+    uint32_t gaps = 0;
+    uint32_t ticks = 0;
+    uint16_t last = 0;
+    bool monotonic = true;
+    bool centred = true;
+    uint8_t i = 0;
+
+    eraseEepromImage();
+    initEepromCache();
+    initCalibration();
+    CHECK(getCalibrationCount() == 8);              // Nothing stored, the built-in table is in use
+
+    last = ticksToLevel(0);
+    for(ticks = 0; ticks <= SWEEP_TICKS; ticks++)
+    {
+        uint16_t level = ticksToLevel(ticks);
+        monotonic &= (level >= last);
+        last = level;
+        if((ticks > 2100) && (ticks <= SPAN_HIGH) && (legacyLevel(ticks) == 0))
+        {
+            gaps++;                                 // Read as an empty bowl, so the pump ran
+        }
+    }
+    for(i = 0; i < sizeof(centres) / sizeof(centres[0]); i++)
+    {
+        centred &= (ticksToLevel(centres[i][0]) == centres[i][1]) && (legacyLevel(centres[i][0]) == centres[i][1]);
+    }
+    printf("  ticks 0-%u: the chain gives 0 ml for %u readings inside %u-%u, the table for none\n",
+           SWEEP_TICKS, (unsigned)gaps, SPAN_LOW, SPAN_HIGH);
+    CHECK(gaps == 716);
+    CHECK(monotonic);
+    CHECK(centred);
+    CHECK(ticksToLevel(SPAN_LOW) == 0);             // Clamped outside the table
+    CHECK(ticksToLevel(SWEEP_TICKS) == 600);
+    CHECK((ticksToLevel(2400) > 0) && (ticksToLevel(2400) < 50));   // Inside the widest old gap
+}
+
+static void testTiming()
+{
+    printf("  ns per conversion, table / float chain: in order %.1f / %.1f, scattered %.1f / %.1f\n",
+           timeSweep(tableLevel, 1), timeSweep(chainLevel, 1), timeSweep(tableLevel, SCATTER), timeSweep(chainLevel, SCATTER));
+    CHECK(sink <= 600);
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testSweep();
+    testTiming();
+    closeEepromImage();
+    return finishTest("calibrationSweep");
+}
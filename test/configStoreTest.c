@@ -0,0 +1,201 @@
+//Config store on the file-backed host EEPROM: the import of the old fixed layout, power cuts part way
+//through writes with a reboot from the image after each one, and ten years of a feeder's daily writes
+//with the wear they leave on every EEPROM block.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "eeprom.h"
+#include "eepromCache.h"
+#include "configStore.h"
+#include "sortEvent.h"
+#include "visits.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/configStore.img"
+#define YEARS 10
+#define CUTS 5000
+#define CUT_KEYS 200                                // Keys the power cut test writes, below STORE_CAPACITY
+
+static uint32_t words[CACHE_WORDS];
+static uint32_t model[CACHE_WORDS];
+
+static void reboot()                                // Power down, write the image out and boot from it
+{
+    closeEepromImage();
+    openEepromImage(IMAGE);
+    initConfigStore(words, CACHE_WORDS);
+}
+
+static bool matchesModel()
+{
+    uint16_t i = 0;
+    for(i = 0; i < CACHE_WORDS; i++)
+    {
+        if(words[i] != model[i])
+        {
+            printf("key %u reads %08X, expected %08X\n", i, (unsigned)words[i], (unsigned)model[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testLegacyImport()                      // Every word of the old layout set, more than the log can hold
+{
+    uint16_t i = 0;
+    bool kept = true;
+    bool dropped = true;
+    STORE_STATS stats;
+
+    eraseEepromImage();
+    for(i = 0; i < EEPROM_WORDS; i++)
+    {
+        writeEeprom(i, 1000 + i);
+    }
+    initConfigStore(words, CACHE_WORDS);
+    getStoreStats(&stats);
+    CHECK(stats.live == STORE_CAPACITY);
+    CHECK(stats.laps == 0);
+
+    reboot();
+    for(i = 0; i < CACHE_WORDS; i++)
+    {
+        kept &= (i >= STORE_CAPACITY) || (words[i] == 1000u + i);
+        dropped &= (i < STORE_CAPACITY) || (words[i] == 0xFFFFFFFF);
+    }
+    CHECK(kept);
+    CHECK(dropped);
+}
+
+static void testPowerCuts()                         // Power fails in one of the next program cycles, often mid-word
+{
+    uint16_t i = 0;
+    uint32_t cut = 0;
+    uint32_t torn = 0;
+    bool consistent = true;
+
+    eraseEepromImage();
+    reboot();
+    for(i = 0; i < CACHE_WORDS; i++)
+    {
+        model[i] = 0xFFFFFFFF;
+    }
+    srand(1);
+    for(cut = 0; (cut < CUTS) && consistent; cut++)
+    {
+        uint16_t key = rand() % CUT_KEYS;
+        uint32_t value = (rand() % 4 == 0) ? 0xFFFFFFFF : (uint32_t)rand();
+        uint32_t old = 0;
+
+        for(i = 0; i < 20; i++)                     // Ordinary writes between the cuts
+        {
+            uint16_t other = rand() % CUT_KEYS;
+            uint32_t data = (rand() % 4 == 0) ? 0xFFFFFFFF : (uint32_t)rand();
+            if(writeConfig(other, data))
+            {
+                model[other] = data;
+            }
+        }
+
+        old = model[key];
+        cutPowerAfter(rand() % 4, (rand() % 2) == 0);
+        writeConfig(key, value);
+        torn += powerFailed();
+        cutPowerAfter(-1, false);
+        reboot();
+
+        consistent = CHECK((words[key] == old) || (words[key] == value));
+        model[key] = words[key];
+        consistent &= CHECK(matchesModel());
+    }
+    printf("  %u power cuts (%u during a write), every reboot replayed the log intact\n", (unsigned)cut, (unsigned)torn);
+}
+
+static void store(uint16_t key, uint32_t value)
+{
+    if(CHECK(writeEepromCache(key, value)))
+    {
+        model[key] = value;
+    }
+}
+
+static void testYears()                             // Hourly visit saves, a one-time treat every day and weekly edits
+{
+    uint32_t day = 0;
+    uint32_t hour = 0;
+    uint16_t i = 0;
+    uint32_t blockMax = 0;
+    uint32_t blockMin = 0xFFFFFFFF;
+    uint32_t wordMax = 0;
+    STORE_STATS stats;
+
+    eraseEepromImage();
+    closeEepromImage();
+    openEepromImage(IMAGE);
+    initEepromCache();
+    for(i = 0; i < CACHE_WORDS; i++)
+    {
+        model[i] = readEepromCache(i);
+    }
+    for(i = 0; i < 8; i++)                          // A daily schedule to start with
+    {
+        store(EVENT_ACTION(i), 10 | (50 << ACTION_PWM_S));
+        store(EVENT_TIME(i), (i * 180) | (RULE_DAILY << TIME_RULE_S));
+    }
+    store((16*0)+6, 300);
+    store((16*0)+7, 1);
+    clearWear();
+
+    for(day = 0; day < YEARS * 365; day++)
+    {
+        for(hour = 0; hour < 24; hour++)            // saveVisits: the bucket of the hour and the newest hour
+        {
+            store(VISIT_BASE + ((hour + 1) % VISIT_HOURS), 0);
+            store(VISIT_BASE + hour, (hour + day) % 7);
+            store(VISIT_HOUR, (day * 24) + hour);
+        }
+        store(EVENT_ACTION(100), 5 | (40 << ACTION_PWM_S));   // A treat is added and cleared after it fires
+        store(EVENT_TIME(100), (day % 1440) | (RULE_ONCE << TIME_RULE_S));
+        store(EVENT_TIME(100), 0xFFFFFFFF);
+        store(EVENT_ACTION(100), 0xFFFFFFFF);
+        if(day % 7 == 0)
+        {
+            store(EVENT_TIME(day % 8), ((day / 7) % 1440) | (RULE_DAILY << TIME_RULE_S));
+            store((16*0)+6, 200 + (day % 200));
+        }
+    }
+
+    reboot();
+    CHECK(matchesModel());
+
+    for(i = 0; i < EEPROM_WORDS; i += BLOCK_WORDS)
+    {
+        uint16_t j = 0;
+        uint32_t block = 0;
+        for(j = 0; j < BLOCK_WORDS; j++)
+        {
+            block += getWordWear(i + j);
+            wordMax = (getWordWear(i + j) > wordMax) ? getWordWear(i + j) : wordMax;
+        }
+        blockMax = (block > blockMax) ? block : blockMax;
+        blockMin = (block < blockMin) ? block : blockMin;
+    }
+    getStoreStats(&stats);
+    printf("  %d years: block wear %u-%u program cycles, worst word %u cycles (%u years to the %u cycle endurance)\n",
+           YEARS, (unsigned)blockMin, (unsigned)blockMax, (unsigned)wordMax,
+           (unsigned)(((uint64_t)EEPROM_ENDURANCE * YEARS) / wordMax), EEPROM_ENDURANCE);
+    CHECK(blockMax - blockMin <= blockMax / 50);    // Within 2 % of each other
+    CHECK(wordMax * 20 < EEPROM_ENDURANCE);         // 200 years at this rate
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testLegacyImport();
+    testPowerCuts();
+    testYears();
+    closeEepromImage();
+    return finishTest("configStoreTest");
+}
@@ -0,0 +1,261 @@
+//Dispatch cost of one command line: the binary search on the first field plus the argument checks that
+//processCommand does, against the old chain of isCommand calls, each a substring scan of the whole line.
+//The command table is read out of src/PetFeeder.c so the benchmark always runs on the real one, and a
+//line for every form of every command has to reach that form. The chain is the old isCommand run over
+//the same table in order, the way the if/else chain in main used to be built.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "getInput.h"
+#include "hostTest.h"
+
+#define SOURCE "../src/PetFeeder.c"
+#define TABLE_MAX 64
+#define ROUNDS 20000
+
+static const char* lines[] =
+{
+    "alert on", "auger 500 5 200 200", "auger", "binary", "calibrate auger test 80", "calibrate 300", "calibrate",
+    "feed 0 10 99 5:10", "feed 0 10 99 5 10", "feed 3 delete", "fill auto", "filter 5 2", "filter", "help",
+    "motion 100 2000", "motion", "portion 0 40 80 5:10", "portion 0 40 80 5 10", "power on", "power",
+    "pump speed 40 100", "pump 20 60 30", "pump", "repeat 0 mon wed fri", "sample 200 10000", "sample",
+    "schedule export", "schedule import begin", "schedule", "setting", "stats", "time 5:10", "time 5 10", "time",
+    "visits", "water 300", "weekday mon"
+};
+#define LINES (sizeof(lines) / sizeof(lines[0]))
+
+static COMMAND table[TABLE_MAX];
+static uint8_t tableCount = 0;
+static uint32_t runs = 0;
+static USER_DATA parsed[LINES];
+
+static void count(USER_DATA* data)                  // Every handler
+{
+    runs++;
+}
+
+static char* nextToken(char** text)                 // A quoted string, NULL or a number, up to the next comma
+{
+    char* start = *text;
+    char* end = NULL;
+    while((*start == ' ') || (*start == '{'))
+    {
+        start++;
+    }
+    if(*start == '"')
+    {
+        start++;
+        end = strchr(start, '"');
+    }
+    else
+    {
+        end = start + strcspn(start, ", ");
+    }
+    if(end == NULL)
+    {
+        return NULL;
+    }
+    *end = '\0';
+    *text = end + 1 + strspn(end + 1, ", ");
+    return start;
+}
+
+static char* copyOf(const char* text)
+{
+    char* copy = malloc(strlen(text) + 1);
+    strcpy(copy, text);
+    return copy;
+}
+
+static bool loadTable()                             // The rows of "const COMMAND commands[]"
+{
+    char line[256];
+    bool inside = false;
+    FILE* file = fopen(SOURCE, "r");
+    if(file == NULL)
+    {
+        return false;
+    }
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        char* text = line + strspn(line, " ");
+        inside = inside || (strstr(line, "COMMAND commands[] =") != NULL);
+        if(inside && (strncmp(text, "};", 2) == 0))
+        {
+            break;
+        }
+        if(inside && (strncmp(text, "{\"", 2) == 0) && (tableCount < TABLE_MAX))
+        {
+            COMMAND* command = &table[tableCount++];
+            char* name = nextToken(&text);
+            char* sub = nextToken(&text);
+            char* minArgs = nextToken(&text);
+            char* maxArgs = nextToken(&text);
+            char* argTypes = nextToken(&text);
+            command->name = copyOf(name);
+            command->sub = (strcmp(sub, "NULL") == 0) ? NULL : copyOf(sub);
+            command->minArgs = atoi(minArgs);
+            command->maxArgs = (strcmp(maxArgs, "ANY_ARGS") == 0) ? ANY_ARGS : atoi(maxArgs);
+            command->argTypes = copyOf(argTypes);
+            command->run = count;
+            command->usage = "";
+        }
+    }
+    fclose(file);
+    return tableCount != 0;
+}
+
+static int16_t dispatch(USER_DATA* data)            // processCommand, returns the row that ran
+{
+    int16_t first = -1;
+    int16_t i = 0;
+    if((data->fieldCount != 0) && (data->fieldType[0] == 'a'))
+    {
+        first = findCommand(table, tableCount, getFieldString(data, 0));
+    }
+    for(i = first; (first >= 0) && (i < tableCount) && (cmpStr(table[i].name, table[first].name) == 0); i++)
+    {
+        if(matchArguments(&table[i], data))
+        {
+            table[i].run(data);
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool legacyIsCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments)   // isCommand before the table
+{
+    uint8_t argCount = (data->fieldCount)-1;  // number of arguments (excluding the command field)
+    uint8_t i;
+    uint8_t index = 0;
+
+    int strSize = 0;
+    while (strCommand[strSize] != '\0')
+    {
+        ++strSize;
+    }
+
+    while (data ->buffer[index] != '\0')
+    {
+        for(i = 0; i < strSize ; i++)
+        {
+            if (data->buffer[index + i] != strCommand[i])
+            {
+                break;
+            }
+        }
+
+        if (i == strSize)
+        {
+            if (argCount >= minArguments)
+            {
+                return 1;  // Command found and has enough arguments
+            }
+            else
+            {
+                return 0;  // Command found but not enough arguments
+            }
+        }
+        index++;
+    }
+    return 0;
+}
+
+static int16_t legacyDispatch(USER_DATA* data)      // if(isCommand(...)) else if ... over the table in order
+{
+    int16_t i = 0;
+    for(i = 0; i < tableCount; i++)
+    {
+        if(legacyIsCommand(data, table[i].name, table[i].minArgs))
+        {
+            table[i].run(data);
+            return i;
+        }
+    }
+    return -1;
+}
+
+static double timeLine(int16_t (*method)(USER_DATA*), USER_DATA* data)   // ns per dispatch
+{
+    uint32_t round = 0;
+    uint64_t start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        method(data);
+    }
+    return (double)(getNanoseconds() - start) / ROUNDS;
+}
+
+static void testTable()
+{
+    uint8_t hits[TABLE_MAX];
+    uint8_t i = 0;
+    bool sorted = true;
+    bool reached = true;
+    bool covered = true;
+
+    CHECK(loadTable());
+    memset(hits, 0, sizeof(hits));
+    for(i = 1; i < tableCount; i++)
+    {
+        sorted &= (strcmp(table[i - 1].name, table[i].name) <= 0);
+    }
+    for(i = 0; i < LINES; i++)
+    {
+        int16_t row = -1;
+        strcpy(parsed[i].buffer, lines[i]);
+        CHECK(parseFields(&parsed[i], MAX_FIELDS) == PARSE_OK);
+        row = dispatch(&parsed[i]);
+        reached &= (row >= 0) && (strcmp(table[row].name, getFieldString(&parsed[i], 0)) == 0);
+        if(row >= 0)
+        {
+            hits[row]++;
+        }
+    }
+    for(i = 0; i < tableCount; i++)
+    {
+        covered &= (hits[i] != 0);
+        if(hits[i] == 0)
+        {
+            printf("  no line for \"%s\" with %u to %u arguments\n", table[i].name, table[i].minArgs, table[i].maxArgs);
+        }
+    }
+    CHECK(sorted);                                  // findCommand needs it
+    CHECK(reached);
+    CHECK(covered);                                 // Every form has its line
+    CHECK(runs == LINES);
+}
+
+static void testCost()
+{
+    uint8_t i = 0;
+    uint8_t misrouted = 0;
+    double tableNs = 0;
+    double chainNs = 0;
+
+    printf("  %u commands in %u forms, ns per line, table / if-chain:\n", (unsigned)(LINES), tableCount);
+    for(i = 0; i < LINES; i++)
+    {
+        double lineTable = timeLine(dispatch, &parsed[i]);
+        double lineChain = timeLine(legacyDispatch, &parsed[i]);
+        int16_t legacy = legacyDispatch(&parsed[i]);
+        bool wrong = (legacy < 0) || (legacy != dispatch(&parsed[i]));
+        misrouted += wrong;
+        tableNs += lineTable;
+        chainNs += lineChain;
+        printf("  %-24s %6.1f / %6.1f%s\n", lines[i], lineTable, lineChain, wrong ? "   chain runs another form" : "");
+    }
+    printf("  average %.1f / %.1f ns, the chain runs the wrong form for %u of %u lines\n",
+           tableNs / LINES, chainNs / LINES, misrouted, (unsigned)LINES);
+    CHECK(misrouted != 0);                          // What the table fixed: substring matches and first-fit
+}
+
+int main()
+{
+    testTable();
+    testCost();
+    return finishTest("dispatchBenchmark");
+}
@@ -0,0 +1,211 @@
+//Energy per day of the feeder with and without hibernation. A day is stepped one second at a time with
+//the firmware's wake-up rules: the next feed comes from the real scheduler, AUTO mode wakes for each
+//water sample at the period sampleRate.c picks for a steady bowl, and a PIR edge on the WAKE pin brings
+//the core up in any mode. Awake time after each kind of wake-up, the shortest hibernation and the hour
+//cap are those of lowPower.h, and the currents are the ones "power" estimates with. The awake core is
+//taken to run a small share of the time and sleep in WFI for the rest.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "eepromCache.h"
+#include "sortEvent.h"
+#include "sampleRate.h"
+#include "lowPower.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/energyModel.img"
+#define DAY 86400
+#define START (DAY * 3)                             // Midnight, a few days after the clock was set
+#define FEED_S 5                                    // Auger run of each feed
+#define VISIT_S 30                                  // Pet at the bowl, PIR high
+#define ACTIVE_PERMILLE 50                          // Share of awake time not spent in WFI
+#define SUPPLY_MV 3300
+#define VISITS_MAX 64
+
+typedef struct _SCENARIO
+{
+    const char* name;
+    bool hibernate;                                 // "power on"
+    uint8_t mode;                                   // Water fill mode, 1 = AUTO
+    uint32_t sampleSetting;                         // "sample" word, erased for the defaults
+    uint8_t feeds;
+    uint8_t visits;
+} SCENARIO;
+
+typedef struct _DAY_MODEL
+{
+    uint32_t awake;                                 // Seconds
+    uint32_t asleep;
+    uint32_t wakes;                                 // Hibernations ended
+    uint32_t longestSleep;
+    uint32_t averageUa;
+    uint32_t mwh;                                   // Tenths of a mWh per day
+} DAY_MODEL;
+
+static uint32_t visitStart[VISITS_MAX];
+
+static void storeFeeds(uint8_t feeds)               // Evenly over the day from 07:00
+{
+    uint16_t event = 0;
+    eraseEepromImage();
+    initEepromCache();
+    HIB_RTCC_R = START;
+    for(event = 0; event < feeds; event++)
+    {
+        writeEepromCache(EVENT_ACTION(event), FEED_S | (60 << ACTION_PWM_S));
+        writeEepromCache(EVENT_TIME(event), ((7 * 60) + (event * ((14 * 60) / feeds))) | (RULE_DAILY << TIME_RULE_S));
+    }
+    sortEvent();
+}
+
+static void placeVisits(uint8_t visits)             // Made up, at any time of day
+{
+    uint32_t seed = 12345;
+    uint8_t i = 0;
+    for(i = 0; i < visits; i++)
+    {
+        seed = (seed * 1103515245) + 12345;
+        visitStart[i] = START + ((seed >> 8) % (DAY - VISIT_S));
+    }
+}
+
+static bool visitAt(uint8_t visits, uint32_t t, uint32_t* end)   // A visit starts at t
+{
+    uint8_t i = 0;
+    for(i = 0; i < visits; i++)
+    {
+        if(visitStart[i] == t)
+        {
+            *end = t + VISIT_S;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t nextVisit(uint8_t visits, uint32_t after)
+{
+    uint32_t next = 0xFFFFFFFF;
+    uint8_t i = 0;
+    for(i = 0; i < visits; i++)
+    {
+        if((visitStart[i] > after) && (visitStart[i] < next))
+        {
+            next = visitStart[i];
+        }
+    }
+    return next;
+}
+
+static void runDay(const SCENARIO* scenario, DAY_MODEL* day)
+{
+    uint32_t t = START;
+    uint32_t awakeUntil = START + CONSOLE_AWAKE_S;  // Power-up
+    uint32_t busyUntil = START;                     // Feed or visit running
+    uint32_t sample = START;
+    uint64_t awakeUa = 0;
+
+    storeFeeds(scenario->feeds);
+    initSampleRate(scenario->sampleSetting);
+    placeVisits(scenario->visits);
+    day->awake = 0;
+    day->asleep = 0;
+    day->wakes = 0;
+    day->longestSleep = 0;
+
+    while(t < START + DAY)
+    {
+        uint32_t end = 0;
+        uint32_t wake = 0xFFFFFFFF;
+        HIB_RTCC_R = t;
+        if((getEventCount() != 0) && (getNextFireTime() <= t))   // startFeed
+        {
+            rescheduleEvent(getNextEvent());
+            busyUntil = (t + FEED_S > busyUntil) ? t + FEED_S : busyUntil;
+        }
+        if(visitAt(scenario->visits, t, &end))
+        {
+            busyUntil = (end > busyUntil) ? end : busyUntil;
+        }
+        if(t >= sample)                             // Timer 1 runs whenever the core does
+        {
+            sample = t + (nextSamplePeriod(300, 300, false) + 999) / 1000;
+        }
+
+        if(scenario->hibernate && (t >= awakeUntil) && (t >= busyUntil))   // readyToHibernate, then enterLowPower
+        {
+            wake = (getEventCount() != 0) ? getNextFireTime() : 0xFFFFFFFF;
+            if((scenario->mode == 1) && (sample < wake))
+            {
+                wake = sample;
+            }
+            if((wake == 0xFFFFFFFF) || (wake >= t + MIN_HIBERNATE_S))
+            {
+                uint32_t pir = nextVisit(scenario->visits, t);
+                bool pinWake = false;
+                wake = (wake - t > MAX_HIBERNATE_S) ? t + MAX_HIBERNATE_S : wake;
+                pinWake = (pir < wake);
+                wake = pinWake ? pir : wake;
+                wake = (wake > START + DAY) ? START + DAY : wake;
+                day->asleep += wake - t;
+                day->longestSleep = (wake - t > day->longestSleep) ? wake - t : day->longestSleep;
+                day->wakes++;
+                t = wake;                           // A reboot: samples start again from initModules
+                sample = t;
+                awakeUntil = t + (pinWake ? CONSOLE_AWAKE_S : WAKE_AWAKE_S);
+                continue;
+            }
+        }
+        day->awake++;
+        t++;
+    }
+    awakeUa = (((uint64_t)ACTIVE_PERMILLE * RUN_UA) + ((uint64_t)(1000 - ACTIVE_PERMILLE) * SLEEP_UA)) / 1000;
+    day->averageUa = (uint32_t)(((awakeUa * day->awake) + ((uint64_t)HIBERNATE_UA * day->asleep)) / DAY);
+    day->mwh = (uint32_t)(((uint64_t)day->averageUa * 24 * SUPPLY_MV) / 100000);
+}
+
+static void testDays()
+{
+    const SCENARIO scenarios[] =
+    {
+        {"always awake", false, 1, 0xFFFFFFFF, 3, 40},
+        {"feeds only", true, 0, 0xFFFFFFFF, 3, 0},
+        {"feeds, visits", true, 0, 0xFFFFFFFF, 3, 40},
+        {"AUTO water", true, 1, 0xFFFFFFFF, 3, 40},
+        {"AUTO, 60 s max", true, 1, (6000 << SAMPLE_MAX_S) | 20, 3, 40},
+        {"nothing at all", true, 0, 0xFFFFFFFF, 0, 0}
+    };
+    DAY_MODEL days[sizeof(scenarios) / sizeof(scenarios[0])];
+    uint8_t i = 0;
+
+    printf("  %-16s %8s %6s %8s %8s %10s\n", "", "awake s", "duty", "wakes", "avg uA", "mWh/day");
+    for(i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        runDay(&scenarios[i], &days[i]);
+        printf("  %-16s %8u %5u%% %8u %8u %8u.%u\n", scenarios[i].name, (unsigned)days[i].awake,
+               (unsigned)((days[i].awake * 100) / DAY), (unsigned)days[i].wakes, (unsigned)days[i].averageUa,
+               (unsigned)(days[i].mwh / 10), (unsigned)(days[i].mwh % 10));
+    }
+    CHECK(days[0].awake == DAY);
+    CHECK(days[1].mwh * 50 < days[0].mwh);          // Hibernating between feeds saves over 98 %
+    CHECK(days[2].mwh > days[1].mwh);               // Every visit costs a console wake
+    CHECK(days[3].mwh > days[2].mwh);               // A wake for every sample
+    CHECK(days[4].mwh < days[3].mwh);               // Fewer with a longer steady period
+    CHECK(days[5].wakes == DAY / MAX_HIBERNATE_S);  // The hour cap
+    CHECK(days[5].longestSleep == MAX_HIBERNATE_S);
+    CHECK(days[1].awake <= CONSOLE_AWAKE_S + 3 * FEED_S + (days[1].wakes * WAKE_AWAKE_S));   // Power-up, the feeds, the RTC wakes
+    for(i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        CHECK((days[i].awake + days[i].asleep == DAY) && (days[i].longestSleep <= MAX_HIBERNATE_S));
+    }
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testDays();
+    closeEepromImage();
+    return finishTest("energyModel");
+}
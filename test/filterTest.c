@@ -0,0 +1,228 @@
+//Replays water level tick traces through the burst filter and reports, for each filter configuration,
+//how often the filtered reading drops below a trigger threshold while the bowl is really above it (a
+//pump start the sensor noise caused) and how many cycles it takes to follow a real drop. A trace holds
+//one line per sampling cycle with up to MAX_BURST back-to-back readings; a burst of n uses the first n.
+//Without arguments two traces are made up here: a steady bowl with noise and spikes, and the same bowl
+//draining across the threshold. Recorded traces are replayed with "filterTest trace threshold ...",
+//where every trigger counts as false, so record them with nobody at the bowl.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "levelFilter.h"
+#include "hostTest.h"
+
+#define CYCLES 5000
+#define LEVEL 3000                                  // Ticks of the made-up bowl
+#define THRESHOLD 2950
+#define NOISE 16                                    // Spread of the readings either side
+#define SPIKE_PERCENT 3                             // Readings thrown off by the pet or sloshing,
+#define SPIKE_TICKS 400                             // up to this far
+#define DRAIN_START 1000                            // Cycle the drain trace starts falling, 1 tick a cycle
+#define MAX_FALSE_DEFAULT 0                         // The default filter must not chatter on the steady bowl
+
+typedef struct _TRACE
+{
+    const char* name;
+    uint16_t cycles;
+    uint8_t width;                                  // Readings per cycle
+    uint32_t threshold;
+    uint32_t (*readings)[MAX_BURST];
+    uint32_t* truth;                                // NULL when not known: every trigger is false
+} TRACE;
+
+typedef struct _RESULT
+{
+    uint32_t falseTriggers;
+    int32_t delay;                                  // Cycles from the real crossing to the trigger, -1 when none
+} RESULT;
+
+static const uint8_t configs[][2] = {{1, 0}, {3, 0}, {5, 0}, {5, 2}, {9, 2}, {9, 4}};
+#define CONFIGS (sizeof(configs) / sizeof(configs[0]))
+
+static uint32_t seed = 1;
+static uint32_t steadyReadings[CYCLES][MAX_BURST];
+static uint32_t steadyTruth[CYCLES];
+static uint32_t drainReadings[CYCLES][MAX_BURST];
+static uint32_t drainTruth[CYCLES];
+
+static uint32_t randomBelow(uint32_t limit)
+{
+    seed = (seed * 1103515245) + 12345;
+    return (seed >> 8) % limit;
+}
+
+static uint32_t measure(uint32_t truth)             // Roughly normal noise, and now and then a spike either way
+{
+    int32_t noise = randomBelow(NOISE + 1) + randomBelow(NOISE + 1) + randomBelow(NOISE + 1) + randomBelow(NOISE + 1) - (2 * NOISE);
+    if(randomBelow(100) < SPIKE_PERCENT)
+    {
+        noise += (randomBelow(2) ? 1 : -1) * (int32_t)(SPIKE_TICKS / 2 + randomBelow(SPIKE_TICKS / 2));
+    }
+    return truth + noise;
+}
+
+static void makeTrace(uint32_t (*readings)[MAX_BURST], uint32_t* truth, bool drain)
+{
+    uint16_t cycle = 0;
+    uint8_t i = 0;
+    for(cycle = 0; cycle < CYCLES; cycle++)
+    {
+        truth[cycle] = (drain && (cycle > DRAIN_START)) ? LEVEL - (cycle - DRAIN_START) : LEVEL;
+        truth[cycle] = (truth[cycle] < LEVEL - 300) ? LEVEL - 300 : truth[cycle];
+        for(i = 0; i < MAX_BURST; i++)
+        {
+            readings[cycle][i] = measure(truth[cycle]);
+        }
+    }
+}
+
+static RESULT replay(const TRACE* trace, uint8_t burst, uint8_t shift)
+{
+    RESULT result = {0, -1};
+    uint16_t cycle = 0;
+    uint8_t i = 0;
+    bool below = false;
+    int32_t crossed = -1;                           // Cycle the truth went below the threshold
+
+    initLevelFilter(getFilterSetting(burst, shift));
+    for(cycle = 0; cycle < trace->cycles; cycle++)
+    {
+        for(i = 0; (i < burst) && !addSample(trace->readings[cycle][i]); i++);
+        if((trace->truth != NULL) && (crossed < 0) && (trace->truth[cycle] < trace->threshold))
+        {
+            crossed = cycle;
+        }
+        if(!below && (getFilteredTicks() < trace->threshold))  // A pump start, after the real crossing only the first counts
+        {
+            if(crossed < 0)
+            {
+                result.falseTriggers++;
+            }
+            else if(result.delay < 0)
+            {
+                result.delay = cycle - crossed;
+            }
+        }
+        below = getFilteredTicks() < trace->threshold;
+    }
+    return result;
+}
+
+static void report(const TRACE* trace, RESULT results[CONFIGS])
+{
+    uint8_t c = 0;
+    printf("  %s, %u cycles, threshold %u ticks\n  burst  shift   false triggers   per 1000 cycles   delay\n",
+           trace->name, trace->cycles, (unsigned)trace->threshold);
+    for(c = 0; c < CONFIGS; c++)
+    {
+        if(configs[c][0] > trace->width)
+        {
+            continue;
+        }
+        results[c] = replay(trace, configs[c][0], configs[c][1]);
+        printf("  %5u  %5u   %14u   %15.1f   ", configs[c][0], configs[c][1], (unsigned)results[c].falseTriggers,
+               results[c].falseTriggers * 1000.0 / trace->cycles);
+        if(results[c].delay >= 0)
+        {
+            printf("%d cycles\n", (int)results[c].delay);
+        }
+        else
+        {
+            printf("-\n");
+        }
+    }
+}
+
+static uint8_t configIndex(uint8_t burst, uint8_t shift)
+{
+    uint8_t c = 0;
+    while((configs[c][0] != burst) || (configs[c][1] != shift))
+    {
+        c++;
+    }
+    return c;
+}
+
+static void testMadeUp()
+{
+    RESULT steady[CONFIGS];
+    RESULT drain[CONFIGS];
+    TRACE trace = {"steady bowl", CYCLES, MAX_BURST, THRESHOLD, steadyReadings, steadyTruth};
+    uint8_t c = 0;
+
+    makeTrace(steadyReadings, steadyTruth, false);
+    makeTrace(drainReadings, drainTruth, true);
+    report(&trace, steady);
+    trace.name = "draining bowl";
+    trace.readings = drainReadings;
+    trace.truth = drainTruth;
+    report(&trace, drain);
+
+    c = configIndex(DEFAULT_BURST, DEFAULT_EMA_SHIFT);
+    CHECK(steady[configIndex(1, 0)].falseTriggers > 0);     // A single reading chatters
+    CHECK(steady[c].falseTriggers <= MAX_FALSE_DEFAULT);
+    CHECK(drain[c].falseTriggers <= MAX_FALSE_DEFAULT);
+    CHECK((drain[c].delay >= 0) && (drain[c].delay <= 10));  // and still follows a real drop within 10 cycles
+    for(c = 0; c < CONFIGS; c++)
+    {
+        CHECK(drain[c].delay >= 0);
+    }
+}
+
+static bool loadTrace(TRACE* trace, const char* path)  // One line per cycle, readings separated by spaces
+{
+    static uint32_t readings[CYCLES][MAX_BURST];
+    char line[160];
+    FILE* file = fopen(path, "r");
+    if(file == NULL)
+    {
+        return false;
+    }
+    trace->name = path;
+    trace->cycles = 0;
+    trace->width = MAX_BURST;
+    trace->readings = readings;
+    trace->truth = NULL;
+    while((trace->cycles < CYCLES) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        char* text = line;
+        char* end = NULL;
+        uint8_t count = 0;
+        while(count < MAX_BURST)
+        {
+            uint32_t value = strtoul(text, &end, 10);
+            if(end == text)
+            {
+                break;
+            }
+            readings[trace->cycles][count++] = value;
+            text = end;
+        }
+        if(count != 0)
+        {
+            trace->width = (count < trace->width) ? count : trace->width;
+            trace->cycles++;
+        }
+    }
+    fclose(file);
+    return trace->cycles != 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int i = 0;
+    testMadeUp();
+    for(i = 1; i + 1 < argc; i += 2)                // Recorded traces and their thresholds
+    {
+        RESULT results[CONFIGS];
+        TRACE trace = {argv[i], 0, 0, 0, NULL, NULL};
+        CHECK(loadTrace(&trace, argv[i]));
+        trace.threshold = strtoul(argv[i + 1], NULL, 10);
+        if(trace.cycles != 0)
+        {
+            report(&trace, results);
+        }
+    }
+    return finishTest("filterTest");
+}
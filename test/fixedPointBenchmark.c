@@ -0,0 +1,142 @@
+//The two conversions that used float before fixedPoint.h, written both ways: the auger duty from the
+//0-100 speed, as startFeed had it with a double, and the level between two calibration points with a
+//float slope. Checks the fixed-point results against the float ones and times them. The cycle counts and
+//code size the Cortex-M4F would show need the ARM toolchain; here the sizes are those of the host -Os
+//object, which the Makefile passes in from nm.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fixedPoint.h"
+#include "initModules.h"
+#include "hostTest.h"
+
+#define ROUNDS 2000000
+#define SEGMENTS 7
+
+// Segments of the built-in calibration table
+static const uint16_t pointTicks[SEGMENTS + 1] = {2050, 2737, 2850, 2965, 3112, 3237, 3325, 3437};
+static const uint16_t pointMl[SEGMENTS + 1] = {0, 50, 100, 200, 300, 400, 500, 600};
+static float floatSlope[SEGMENTS];
+static q16_t fixedSlope[SEGMENTS];
+
+static volatile uint32_t sink;
+
+__attribute__((noinline)) uint16_t floatDuty(uint16_t pwm)   // The old startFeed
+{
+    float speed = 0;
+    speed = (pwm/100.0)*1023;
+    return speed;
+}
+
+__attribute__((noinline)) uint16_t fixedDuty(uint16_t pwm)
+{
+    return Q16_SCALE(Q16_RATIO(pwm, 100), PWM_FULL);
+}
+
+__attribute__((noinline)) uint16_t floatLevel(uint8_t segment, uint32_t ticks)
+{
+    return pointMl[segment] + (floatSlope[segment] * ((int32_t)ticks - pointTicks[segment])) + 0.5f;
+}
+
+__attribute__((noinline)) uint16_t fixedLevel(uint8_t segment, uint32_t ticks)
+{
+    return pointMl[segment] + Q16_SCALE(fixedSlope[segment], (int32_t)ticks - pointTicks[segment]);
+}
+
+static double timeDuty(uint16_t (*duty)(uint16_t))  // ns per call
+{
+    uint32_t round = 0;
+    uint64_t start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        sink = duty(round % 101);
+    }
+    return (double)(getNanoseconds() - start) / ROUNDS;
+}
+
+static double timeLevel(uint16_t (*level)(uint8_t, uint32_t))
+{
+    uint32_t round = 0;
+    uint64_t start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        uint8_t segment = round % SEGMENTS;
+        sink = level(segment, pointTicks[segment] + (round % (pointTicks[segment + 1] - pointTicks[segment])));
+    }
+    return (double)(getNanoseconds() - start) / ROUNDS;
+}
+
+static void testResults()
+{
+    uint16_t pwm = 0;
+    uint16_t worstDuty = 0;
+    uint32_t levels = 0;
+    uint32_t differ = 0;
+    uint16_t worstLevel = 0;
+    uint8_t segment = 0;
+
+    for(pwm = 0; pwm <= 100; pwm++)
+    {
+        uint16_t difference = abs((int)fixedDuty(pwm) - (int)floatDuty(pwm));
+        worstDuty = (difference > worstDuty) ? difference : worstDuty;
+    }
+    for(segment = 0; segment < SEGMENTS; segment++)
+    {
+        uint32_t ticks = 0;
+        floatSlope[segment] = (float)(pointMl[segment + 1] - pointMl[segment]) / (pointTicks[segment + 1] - pointTicks[segment]);
+        fixedSlope[segment] = Q16_RATIO((int32_t)pointMl[segment + 1] - pointMl[segment], pointTicks[segment + 1] - pointTicks[segment]);
+        for(ticks = pointTicks[segment]; ticks <= pointTicks[segment + 1]; ticks++)
+        {
+            uint16_t difference = abs((int)fixedLevel(segment, ticks) - (int)floatLevel(segment, ticks));
+            worstLevel = (difference > worstLevel) ? difference : worstLevel;
+            differ += (difference != 0);
+            levels++;
+        }
+    }
+    printf("  duty 0-100 %%: at most %u count of 1023 apart (rounded against truncated)\n", worstDuty);
+    printf("  level over the built-in table: %u of %u readings differ, by at most %u ml\n", (unsigned)differ, (unsigned)levels, worstLevel);
+    CHECK(worstDuty <= 1);
+    CHECK(fixedDuty(100) == PWM_FULL);
+    CHECK(fixedDuty(0) == 0);
+    CHECK(worstLevel <= 1);                         // Halves that round the other way
+    CHECK(differ * 100 < levels);
+}
+
+static void testTiming()
+{
+    printf("  ns per call, fixed / float: duty %.2f / %.2f, level %.2f / %.2f\n",
+           timeDuty(fixedDuty), timeDuty(floatDuty), timeLevel(fixedLevel), timeLevel(floatLevel));
+    CHECK(sink <= PWM_FULL);
+}
+
+static uint32_t symbolSize(int argc, char* argv[], const char* name)   // From "name:hex size" arguments
+{
+    int i = 0;
+    size_t length = strlen(name);
+    for(i = 1; i < argc; i++)
+    {
+        if((strncmp(argv[i], name, length) == 0) && (argv[i][length] == ':'))
+        {
+            return strtoul(&argv[i][length + 1], NULL, 16);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    testResults();
+    testTiming();
+    if(argc > 1)                                    // Sizes from nm, see the Makefile
+    {
+        uint32_t fixedBytes = symbolSize(argc, argv, "fixedDuty") + symbolSize(argc, argv, "fixedLevel");
+        uint32_t floatBytes = symbolSize(argc, argv, "floatDuty") + symbolSize(argc, argv, "floatLevel");
+        printf("  host -Os bytes, duty and level: fixed %u + %u, float %u + %u\n",
+               (unsigned)symbolSize(argc, argv, "fixedDuty"), (unsigned)symbolSize(argc, argv, "fixedLevel"),
+               (unsigned)symbolSize(argc, argv, "floatDuty"), (unsigned)symbolSize(argc, argv, "floatLevel"));
+        CHECK((fixedBytes != 0) && (floatBytes != 0));
+    }
+    return finishTest("fixedPointBenchmark");
+}
@@ -0,0 +1,161 @@
+//printUart0 against snprintf into a stack buffer and putsUart0, the way the firmware printed before.
+//Every conversion the formatter supports is checked against the libc snprintf first, the fixed-point
+//decimals against the text the float printf gave. Then the ns per call of the two on lines the feeder
+//prints, and, when "make" passes them, the host text bytes of format.c and of the libc printf objects
+//snprintf links in, which is what leaving snprintf out of the link saves.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "uart0.h"
+#include "format.h"
+#include "hostConsole.h"
+#include "hostTest.h"
+
+#define ROUNDS 200000
+
+static char text[128];
+static uint8_t length = 0;
+
+static void put(char c)
+{
+    if(length < sizeof(text) - 1)
+    {
+        text[length++] = c;
+    }
+}
+
+static const char* format(const char* format, ...)   // formatText into text
+{
+    va_list args;
+    va_start(args, format);
+    length = 0;
+    formatText(put, format, args);
+    text[length] = '\0';
+    va_end(args);
+    return text;
+}
+
+static void testSame()                              // Conversion by conversion against snprintf
+{
+    const char* formats[] = {"%d", "%u", "%x", "%X", "%5d", "%05d", "%3d%%", "%02d:%02d", "%d\t%s"};
+    const int values[] = {0, 1, -1, 42, -42, 12345, 2147483647, (int)0x80000000, 255};
+    char expected[128];
+    uint8_t i = 0;
+    uint8_t j = 0;
+    uint8_t wrong = 0;
+    for(i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        for(j = 0; j < sizeof(values) / sizeof(values[0]); j++)
+        {
+            bool string = (strchr(formats[i], 's') != NULL);
+            if(string)
+            {
+                snprintf(expected, sizeof(expected), formats[i], values[j], "g");
+                format(formats[i], values[j], "g");
+            }
+            else
+            {
+                snprintf(expected, sizeof(expected), formats[i], values[j], values[(j + 1) % 9]);
+                format(formats[i], values[j], values[(j + 1) % 9]);
+            }
+            if(strcmp(expected, text) != 0)
+            {
+                printf("  \"%s\" of %d gave \"%s\", snprintf \"%s\"\n", formats[i], values[j], text, expected);
+                wrong++;
+            }
+        }
+    }
+    CHECK(wrong == 0);
+    CHECK(strcmp(format("%.1u", 123u), "12.3") == 0);   // Fixed point, as %.1f of 12.3
+    CHECK(strcmp(format("%.3u", 5u), "0.005") == 0);
+    CHECK(strcmp(format("%.3d", -5), "-0.005") == 0);
+    CHECK(strcmp(format("%.2d", 0), "0.00") == 0);
+    CHECK(strcmp(format("%.1u%%", 1000u), "100.0%") == 0);
+    CHECK(strcmp(format("%s %c", "ab", 'c'), "ab c") == 0);
+    CHECK(strcmp(format("%lu", 7ul), "7") == 0);
+}
+
+static double timePrint(uint8_t line, bool legacy)  // ns per line onto the host console
+{
+    char str[60];                                   // The old stack buffer
+    uint32_t round = 0;
+    uint64_t start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        uint32_t n = round & 0x3F;
+        clearConsole();
+        if(line == 0)
+        {
+            if(legacy)
+            {
+                snprintf(str, sizeof(str), "Real Time is %02d:%02d\n", (int)(n % 24), (int)n);
+                putsUart0(str);
+            }
+            else
+            {
+                printUart0("Real Time is %02d:%02d\n", n % 24, n);
+            }
+        }
+        else if(line == 1)
+        {
+            if(legacy)
+            {
+                snprintf(str, sizeof(str), "  %d\t    %02d \t\t%02d\t %02d:%02d\n", (int)(n & 31), (int)n, 50, (int)(n % 24), (int)n);
+                putsUart0(str);
+            }
+            else
+            {
+                printUart0("  %d\t    %02d \t\t%02d\t %02d:%02d\n", n & 31, n, 50, n % 24, n);
+            }
+        }
+        else
+        {
+            if(legacy)
+            {
+                snprintf(str, sizeof(str), "Idle = %.1f%%, level %.2f ml\n", (n * 10 + 3) / 10.0, (n * 100 + 25) / 100.0);
+                putsUart0(str);
+            }
+            else
+            {
+                printUart0("Idle = %.1u%%, level %.2u ml\n", n * 10 + 3, n * 100 + 25);
+            }
+        }
+    }
+    return (double)(getNanoseconds() - start) / ROUNDS;
+}
+
+static void testCost()
+{
+    const char* names[] = {"time", "event row", "fixed point"};
+    char printed[128];
+    uint8_t line = 0;
+    for(line = 0; line < 3; line++)                 // Both print the same text
+    {
+        timePrint(line, false);
+        strcpy(printed, getConsole());
+        timePrint(line, true);
+        CHECK(strcmp(printed, getConsole()) == 0);
+    }
+    printf("  ns per line, printUart0 / snprintf and putsUart0:\n");
+    for(line = 0; line < 3; line++)
+    {
+        double now = timePrint(line, false);
+        double legacy = timePrint(line, true);
+        printf("  %-12s %6.1f / %6.1f\n", names[line], now, legacy);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testSame();
+    testCost();
+    if(argc == 3)                                   // Text bytes from size, see the Makefile
+    {
+        printf("  host text bytes, format.c %s, the libc printf objects %s\n", argv[1], argv[2]);
+        CHECK(atol(argv[1]) < atol(argv[2]));
+    }
+    return finishTest("formatBenchmark");
+}
@@ -0,0 +1,199 @@
+//Scheduler heap at 10, 100 and as many daily events as the EEPROM log can hold (the heap itself takes
+//MAX_EVENTS): the cost of insert, delete and pop-next, the order events come out in against one worked
+//out here from their HH:MM, the fire-order walk used by "schedule", and the RTC match AlarmTime leaves.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "tm4c123gh6pm.h"
+#include "eepromCache.h"
+#include "sortEvent.h"
+#include "AlarmTIme.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/heapTest.img"
+#define START ((3 * SECONDS_PER_DAY) + (10 * 3600))     // RTC at day 3, 10:00
+#define OPERATIONS 100000                               // Per measurement, spread over rounds of n events
+
+static uint32_t expected[MAX_EVENTS];                   // Fire time worked out from the record
+
+static uint32_t dailyFire(uint16_t minutes, uint32_t now)
+{
+    uint32_t fire = (now - (now % SECONDS_PER_DAY)) + (minutes * 60);
+    return (fire < now) ? fire + SECONDS_PER_DAY : fire;
+}
+
+static uint16_t storeEvents(uint16_t n)                 // n daily events at random times, none scheduled yet
+{
+    uint16_t event = 0;
+    HIB_RTCC_R = START;
+    for(event = 0; event < MAX_EVENTS; event++)
+    {
+        removeEvent(event);
+        writeEepromCache(EVENT_TIME(event), 0xFFFFFFFF);
+    }
+    for(event = 0; event < n; event++)
+    {
+        uint16_t minutes = rand() % (24 * 60);
+        if(!writeEepromCache(EVENT_ACTION(event), 10 | (50 << ACTION_PWM_S))
+           || !writeEepromCache(EVENT_TIME(event), minutes | (RULE_DAILY << TIME_RULE_S)))
+        {
+            writeEepromCache(EVENT_ACTION(event), 0xFFFFFFFF);
+            break;                                      // The log is full
+        }
+        expected[event] = dailyFire(minutes, START);
+    }
+    return event;
+}
+
+static bool before(uint16_t a, uint16_t b)              // Heap order: fire time, then event number
+{
+    return (expected[a] < expected[b]) || ((expected[a] == expected[b]) && (a < b));
+}
+
+static bool walkInOrder(uint16_t n)                     // Every event once, each one not before the last
+{
+    uint16_t listed = 0;
+    uint16_t last = NO_EVENT;
+    uint16_t event = NO_EVENT;
+    bool ordered = true;
+    startEventWalk();
+    while((event = nextWalkEvent()) != NO_EVENT)
+    {
+        ordered &= (event < n) && ((last == NO_EVENT) || before(last, event));
+        last = event;
+        listed++;
+    }
+    return ordered && (listed == n);
+}
+
+static uint16_t earliest(uint16_t n)                    // The event the heap should have on top
+{
+    uint16_t event = 0;
+    uint16_t best = NO_EVENT;
+    for(event = 0; event < n; event++)
+    {
+        if(eventScheduled(event) && ((best == NO_EVENT) || before(event, best)))
+        {
+            best = event;
+        }
+    }
+    return best;
+}
+
+static void measure(uint16_t n)
+{
+    uint32_t rounds = OPERATIONS / n;
+    uint32_t round = 0;
+    uint16_t i = 0;
+    uint16_t order[MAX_EVENTS];
+    uint64_t insertNs = 0;
+    uint64_t deleteNs = 0;
+    uint64_t popNs = 0;
+    uint64_t walkNs = 0;
+    uint64_t start = 0;
+    bool popOrder = true;
+    bool topRight = true;
+
+    for(round = 0; round < rounds; round++)
+    {
+        storeEvents(n);
+        start = getNanoseconds();
+        for(i = 0; i < n; i++)
+        {
+            insertEvent(i);
+        }
+        insertNs += getNanoseconds() - start;
+
+        start = getNanoseconds();
+        startEventWalk();
+        while(nextWalkEvent() != NO_EVENT);
+        walkNs += getNanoseconds() - start;
+
+        for(i = 0; i < n; i++)                          // Deleted in a random order
+        {
+            uint16_t j = rand() % (i + 1);
+            order[i] = order[j];
+            order[j] = i;
+        }
+        start = getNanoseconds();
+        for(i = 0; i < n; i++)
+        {
+            removeEvent(order[i]);
+        }
+        deleteNs += getNanoseconds() - start;
+    }
+
+    storeEvents(n);                                     // Pop-next: the top fires and moves to tomorrow
+    for(i = 0; i < n; i++)
+    {
+        insertEvent(i);
+    }
+    CHECK(getEventCount() == n);
+    CHECK(walkInOrder(n));
+    for(i = 0; i < n; i++)                              // One day of feeds against the reference order
+    {
+        uint16_t top = getNextEvent();
+        popOrder &= (top == earliest(n)) && (getNextFireTime() == expected[top]);
+        HIB_RTCC_R = getNextFireTime();
+        rescheduleEvent(top);
+        expected[top] += SECONDS_PER_DAY;
+    }
+    CHECK(popOrder);
+    start = getNanoseconds();
+    for(round = 0; round < rounds * n; round++)
+    {
+        uint16_t top = getNextEvent();
+        HIB_RTCC_R = getNextFireTime();
+        rescheduleEvent(top);
+    }
+    popNs = getNanoseconds() - start;
+    for(i = 0; i < n; i++)
+    {
+        expected[i] += rounds * SECONDS_PER_DAY;
+    }
+    CHECK(walkInOrder(n));
+
+    for(i = 0; i < n; i++)                              // Delete from the middle keeps the top right
+    {
+        removeEvent((i * 7) % n);
+        topRight &= (getNextEvent() == earliest(n));
+    }
+    CHECK(topRight);
+    CHECK(getEventCount() == 0);
+
+    printf("  %3u events: insert %5.1f ns, delete %5.1f ns, pop-next %5.1f ns, walk %5.1f ns per event\n", n,
+           (double)insertNs / (rounds * n), (double)deleteNs / (rounds * n), (double)popNs / (rounds * n), (double)walkNs / (rounds * n));
+}
+
+static void testAlarm()                                 // The match follows the top of the heap and is cleared with it
+{
+    storeEvents(3);
+    insertEvent(0);
+    AlarmTime();
+    CHECK(HIB_RTCM0_R == expected[0]);
+    removeEvent(0);
+    AlarmTime();
+    CHECK(HIB_RTCM0_R == 0xFFFFFFFF);
+}
+
+int main()
+{
+    uint16_t fit = 0;
+    srand(5);
+    openEepromImage(IMAGE);
+    eraseEepromImage();
+    initEepromCache();
+    HIB_RTCC_R = START;
+    sortEvent();
+    measure(10);
+    measure(100);
+    fit = storeEvents(MAX_EVENTS);
+    printf("  the EEPROM log holds %u events next to the settings\n", fit);
+    CHECK(fit >= 100);
+    measure(fit);
+    testAlarm();
+    closeEepromImage();
+    return finishTest("heapTest");
+}
@@ -0,0 +1,81 @@
+//Host UART0. Text and frames the firmware sends are collected in a buffer the tests read back,
+//nothing is ever received.
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart0.h"
+#include "hostConsole.h"
+
+static char output[CONSOLE_SIZE];
+static uint32_t length = 0;
+static bool textMuted = false;
+
+void putcUart0(char c)
+{
+    if(length < CONSOLE_SIZE - 1)
+    {
+        output[length++] = c;
+        output[length] = '\0';
+    }
+}
+
+bool tryPutcUart0(char c)
+{
+    putcUart0(c);
+    return true;
+}
+
+void putsUart0(const char* str)
+{
+    while(!textMuted && (*str != '\0'))
+    {
+        putcUart0(*str++);
+    }
+}
+
+void putTextUart0(char c)
+{
+    if(!textMuted)
+    {
+        putcUart0(c);
+    }
+}
+
+char getcUart0()                            // Ends any line at once
+{
+    return 13;
+}
+
+bool tryGetcUart0(char* c)
+{
+    return false;
+}
+
+bool kbhitUart0()
+{
+    return false;
+}
+
+void flushUart0()
+{
+}
+
+void muteUart0Text(bool mute)
+{
+    textMuted = mute;
+}
+
+const char* getConsole()
+{
+    return output;
+}
+
+uint32_t getConsoleLength()
+{
+    return length;
+}
+
+void clearConsole()
+{
+    length = 0;
+    output[0] = '\0';
+}
@@ -0,0 +1,151 @@
+//Host EEPROM driver. The 512 words live in RAM, are loaded from an image file when it is opened and
+//written back when it is closed, so a test can power the firmware modules down and boot them again
+//on the same contents. Every program cycle is counted per word for the wear reports, and a write
+//budget cuts the power part way through a sequence of writes, optionally tearing the last word.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "eeprom.h"
+#include "hostEeprom.h"
+
+static uint32_t image[EEPROM_WORDS];
+static uint32_t wear[EEPROM_WORDS];
+static const char* imagePath = NULL;
+static int32_t budget = -1;                         // Program cycles left before the power fails, -1 for no limit
+static bool tearLast = false;
+static bool failed = false;
+static uint32_t eepromReads = 0;
+static uint32_t eepromWrites = 0;
+static uint32_t eepromSkips = 0;
+
+void openEepromImage(const char* path)              // Loads the image, a missing file is an erased EEPROM
+{
+    FILE* file = fopen(path, "rb");
+    imagePath = path;
+    if((file == NULL) || (fread(image, sizeof(image[0]), EEPROM_WORDS, file) != EEPROM_WORDS))
+    {
+        eraseEepromImage();
+    }
+    if(file != NULL)
+    {
+        fclose(file);
+    }
+}
+
+void closeEepromImage()
+{
+    FILE* file = fopen(imagePath, "wb");
+    if((file == NULL) || (fwrite(image, sizeof(image[0]), EEPROM_WORDS, file) != EEPROM_WORDS))
+    {
+        fprintf(stderr, "cannot write %s\n", imagePath);
+        exit(2);
+    }
+    fclose(file);
+}
+
+void eraseEepromImage()
+{
+    uint16_t i = 0;
+    for(i = 0; i < EEPROM_WORDS; i++)
+    {
+        image[i] = 0xFFFFFFFF;
+    }
+}
+
+void cutPowerAfter(int32_t writes, bool torn)       // -1 restores the power
+{
+    budget = writes;
+    tearLast = torn;
+    failed = false;
+}
+
+bool powerFailed()
+{
+    return failed;
+}
+
+uint32_t getWordWear(uint16_t add)
+{
+    return wear[add];
+}
+
+void clearWear()
+{
+    uint16_t i = 0;
+    for(i = 0; i < EEPROM_WORDS; i++)
+    {
+        wear[i] = 0;
+    }
+}
+
+static void program(uint16_t add, uint32_t data)
+{
+    if(failed || (add >= EEPROM_WORDS))
+    {
+        return;
+    }
+    if(budget == 0)                                 // Power fails during this cycle
+    {
+        failed = true;
+        if(tearLast)
+        {
+            image[add] = (image[add] & 0xFFFF0000) | (data & 0x0000FFFF);   // Half programmed
+        }
+        return;
+    }
+    if(budget > 0)
+    {
+        budget--;
+    }
+    image[add] = data;
+    wear[add]++;
+    eepromWrites++;
+}
+
+void initEeprom(void)
+{
+}
+
+void writeEeprom(uint16_t add, uint32_t data)
+{
+    program(add, data);
+}
+
+uint32_t readEeprom(uint16_t add)
+{
+    eepromReads++;
+    return (add < EEPROM_WORDS) ? image[add] : 0xFFFFFFFF;
+}
+
+void writeEepromBlock(uint16_t add, const uint32_t data[], uint16_t count)  // Skips unchanged words like the driver
+{
+    uint16_t i = 0;
+    for(i = 0; i < count; i++)
+    {
+        if(readEeprom(add + i) == data[i])
+        {
+            eepromSkips++;
+        }
+        else
+        {
+            program(add + i, data[i]);
+        }
+    }
+}
+
+void readEepromBlock(uint16_t add, uint32_t data[], uint16_t count)
+{
+    uint16_t i = 0;
+    for(i = 0; i < count; i++)
+    {
+        data[i] = readEeprom(add + i);
+    }
+}
+
+void getEepromCounts(uint32_t* reads, uint32_t* writes, uint32_t* skips)
+{
+    *reads = eepromReads;
+    *writes = eepromWrites;
+    *skips = eepromSkips;
+}
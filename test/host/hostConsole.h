@@ -0,0 +1,18 @@
+/*
+ * hostConsole.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef HOSTCONSOLE_H_
+#define HOSTCONSOLE_H_
+
+#include <stdint.h>
+
+#define CONSOLE_SIZE 4096
+
+const char* getConsole();
+uint32_t getConsoleLength();
+void clearConsole();
+
+#endif /* HOSTCONSOLE_H_ */
@@ -0,0 +1,24 @@
+/*
+ * hostEeprom.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef HOSTEEPROM_H_
+#define HOSTEEPROM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EEPROM_WORDS 512                            // 32 blocks of 16 words
+#define EEPROM_ENDURANCE 500000                     // Program cycles per word in the TM4C123 datasheet
+
+void openEepromImage(const char* path);
+void closeEepromImage();
+void eraseEepromImage();
+void cutPowerAfter(int32_t writes, bool torn);
+bool powerFailed();
+uint32_t getWordWear(uint16_t add);
+void clearWear();
+
+#endif /* HOSTEEPROM_H_ */
@@ -0,0 +1,35 @@
+//Checks and timing shared by the host tests. A failed check is printed where it happened and the
+//test keeps going, finishTest turns the count into the exit code make looks at.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "hostTest.h"
+
+static uint32_t checks = 0;
+static uint32_t failures = 0;
+
+bool checkCondition(bool passed, const char* text, const char* file, int line)
+{
+    checks++;
+    if(!passed)
+    {
+        failures++;
+        printf("%s:%d: check failed: %s\n", file, line, text);
+    }
+    return passed;
+}
+
+int finishTest(const char* name)
+{
+    printf("%s: %u checks, %u failed\n", name, (unsigned)checks, (unsigned)failures);
+    return (failures == 0) ? 0 : 1;
+}
+
+uint64_t getNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+}
@@ -0,0 +1,19 @@
+/*
+ * hostTest.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CHECK(condition) checkCondition((condition), #condition, __FILE__, __LINE__)
+
+bool checkCondition(bool passed, const char* text, const char* file, int line);
+int finishTest(const char* name);
+uint64_t getNanoseconds();
+
+#endif /* HOSTTEST_H_ */
@@ -0,0 +1,31 @@
+/*
+ * hostUart.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef HOSTUART_H_
+#define HOSTUART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_FIFO_SIZE 16
+#define UART_POLL_CYCLES 20                         // A read of the flag register, with the loop around it
+
+typedef struct _HOST_UART_STATS
+{
+    uint32_t sent;                                  // Characters that left the transmitter
+    uint32_t received;                              // Characters the receiver took in, looped back or not
+    uint32_t overruns;                              // Characters lost because the rx FIFO was full
+    uint32_t txOverflows;                           // Writes while the tx FIFO was full
+    uint32_t polls;                                 // Reads of the flag register
+} HOST_UART_STATS;
+
+void runUart(uint32_t cycles);
+bool uartInterruptPending();
+uint64_t getUartCycles();
+uint32_t getUartCharCycles();
+void getHostUartStats(HOST_UART_STATS* stats);
+
+#endif /* HOSTUART_H_ */
@@ -0,0 +1,108 @@
+//Simulated register file for the host builds. A register gets a word the first time its address is
+//used, so a test can preset inputs such as the RTC and read back what the firmware programmed. The
+//TI intrinsics and the inline cpsid, cpsie and wfi work on a PRIMASK kept here. A test can hook the
+//moment PRIMASK clears, which is when a pending interrupt would be taken.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+
+#define REGISTER_SLOTS 64
+#define HIB_CTL_ADDRESS 0x400FC010
+
+static uint32_t addresses[REGISTER_SLOTS];
+static volatile uint32_t values[REGISTER_SLOTS];
+static uint8_t used = 0;
+static uint32_t primask = 0;                        // 1 while interrupts are masked
+static uint32_t wfis = 0;
+static void (*interruptHook)() = NULL;
+static bool inHook = false;                         // The hook is the interrupt, it is not nested
+
+volatile uint32_t* hostRegister(uint32_t address)
+{
+    uint8_t i = 0;
+    for(i = 0; i < used; i++)
+    {
+        if(addresses[i] == address)
+        {
+            return &values[i];
+        }
+    }
+    if(used == REGISTER_SLOTS)
+    {
+        fprintf(stderr, "register file full at 0x%08X\n", (unsigned)address);
+        exit(2);
+    }
+    addresses[used] = address;
+    values[used] = (address == HIB_CTL_ADDRESS) ? HIB_CTL_WRC : 0;   // HIB writes complete at once
+    return &values[used++];
+}
+
+void resetRegisters()                           // Every register back to its reset value
+{
+    used = 0;
+}
+
+static void takeInterrupts()
+{
+    if((interruptHook != NULL) && !inHook)
+    {
+        inHook = true;
+        interruptHook();
+        inHook = false;
+    }
+}
+
+void _delay_cycles(uint32_t cycles)
+{
+}
+
+uint32_t _disable_interrupts()                  // Returns PRIMASK as it was
+{
+    uint32_t was = primask;
+    primask = 1;
+    return was;
+}
+
+void _restore_interrupts(uint32_t was)
+{
+    primask = was;
+    if(primask == 0)
+    {
+        takeInterrupts();
+    }
+}
+
+void hostAsm(const char* text)
+{
+    if(strcmp(text, " cpsid i") == 0)
+    {
+        primask = 1;
+    }
+    else if(strcmp(text, " cpsie i") == 0)
+    {
+        primask = 0;
+        takeInterrupts();
+    }
+    else if(strcmp(text, " wfi") == 0)
+    {
+        wfis++;                                 // Returns at once, as if an interrupt were pending
+    }
+}
+
+uint32_t getPrimask()
+{
+    return primask;
+}
+
+uint32_t getWfiCount()
+{
+    return wfis;
+}
+
+void setInterruptHook(void (*hook)())
+{
+    interruptHook = hook;
+}
@@ -0,0 +1,158 @@
+/*
+ * tm4c123gh6pm.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Host stand-in for the TI device header. Only the registers and fields of the modules the host
+ *  tests build are here, each register is a word of the simulated register file in registers.c
+ *  found by its real address.
+ */
+
+#ifndef TM4C123GH6PM_H_
+#define TM4C123GH6PM_H_
+
+#include <stdint.h>
+
+volatile uint32_t* hostRegister(uint32_t address);
+void resetRegisters();
+
+#define HOST_REGISTER(address) (*hostRegister(address))
+
+// Hibernation module
+#define HIB_RTCC_R              HOST_REGISTER(0x400FC000)
+#define HIB_RTCM0_R             HOST_REGISTER(0x400FC004)
+#define HIB_RTCLD_R             HOST_REGISTER(0x400FC00C)
+#define HIB_CTL_R               HOST_REGISTER(0x400FC010)
+#define HIB_IM_R                HOST_REGISTER(0x400FC014)
+#define HIB_RIS_R               HOST_REGISTER(0x400FC018)
+#define HIB_IC_R                HOST_REGISTER(0x400FC020)
+
+#define HIB_CTL_WRC             0x80000000          // Write complete, always set on the host
+#define HIB_CTL_CLK32EN         0x00000040
+#define HIB_CTL_RTCEN           0x00000001
+#define HIB_IM_RTCALT0          0x00000001
+#define HIB_RIS_RTCALT0         0x00000001
+
+// PWM0 generator 0 (auger) and PWM1 generator 2 (pump)
+#define PWM0_ENABLE_R           HOST_REGISTER(0x40028008)
+#define PWM0_INTEN_R            HOST_REGISTER(0x40028014)
+#define PWM0_0_CTL_R            HOST_REGISTER(0x40028040)
+#define PWM0_0_INTEN_R          HOST_REGISTER(0x40028044)
+#define PWM0_0_ISC_R            HOST_REGISTER(0x4002804C)
+#define PWM0_0_LOAD_R           HOST_REGISTER(0x40028050)
+#define PWM0_0_CMPB_R           HOST_REGISTER(0x4002805C)
+#define PWM0_0_GENB_R           HOST_REGISTER(0x40028064)
+#define PWM1_ENABLE_R           HOST_REGISTER(0x40029008)
+#define PWM1_2_CTL_R            HOST_REGISTER(0x400290C0)
+#define PWM1_2_LOAD_R           HOST_REGISTER(0x400290D0)
+#define PWM1_2_CMPA_R           HOST_REGISTER(0x400290D8)
+#define PWM1_2_GENA_R           HOST_REGISTER(0x400290E0)
+
+#define PWM_ENABLE_PWM1EN       0x00000002
+#define PWM_ENABLE_PWM4EN       0x00000010
+#define PWM_INTEN_INTPWM0       0x00000001
+#define PWM_0_CTL_ENABLE        0x00000001
+#define PWM_0_INTEN_INTCNTLOAD  0x00000002
+#define PWM_0_ISC_INTCNTLOAD    0x00000002
+#define PWM_0_GENB_ACTCMPBD_ONE 0x00000C00
+#define PWM_0_GENB_ACTLOAD_ZERO 0x00000008
+#define PWM_2_CTL_ENABLE        0x00000001
+#define PWM_2_GENA_ACTCMPAD_ONE 0x000000C0
+#define PWM_2_GENA_ACTLOAD_ZERO 0x00000008
+
+// System control and NVIC
+#define SYSCTL_SRPWM_R          HOST_REGISTER(0x400FE540)
+#define SYSCTL_SRPWM_R0         0x00000001
+#define SYSCTL_SRPWM_R1         0x00000002
+#define NVIC_EN0_R              HOST_REGISTER(0xE000E100)
+#define NVIC_EN1_R              HOST_REGISTER(0xE000E104)
+
+#define INT_PWM0_0              26
+#define INT_HIBERNATE           59
+
+// SysTick and the interrupt control and state register
+#define NVIC_ST_CTRL_R          HOST_REGISTER(0xE000E010)
+#define NVIC_ST_RELOAD_R        HOST_REGISTER(0xE000E014)
+#define NVIC_ST_CURRENT_R       HOST_REGISTER(0xE000E018)
+#define NVIC_INT_CTRL_R         HOST_REGISTER(0xE000ED04)
+
+#define NVIC_ST_CTRL_CLK_SRC    0x00000004
+#define NVIC_ST_CTRL_INTEN      0x00000002
+#define NVIC_ST_CTRL_ENABLE     0x00000001
+#define NVIC_INT_CTRL_PENDSTSET 0x04000000
+#define NVIC_INT_CTRL_VEC_ACT_M 0x000000FF
+
+// Timer 5, free running at the system clock to time the interrupts
+#define SYSCTL_RCGCTIMER_R      HOST_REGISTER(0x400FE604)
+#define TIMER5_CFG_R            HOST_REGISTER(0x40035000)
+#define TIMER5_TAMR_R           HOST_REGISTER(0x40035004)
+#define TIMER5_CTL_R            HOST_REGISTER(0x4003500C)
+#define TIMER5_TAILR_R          HOST_REGISTER(0x40035028)
+#define TIMER5_TAV_R            HOST_REGISTER(0x40035050)
+
+#define SYSCTL_RCGCTIMER_R5     0x00000020
+#define TIMER_CFG_32_BIT_TIMER  0x00000000
+#define TIMER_TAMR_TAMR_PERIOD  0x00000002
+#define TIMER_TAMR_TACDIR       0x00000010
+#define TIMER_CTL_TAEN          0x00000001
+
+// UART0 and its Port A pins. The data and flag registers are the FIFOs of the simulated UART in uart.c,
+// the rest are plain words.
+volatile uint32_t* hostUartData();
+volatile uint32_t* hostUartFlags();
+
+#define SYSCTL_RCGCUART_R       HOST_REGISTER(0x400FE618)
+#define SYSCTL_RCGCGPIO_R       HOST_REGISTER(0x400FE608)
+#define GPIO_PORTA_AFSEL_R      HOST_REGISTER(0x40004420)
+#define GPIO_PORTA_DR2R_R       HOST_REGISTER(0x40004500)
+#define GPIO_PORTA_DEN_R        HOST_REGISTER(0x4000451C)
+#define GPIO_PORTA_PCTL_R       HOST_REGISTER(0x4000452C)
+#define UART0_DR_R              (*hostUartData())
+#define UART0_FR_R              (*hostUartFlags())
+#define UART0_IBRD_R            HOST_REGISTER(0x4000C024)
+#define UART0_FBRD_R            HOST_REGISTER(0x4000C028)
+#define UART0_LCRH_R            HOST_REGISTER(0x4000C02C)
+#define UART0_CTL_R             HOST_REGISTER(0x4000C030)
+#define UART0_IM_R              HOST_REGISTER(0x4000C038)
+#define UART0_ICR_R             HOST_REGISTER(0x4000C044)
+#define UART0_CC_R              HOST_REGISTER(0x4000CFC8)
+
+#define SYSCTL_RCGCUART_R0      0x00000001
+#define SYSCTL_RCGCGPIO_R0      0x00000001
+#define GPIO_PCTL_PA1_M         0x000000F0
+#define GPIO_PCTL_PA1_U0TX      0x00000010
+#define GPIO_PCTL_PA0_M         0x0000000F
+#define GPIO_PCTL_PA0_U0RX      0x00000001
+#define UART_FR_TXFE            0x00000080
+#define UART_FR_RXFF            0x00000040
+#define UART_FR_TXFF            0x00000020
+#define UART_FR_RXFE            0x00000010
+#define UART_FR_BUSY            0x00000008
+#define UART_LCRH_WLEN_8        0x00000060
+#define UART_LCRH_FEN           0x00000010
+#define UART_CTL_RXE            0x00000200
+#define UART_CTL_TXE            0x00000100
+#define UART_CTL_LBE            0x00000080
+#define UART_CTL_UARTEN         0x00000001
+#define UART_IM_RTIM            0x00000040
+#define UART_IM_TXIM            0x00000020
+#define UART_IM_RXIM            0x00000010
+#define UART_ICR_RTIC           0x00000040
+#define UART_ICR_TXIC           0x00000020
+#define UART_ICR_RXIC           0x00000010
+#define UART_CC_CS_SYSCLK       0x00000000
+
+#define INT_UART0               21
+
+// TI compiler intrinsics and the inline instructions, acting on a simulated PRIMASK
+void _delay_cycles(uint32_t cycles);
+uint32_t _disable_interrupts();
+void _restore_interrupts(uint32_t primask);
+void hostAsm(const char* text);                     // " cpsid i", " cpsie i" and " wfi"
+uint32_t getPrimask();
+uint32_t getWfiCount();
+void setInterruptHook(void (*hook)());              // Called whenever PRIMASK clears, to take pending interrupts
+
+#define __asm(text) hostAsm(text)
+
+#endif /* TM4C123GH6PM_H_ */
@@ -0,0 +1,161 @@
+//Simulated UART0 for the host builds of uart0.c. The data and flag registers are backed by 16 deep tx
+//and rx FIFOs, the other registers are plain words of the register file. The line sends one character
+//per 10 bit times at the baud rate programmed in IBRD and FBRD, and with UART_CTL_LBE set it loops the
+//transmitter back into the receiver. Time passes only in runUart and with each read of the flag
+//register, so a firmware loop polling the UART still gets somewhere.
+//UART0_DR_R is a word the firmware reads or writes through a pointer, so an access is only seen at the
+//next one. Every access finds the word holding the oldest rx character with the four error flags set,
+//a value no write of a character leaves. If it still holds it at the next access it was read, and the
+//character leaves the rx FIFO; anything else was written and goes into the tx FIFO.
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "hostUart.h"
+
+#define READ_MARK 0x00000F00                        // OE, BE, PE and FE
+#define CHAR_MASK 0x000000FF
+#define TX_TRIGGER (UART_FIFO_SIZE / 2)             // IFLS reset value, TXIM when the tx FIFO is at most half full
+
+static char txFifo[UART_FIFO_SIZE];
+static uint8_t txCount = 0;
+static char rxFifo[UART_FIFO_SIZE];
+static uint8_t rxCount = 0;
+static volatile uint32_t dataWord = READ_MARK;
+static uint32_t offered = READ_MARK;                // What dataWord held when it was last handed out
+static bool accessed = false;
+static volatile uint32_t flagWord = 0;
+static uint64_t now = 0;                            // System clock cycles
+static uint64_t lineFree = 0;                       // When the character on the line has gone
+static bool shifting = false;
+static char onLine = 0;
+static HOST_UART_STATS uartStats;
+
+static void pushFifo(char fifo[], uint8_t* count, char c)
+{
+    fifo[(*count)++] = c;
+}
+
+static char popFifo(char fifo[], uint8_t* count)
+{
+    char c = fifo[0];
+    uint8_t i = 0;
+    for(i = 1; i < *count; i++)
+    {
+        fifo[i - 1] = fifo[i];
+    }
+    (*count)--;
+    return c;
+}
+
+static void settleAccess()                          // Works out what the last UART0_DR_R access was
+{
+    if(!accessed)
+    {
+        return;
+    }
+    accessed = false;
+    if(dataWord != offered)
+    {
+        if(txCount < UART_FIFO_SIZE)
+        {
+            pushFifo(txFifo, &txCount, dataWord & CHAR_MASK);
+        }
+        else
+        {
+            uartStats.txOverflows++;
+        }
+    }
+    else if(rxCount != 0)
+    {
+        popFifo(rxFifo, &rxCount);
+    }
+}
+
+uint32_t getUartCharCycles()                        // Start, 8 data and stop bits at 16 clocks per bit over the divisor
+{
+    uint32_t divisor64 = (UART0_IBRD_R * 64) + UART0_FBRD_R;
+    return (160 * divisor64) / 64;
+}
+
+static void runLine(uint64_t until)
+{
+    bool enabled = (UART0_CTL_R & (UART_CTL_UARTEN | UART_CTL_TXE)) == (UART_CTL_UARTEN | UART_CTL_TXE);
+    settleAccess();
+    while(true)
+    {
+        if(shifting && (lineFree <= until))
+        {
+            now = lineFree;
+            shifting = false;
+            uartStats.sent++;
+            if(UART0_CTL_R & UART_CTL_LBE)
+            {
+                uartStats.received++;
+                if(rxCount < UART_FIFO_SIZE)
+                {
+                    pushFifo(rxFifo, &rxCount, onLine);
+                }
+                else
+                {
+                    uartStats.overruns++;
+                }
+            }
+        }
+        else if(!shifting && enabled && (txCount != 0))
+        {
+            onLine = popFifo(txFifo, &txCount);
+            lineFree = now + getUartCharCycles();
+            shifting = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    now = until;
+}
+
+void runUart(uint32_t cycles)
+{
+    runLine(now + cycles);
+}
+
+volatile uint32_t* hostUartData()
+{
+    runLine(now);
+    dataWord = (rxCount != 0) ? (READ_MARK | (uint8_t)rxFifo[0]) : READ_MARK;
+    offered = dataWord;
+    accessed = true;
+    return &dataWord;
+}
+
+volatile uint32_t* hostUartFlags()
+{
+    uartStats.polls++;
+    runLine(now + UART_POLL_CYCLES);
+    flagWord = 0;
+    flagWord |= (txCount == UART_FIFO_SIZE) ? UART_FR_TXFF : 0;
+    flagWord |= (txCount == 0) ? UART_FR_TXFE : 0;
+    flagWord |= (rxCount == UART_FIFO_SIZE) ? UART_FR_RXFF : 0;
+    flagWord |= (rxCount == 0) ? UART_FR_RXFE : 0;
+    flagWord |= (shifting || (txCount != 0)) ? UART_FR_BUSY : 0;
+    return &flagWord;
+}
+
+bool uartInterruptPending()                         // The receive timeout is taken as immediate
+{
+    settleAccess();
+    return ((UART0_IM_R & UART_IM_TXIM) && (txCount <= TX_TRIGGER))
+           || ((UART0_IM_R & (UART_IM_RXIM | UART_IM_RTIM)) && (rxCount != 0));
+}
+
+uint64_t getUartCycles()
+{
+    return now;
+}
+
+void getHostUartStats(HOST_UART_STATS* stats)
+{
+    runLine(now);
+    *stats = uartStats;
+}
@@ -0,0 +1,230 @@
+//Schedule import on the host EEPROM: the EEPROM writes and alarm re-arms of ten "feed" commands against
+//one import of the same ten events, the same import again, an import the log has no room for, which has
+//to be refused before anything is written, and records "feed" or "repeat" would not take.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+#include "eepromCache.h"
+#include "configStore.h"
+#include "sortEvent.h"
+#include "AlarmTIme.h"
+#include "scheduleTransfer.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/importTest.img"
+#define EVENTS 10
+#define START (10 * 3600)                           // RTC at 10:00 on day 0
+#define LINES_MAX ((MAX_EVENTS / RECORDS_PER_LINE) + 1)
+
+typedef struct _COST
+{
+    uint32_t reads;
+    uint32_t writes;                                // EEPROM word writes
+    uint32_t alarms;                                // Times the RTC match was set
+} COST;
+
+static char lines[LINES_MAX][(RECORDS_PER_LINE * RECORD_HEX) + 1];
+static uint16_t lineCount = 0;
+static uint32_t alarms = 0;
+
+static void armAlarm()                              // AlarmTime, counted
+{
+    AlarmTime();
+    alarms++;
+}
+
+static void startCost(COST* cost)
+{
+    uint32_t skips = 0;
+    getEepromCounts(&cost->reads, &cost->writes, &skips);
+    cost->alarms = alarms;
+}
+
+static void endCost(COST* cost)
+{
+    COST now;
+    startCost(&now);
+    cost->reads = now.reads - cost->reads;
+    cost->writes = now.writes - cost->writes;
+    cost->alarms = now.alarms - cost->alarms;
+}
+
+static void reset()
+{
+    eraseEepromImage();
+    initEepromCache();
+    HIB_RTCC_R = START;
+    sortEvent();
+}
+
+static uint32_t eventTime(uint16_t event)
+{
+    return ((6 * 60) + (event * 90)) | (RULE_DAILY << TIME_RULE_S);
+}
+
+static void feedCommands()                          // What storeEvent does for each "feed": action, time, heap, alarm
+{
+    uint16_t event = 0;
+    for(event = 0; event < EVENTS; event++)
+    {
+        writeEepromCache(EVENT_ACTION(event), 10 | (50 << ACTION_PWM_S));
+        writeEepromCache(EVENT_TIME(event), eventTime(event));
+        insertEvent(event);
+        armAlarm();
+    }
+}
+
+static uint16_t exportTable(uint16_t* count)        // "schedule export" into lines, returns the check
+{
+    uint16_t check = 0;
+    uint16_t event = 0;
+    *count = loadExport(&check);
+    lineCount = 0;
+    while((lineCount < LINES_MAX) && exportLine(&event, lines[lineCount]))
+    {
+        lineCount++;
+    }
+    return check;
+}
+
+static uint8_t importTable(uint16_t count, uint16_t check)
+{
+    uint16_t i = 0;
+    uint8_t result = IMPORT_OK;
+    beginImport();
+    for(i = 0; (i < lineCount) && (result == IMPORT_OK); i++)
+    {
+        result = importRecords(lines[i]);
+    }
+    if(result == IMPORT_OK)
+    {
+        result = endImport(count, check);
+        alarms += (result == IMPORT_OK);            // endImport arms it once for the table
+    }
+    return result;
+}
+
+static bool storedIsFeedTable()
+{
+    uint16_t event = 0;
+    bool same = (getEventCount() == EVENTS);
+    for(event = 0; event < EVENTS; event++)
+    {
+        same &= (readEepromCache(EVENT_TIME(event)) == eventTime(event));
+        same &= (readEepromCache(EVENT_ACTION(event)) == (10 | (50 << ACTION_PWM_S)));
+    }
+    return same;
+}
+
+static void testCost()
+{
+    COST feeds;
+    COST import;
+    COST again;
+    uint16_t count = 0;
+    uint16_t check = 0;
+
+    reset();
+    startCost(&feeds);
+    feedCommands();
+    endCost(&feeds);
+    check = exportTable(&count);
+    CHECK(count == EVENTS);
+
+    reset();
+    startCost(&import);
+    CHECK(importTable(count, check) == IMPORT_OK);
+    endCost(&import);
+    CHECK(storedIsFeedTable());
+
+    startCost(&again);
+    CHECK(importTable(count, check) == IMPORT_OK);
+    endCost(&again);
+    CHECK(storedIsFeedTable());
+
+    printf("  %d events, EEPROM reads / writes / alarm re-arms:\n", EVENTS);
+    printf("  %-24s %4u / %4u / %2u\n", "ten feed commands", (unsigned)feeds.reads, (unsigned)feeds.writes, (unsigned)feeds.alarms);
+    printf("  %-24s %4u / %4u / %2u\n", "one import", (unsigned)import.reads, (unsigned)import.writes, (unsigned)import.alarms);
+    printf("  %-24s %4u / %4u / %2u\n", "the same import again", (unsigned)again.reads, (unsigned)again.writes, (unsigned)again.alarms);
+    CHECK(import.writes <= feeds.writes);
+    CHECK(HIB_RTCM0_R == getNextFireTime());
+    CHECK(again.writes == 0);
+}
+
+static void testFull()                              // More new events than the log has room for: refused, nothing written
+{
+    uint16_t event = 0;
+    uint16_t count = 0;
+    uint16_t check = 0;
+    uint16_t stored = 0;
+    COST cost;
+    STORE_STATS before;
+    STORE_STATS after;
+
+    reset();
+    for(event = 0; event < MAX_EVENTS; event++)     // The table another feeder might hold, more than this one can
+    {
+        writeEepromCache(EVENT_ACTION(event), 10 | (50 << ACTION_PWM_S));
+        if(!writeEepromCache(EVENT_TIME(event), eventTime(event % EVENTS)))
+        {
+            writeEepromCache(EVENT_ACTION(event), 0xFFFFFFFF);
+            break;
+        }
+    }
+    stored = event;
+    check = exportTable(&count);
+    CHECK(count == stored);
+
+    reset();                                        // This feeder keeps a small schedule of its own
+    feedCommands();
+    for(event = 0; event < 8; event++)
+    {
+        writeEepromCache(BLOCK_WORDS + event, 1000 + event);   // And a calibration table
+    }
+    getStoreStats(&before);
+    startCost(&cost);
+    CHECK(importTable(count, check) == IMPORT_FULL);
+    endCost(&cost);
+    getStoreStats(&after);
+    printf("  import of %u events into a log with room for %u more keys: refused, %u EEPROM writes\n",
+           (unsigned)count, (unsigned)(STORE_CAPACITY - before.live), (unsigned)cost.writes);
+    CHECK(cost.writes == 0);
+    CHECK(after.appends == before.appends);
+    CHECK(storedIsFeedTable());
+}
+
+static void testRecords()                           // Records the commands would refuse spoil the import
+{
+    reset();
+    feedCommands();
+    beginImport();
+    CHECK(importRecords("00000009360065000A") == IMPORT_BAD_RECORD);   // Speed 101 %
+    beginImport();
+    CHECK(importRecords("00000019360032000A") == IMPORT_BAD_RECORD);   // Every 0 hours
+    beginImport();
+    CHECK(importRecords("00000069360032000A") == IMPORT_BAD_RECORD);   // Daily with an argument
+    beginImport();
+    CHECK(importRecords("0000000DA00032000A") == IMPORT_BAD_RECORD);   // 24:00
+    beginImport();
+    CHECK(importRecords("00000009360132000A") == IMPORT_BAD_RECORD);   // A bit between the speed and the grams flag
+    beginImport();
+    CHECK(importRecords("00000059360032000A") == IMPORT_OK);           // Every 2 hours from 05:10
+    CHECK(importRecords("010001F1360032000A") == IMPORT_OK);           // Sunday to Wednesday
+    CHECK(importRecords("020000093680640028") == IMPORT_OK);           // 40 g at 100 %
+    cancelImport();
+    CHECK(storedIsFeedTable());
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testCost();
+    testFull();
+    testRecords();
+    closeEepromImage();
+    return finishTest("importTest");
+}
@@ -0,0 +1,240 @@
+//PIR waveforms replayed through the motion debounce the way pirISR and Wide4ISR drive it: every edge
+//goes to motionEdge, the one-shot it asks for is run out in 1 ms steps and then motionTimeout is called.
+//Short scripted waveforms check the presence time, the hold-off and retriggering; hours of made-up visits
+//with dropouts and glitches are then counted against the old 2 s poll of the PIR output.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixedPoint.h"
+#include "motion.h"
+#include "hostTest.h"
+
+#define PUMP_MS 5                                   // Confirmed visit to pump start: one burst of readings
+#define POLL_MS 2000                                // Wide timer 4 period of the old polling
+#define RANDOM_HOURS 6
+
+typedef struct _SEGMENT
+{
+    uint32_t ms;
+    bool high;
+} SEGMENT;
+
+typedef struct _REPLAY
+{
+    uint32_t ms;                                    // Waveform time
+    bool high;
+    int32_t timerMs;                                // One-shot deadline, -1 while stopped
+    int32_t pumpMs;                                 // Pump start of a confirmed visit, -1 when none is due
+    uint32_t started;
+    uint32_t ended;
+    uint32_t lastStartMs;
+    uint32_t lastEndMs;
+} REPLAY;
+
+static uint32_t seed = 7;
+
+static uint32_t randomBelow(uint32_t limit)
+{
+    seed = (seed * 1103515245) + 12345;
+    return (seed >> 8) % limit;
+}
+
+static void checkChange(REPLAY* replay)             // checkVisit
+{
+    uint8_t change = motionChange();
+    if(change == VISIT_STARTED)
+    {
+        replay->started++;
+        replay->lastStartMs = replay->ms;
+        replay->pumpMs = replay->ms + PUMP_MS;
+    }
+    else if(change == VISIT_ENDED)
+    {
+        replay->ended++;
+        replay->lastEndMs = replay->ms;
+    }
+}
+
+static void arm(REPLAY* replay, uint16_t ms)        // armMotionTimer
+{
+    replay->timerMs = (ms == 0) ? -1 : (int32_t)(replay->ms + ms);
+}
+
+static void stepTo(REPLAY* replay, bool high)       // 1 ms of waveform at the given level
+{
+    if(high != replay->high)                        // pirISR
+    {
+        replay->high = high;
+        arm(replay, motionEdge(high, MS_TO_CYCLES(replay->ms)));
+        checkChange(replay);
+    }
+    if((replay->timerMs >= 0) && (replay->ms >= (uint32_t)replay->timerMs))   // Wide4ISR
+    {
+        arm(replay, motionTimeout(replay->high));
+        checkChange(replay);
+    }
+    if((replay->pumpMs >= 0) && (replay->ms >= (uint32_t)replay->pumpMs))
+    {
+        motionPumpStarted(MS_TO_CYCLES(replay->ms));
+        replay->pumpMs = -1;
+    }
+    replay->ms++;
+}
+
+static void play(REPLAY* replay, const SEGMENT* segments, uint8_t count)
+{
+    uint8_t i = 0;
+    uint32_t ms = 0;
+    for(i = 0; i < count; i++)
+    {
+        for(ms = 0; ms < segments[i].ms; ms++)
+        {
+            stepTo(replay, segments[i].high);
+        }
+    }
+}
+
+static void startReplay(REPLAY* replay, uint32_t setting, MOTION_STATS* before)
+{
+    replay->ms = 1000;
+    replay->high = false;
+    replay->timerMs = -1;
+    replay->pumpMs = -1;
+    replay->started = 0;
+    replay->ended = 0;
+    initMotion(setting);
+    getMotionStats(before);
+}
+
+static void testScripted()
+{
+    REPLAY replay;
+    MOTION_STATS before;
+    MOTION_STATS after;
+    const SEGMENT glitch[] = {{50, true}, {3000, false}};
+    const SEGMENT pulse[] = {{150, true}, {3000, false}};
+    const SEGMENT dropout[] = {{2000, true}, {1000, false}, {2000, true}, {3000, false}};
+    const SEGMENT twoVisits[] = {{1000, true}, {3000, false}, {1000, true}, {3000, false}};
+
+    startReplay(&replay, 0xFFFFFFFF, &before);      // 50 ms is too short for 100 ms presence
+    play(&replay, glitch, 2);
+    getMotionStats(&after);
+    CHECK((replay.started == 0) && (after.glitches == before.glitches + 1) && motionIdle());
+
+    startReplay(&replay, 0xFFFFFFFF, &before);      // 150 ms counts, starts after 100 ms and ends 2 s after the fall
+    play(&replay, pulse, 2);
+    getMotionStats(&after);
+    CHECK((replay.started == 1) && (replay.ended == 1));
+    CHECK((replay.lastStartMs == 1000 + DEFAULT_PRESENCE_MS) && (replay.lastEndMs == 1150 + DEFAULT_HOLDOFF_MS));
+    CHECK(after.lastLatencyUs == (DEFAULT_PRESENCE_MS + PUMP_MS) * 1000);
+
+    startReplay(&replay, 0xFFFFFFFF, &before);      // A 1 s dropout is the same visit
+    play(&replay, dropout, 4);
+    getMotionStats(&after);
+    CHECK((replay.started == 1) && (replay.ended == 1) && (after.retriggers == before.retriggers + 1));
+    CHECK(replay.lastEndMs == 6000 + DEFAULT_HOLDOFF_MS);
+    CHECK(after.pumpStarts == before.pumpStarts + 1);   // The retrigger does not start another pump latency
+
+    startReplay(&replay, 0xFFFFFFFF, &before);      // A 3 s gap is two visits
+    play(&replay, twoVisits, 4);
+    CHECK((replay.started == 2) && (replay.ended == 2));
+
+    startReplay(&replay, getMotionSetting(0, 0), &before);   // No presence time and no hold-off: the edges themselves
+    play(&replay, dropout, 4);
+    CHECK((replay.started == 2) && (replay.ended == 2) && (replay.lastStartMs == 4000) && (replay.lastEndMs == 6000));
+
+    startReplay(&replay, getMotionSetting(200, 500), &before);   // Longer presence, shorter hold-off
+    play(&replay, pulse, 2);
+    CHECK(replay.started == 0);
+    play(&replay, dropout, 4);
+    CHECK((replay.started == 2) && (replay.lastStartMs == 7150 + 200));   // The 1 s dropout outlasts the hold-off
+
+    startReplay(&replay, 0xFFFFFFFF, &before);      // The falling edge is lost: the presence timeout finds it low
+    stepTo(&replay, true);
+    replay.high = false;
+    play(&replay, glitch + 1, 1);
+    getMotionStats(&after);
+    CHECK((replay.started == 0) && (after.glitches == before.glitches + 1) && motionIdle());
+}
+
+static void testRandom()                            // Visits of 0.3-20 s with dropouts, 5-50 ms glitches, 5-65 s apart
+{
+    REPLAY replay;
+    MOTION_STATS before;
+    MOTION_STATS after;
+    uint32_t visits = 0;
+    uint32_t glitches = 0;
+    uint32_t polled = 0;                            // Visits the 2 s poll saw
+    uint64_t pollLatencyMs = 0;
+    uint32_t end = 0;
+
+    startReplay(&replay, 0xFFFFFFFF, &before);
+    end = replay.ms + (RANDOM_HOURS * 3600000);
+    while(replay.ms < end)
+    {
+        uint32_t quiet = 5000 + randomBelow(60000);
+        uint32_t ms = 0;
+        while(ms++ < quiet)
+        {
+            stepTo(&replay, false);
+        }
+        if(randomBelow(4) == 0)
+        {
+            uint32_t length = 5 + randomBelow(45);
+            for(ms = 0; ms < length; ms++)
+            {
+                stepTo(&replay, true);
+            }
+            glitches++;
+        }
+        else
+        {
+            uint32_t length = 300 + randomBelow(20000);
+            uint32_t start = replay.ms;
+            bool high = true;
+            bool seen = false;
+            for(ms = 0; ms < length; ms++)
+            {
+                if(high && (ms > 150) && (randomBelow(3000) == 0))
+                {
+                    high = false;                   // The pet keeps still for a moment
+                }
+                else if(!high && (randomBelow(200) == 0))
+                {
+                    high = true;
+                }
+                if(high && !seen && (replay.ms % POLL_MS == 0))
+                {
+                    seen = true;
+                    pollLatencyMs += replay.ms - start;
+                }
+                stepTo(&replay, high);
+            }
+            stepTo(&replay, false);
+            visits++;
+            polled += seen;
+        }
+    }
+    play(&replay, (const SEGMENT[]){{DEFAULT_HOLDOFF_MS + 1, false}}, 1);
+    getMotionStats(&after);
+    printf("  %u h: %u visits, %u glitches\n", RANDOM_HOURS, (unsigned)visits, (unsigned)glitches);
+    printf("  edge and debounce: %u visits, %u glitches, %u retriggers, pump latency avg %u ms, max %u ms\n",
+           (unsigned)(after.visits - before.visits), (unsigned)(after.glitches - before.glitches),
+           (unsigned)(after.retriggers - before.retriggers),
+           (unsigned)((after.sumLatencyUs - before.sumLatencyUs) / (after.pumpStarts - before.pumpStarts) / 1000),
+           (unsigned)(after.maxLatencyUs / 1000));
+    printf("  2 s poll: %u visits seen, %u missed, latency avg %u ms\n", (unsigned)polled, (unsigned)(visits - polled),
+           (unsigned)(pollLatencyMs / polled));
+    CHECK(after.visits - before.visits == visits);
+    CHECK(after.glitches - before.glitches == glitches);
+    CHECK((replay.started == visits) && (replay.ended == visits));
+    CHECK(after.maxLatencyUs <= (DEFAULT_PRESENCE_MS + PUMP_MS) * 1000);
+    CHECK(polled < visits);
+}
+
+int main()
+{
+    testRandom();                                   // First, the latency maximum is kept since boot
+    testScripted();
+    return finishTest("pirTest");
+}
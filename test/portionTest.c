@@ -0,0 +1,119 @@
+//Portion run times against a model of the auger. Each "calibrate auger test" run is driven through the
+//real drive profile, ramps included, and weighed to whole grams; portions of several sizes are then run at
+//speeds across the calibrated range, with and without the anti-jam pulses, and what the model delivers is
+//compared with what was asked for. The model feeds nothing below a stall duty and slightly more than in
+//proportion above it, so interpolating between the points is not exact, only close. A short portion is
+//mostly ramp, and the model feeds less over a ramp than the one-ramp allowance in portion.c assumes, so
+//portions are allowed to be off by 5 % or 1 g, whichever is more. The anti-jam kicks run at full duty and
+//a 10 s test run holds too few of them to weigh their share at a low speed, so with them on it is 10 %.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "initModules.h"
+#include "fixedPoint.h"
+#include "eepromCache.h"
+#include "auger.h"
+#include "portion.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/portionTest.img"
+#define STALL 0.12                                  // Duty the auger needs to turn at all
+#define FULL_MG_PER_S 9000.0                        // Feed rate at full duty
+#define SLACK_G 1.0                                 // For short portions
+
+static const uint8_t calibrated[] = {30, 60, 100};
+static const uint16_t portions[] = {5, 20, 60};
+
+static double modelRate(uint16_t duty)              // mg/s at a compare value
+{
+    double x = (((double)duty / PWM_FULL) - STALL) / (1 - STALL);
+    return (x <= 0) ? 0 : FULL_MG_PER_S * x * (0.85 + (0.15 * x));
+}
+
+static uint16_t speedDuty(uint8_t speed)            // As runAuger sets it
+{
+    return Q16_SCALE(Q16_RATIO(speed, 100), PWM_FULL);
+}
+
+static double runProfile(uint8_t speed, uint32_t ms)  // Grams the model delivers over one drive profile
+{
+    double mg = 0;
+    uint16_t duty = 0;
+    startProfile(speedDuty(speed), ms);
+    while(profileRunning())
+    {
+        while(!profileLoad(&duty));                 // The next 10 ms step
+        mg += modelRate(duty) * PROFILE_STEP_MS / 1000;
+    }
+    return mg / 1000;
+}
+
+static void calibrate()                             // "calibrate auger test [speed]", weigh, "calibrate auger [speed] [grams]"
+{
+    uint8_t i = 0;
+    resetPortion();
+    for(i = 0; i < sizeof(calibrated); i++)
+    {
+        uint16_t grams = (uint16_t)(runProfile(calibrated[i], AUGER_TEST_S * 1000) + 0.5);
+        CHECK(setPortionPoint(calibrated[i], rateFromTest(grams, AUGER_TEST_S * 1000, getRampMs())));
+    }
+    CHECK(getPortionCount() == sizeof(calibrated));
+}
+
+static void testPortions(const char* name, double tolerance)   // Portions at every 10 % across the calibrated range
+{
+    uint8_t p = 0;
+    uint8_t speed = 0;
+    double worst = 0;
+    bool shorter = true;                            // A faster auger runs shorter for the same portion
+
+    calibrate();
+    printf("  %s, delivered g (run time s) per speed:\n  speed", name);
+    for(p = 0; p < sizeof(portions) / sizeof(portions[0]); p++)
+    {
+        printf("   %3u g asked     ", portions[p]);
+    }
+    printf("\n");
+    for(speed = calibrated[0]; speed <= 100; speed += 10)
+    {
+        printf("  %3u %%", speed);
+        for(p = 0; p < sizeof(portions) / sizeof(portions[0]); p++)
+        {
+            uint32_t ms = portionToMs(portions[p], speed, getRampMs());
+            double grams = runProfile(speed, ms);
+            double allowed = (portions[p] * tolerance > SLACK_G) ? portions[p] * tolerance : SLACK_G;
+            double error = ((grams > portions[p]) ? grams - portions[p] : portions[p] - grams) / allowed;
+            worst = (error > worst) ? error : worst;
+            shorter &= (speed == calibrated[0]) || (ms < portionToMs(portions[p], speed - 10, getRampMs()));
+            printf("   %6.2f (%6.2f)", grams, ms / 1000.0);
+        }
+        printf("\n");
+    }
+    printf("  worst error %.0f %% of the allowed\n", worst * 100);
+    CHECK(worst <= 1);
+    CHECK(shorter);
+}
+
+static void testUncalibrated()
+{
+    resetPortion();
+    CHECK(portionToMs(20, 80, getRampMs()) == 0);   // startFeed then ends the feed without running
+    CHECK(!setPortionPoint(0, 1000));
+    CHECK(rateFromTest(20, getRampMs(), getRampMs()) == 0);
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    eraseEepromImage();
+    initEepromCache();
+    initPortion();
+    initAuger(0xFFFFFFFF);
+    testPortions("500 ms ramps", 0.05);
+    initAuger(getAugerSetting(DEFAULT_RAMP_STEPS, 3, DEFAULT_PAUSE_STEPS, DEFAULT_KICK_STEPS));
+    testPortions("anti-jam pulse every 3 s", 0.10);
+    testUncalibrated();
+    closeEepromImage();
+    return finishTest("portionTest");
+}
@@ -0,0 +1,265 @@
+//Binary protocol against the text console over a loopback: requests from the reference client in host/
+//go through the firmware's frame receiver and its responses back through the client, and the matching
+//text commands through the firmware's line assembler and field parser. Reports the bytes each command
+//puts on the wire and the commands per second that leaves at 115200 baud, and checks the range checks
+//that "feed", "repeat", the setting commands and MSG_SET_EVENT/MSG_SET_SETTING now share. The command
+//bodies are the same in both modes and need the hardware, they are not run here.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include "protocol.h"
+#include "uart0.h"
+#include "getInput.h"
+#include "sortEvent.h"
+#include "levelFilter.h"
+#include "sampleRate.h"
+#include "pumpControl.h"
+#include "feederClient.h"
+#include "hostConsole.h"
+#include "hostTest.h"
+
+#define LINK_BYTES_S 11520                          // 115200 baud, 10 bits a byte
+#define ROUNDS 20000
+
+typedef struct _EXCHANGE
+{
+    const char* name;
+    uint8_t type;
+    uint8_t request[PAYLOAD_MAX];
+    uint8_t requestLength;
+    uint8_t responseLength;                         // Payload processFrame answers with
+    const char* text;                               // The same through the console, NULL when it has none
+    const char* reply;
+} EXCHANGE;
+
+static const EXCHANGE exchanges[] =
+{
+    {"set event",   MSG_SET_EVENT,   {3, 0x36, 0x09, 0, 0, 10, 0, 50, 0}, 9, 0, "feed 3 10 50 5:10", "The event has been scheduled.\n"},
+    {"set setting", MSG_SET_SETTING, {14, 0, 20, 60, 0xE0, 0x01}, 6, 0, "pump 20 60 30", "The pump has been set.\n"},
+    {"set time",    MSG_SET_TIME,    {0x36, 0x01}, 2, 0, "time 5:10", ""},
+    {"get time",    MSG_GET_TIME,    {0}, 0, 5, "time", "Real Time is Mon 05:10\n"},
+    {"get event",   MSG_GET_EVENT,   {3}, 1, 8, NULL, NULL},
+    {"list events", MSG_LIST_EVENTS, {0xFF, 0xFF}, 2, 2 + LIST_PAGE, NULL, NULL},
+    {"telemetry",   MSG_TELEMETRY,   {0}, 0, 18, NULL, NULL},
+};
+#define EXCHANGES (sizeof(exchanges) / sizeof(exchanges[0]))
+
+static FRAME rxFrame;
+static USER_DATA rxLine;
+static CLIENT client;
+
+static uint8_t deviceReceive(const uint8_t* wire, uint8_t count)   // The firmware's receive path, returns the decoded length
+{
+    uint8_t i = 0;
+    uint8_t length = 0;
+    for(i = 0; i < count; i++)
+    {
+        if(addFrameByte(&rxFrame, wire[i]))
+        {
+            uint8_t decoded = decodeFrame(&rxFrame);
+            length = (decoded != 0) ? decoded : length;     // A bit error can split a frame in two
+        }
+    }
+    return length;
+}
+
+static bool clientReceive(RESPONSE* response)       // Everything the device sent, true when a response came out of it
+{
+    const char* wire = getConsole();
+    uint32_t i = 0;
+    bool received = false;
+    for(i = 0; i < getConsoleLength(); i++)
+    {
+        received |= receiveByte(&client, wire[i], response);
+    }
+    clearConsole();
+    return received;
+}
+
+static bool binaryExchange(const EXCHANGE* exchange, uint8_t id, uint32_t* bytes)  // One request and its response
+{
+    uint8_t wire[WIRE_MAX];
+    uint8_t reply[PAYLOAD_MAX];
+    uint8_t count = encodeRequest(wire, exchange->type, id, exchange->request, exchange->requestLength);
+    uint8_t length = deviceReceive(wire, count);
+    RESPONSE response;
+    bool ok = (length == 2 + exchange->requestLength) && (rxFrame.buffer[0] == exchange->type) && (rxFrame.buffer[1] == id)
+              && (memcmp(&rxFrame.buffer[2], exchange->request, exchange->requestLength) == 0);
+
+    memset(reply, 0, sizeof(reply));                // Zeros are the worst case for COBS
+    sendFrame(exchange->type | FRAME_RESPONSE, id, STATUS_OK, reply, exchange->responseLength);
+    *bytes = count + getConsoleLength();
+    ok &= clientReceive(&response) && (response.type == (exchange->type | FRAME_RESPONSE)) && (response.id == id)
+          && (response.status == STATUS_OK) && (response.length == exchange->responseLength);
+    return ok;
+}
+
+static bool textExchange(const EXCHANGE* exchange, uint32_t* bytes)
+{
+    const char* c = exchange->text;
+    bool complete = false;
+    while(*c != '\0')
+    {
+        complete |= addCharacter(&rxLine, *c++);
+    }
+    complete |= addCharacter(&rxLine, '\r');
+    putcUart0('\n');                                // The console answers every line with a new line
+    putsUart0(exchange->reply);
+    *bytes = strlen(exchange->text) + 1 + getConsoleLength();
+    clearConsole();
+    return complete && (parseFields(&rxLine, MAX_FIELDS) == PARSE_OK);
+}
+
+static void testThroughput()
+{
+    uint8_t i = 0;
+    printf("  %-12s %10s %13s %10s %13s %8s\n", "command", "binary B", "cmd/s", "text B", "cmd/s", "host ns binary / text");
+    for(i = 0; i < EXCHANGES; i++)
+    {
+        const EXCHANGE* exchange = &exchanges[i];
+        uint32_t binaryBytes = 0;
+        uint32_t textBytes = 0;
+        uint32_t round = 0;
+        uint64_t start = getNanoseconds();
+        uint64_t binaryNs = 0;
+        uint64_t textNs = 0;
+        bool ok = true;
+
+        for(round = 0; round < ROUNDS; round++)
+        {
+            ok &= binaryExchange(exchange, round, &binaryBytes);
+        }
+        binaryNs = (getNanoseconds() - start) / ROUNDS;
+        CHECK(ok);
+        if(exchange->text == NULL)
+        {
+            printf("  %-12s %10u %13u %24s %8u\n", exchange->name, (unsigned)binaryBytes, (unsigned)(LINK_BYTES_S / binaryBytes), "-", (unsigned)binaryNs);
+            continue;
+        }
+        start = getNanoseconds();
+        for(round = 0; round < ROUNDS; round++)
+        {
+            ok &= textExchange(exchange, &textBytes);
+        }
+        textNs = (getNanoseconds() - start) / ROUNDS;
+        CHECK(ok);
+        printf("  %-12s %10u %13u %10u %13u %8u / %u\n", exchange->name, (unsigned)binaryBytes, (unsigned)(LINK_BYTES_S / binaryBytes),
+               (unsigned)textBytes, (unsigned)(LINK_BYTES_S / textBytes), (unsigned)binaryNs, (unsigned)textNs);
+    }
+}
+
+static void testCorruption()                        // Every single bit error in a request or response is rejected
+{
+    uint8_t i = 0;
+    uint32_t flips = 0;
+    uint32_t accepted = 0;
+    uint8_t wire[WIRE_MAX];
+    uint8_t reply[PAYLOAD_MAX];
+    RESPONSE response;
+
+    for(i = 0; i < EXCHANGES; i++)
+    {
+        const EXCHANGE* exchange = &exchanges[i];
+        uint8_t count = encodeRequest(wire, exchange->type, 7, exchange->request, exchange->requestLength);
+        uint8_t replyCount = 0;
+        uint16_t bit = 0;
+
+        for(bit = 0; bit < (count - 1) * 8; bit++)  // The ending 0 stays, a flipped one only joins two frames
+        {
+            wire[bit / 8] ^= 1 << (bit % 8);
+            accepted += (deviceReceive(wire, count) != 0);
+            wire[bit / 8] ^= 1 << (bit % 8);
+            flips++;
+        }
+
+        memset(reply, 0x5A, sizeof(reply));
+        sendFrame(exchange->type | FRAME_RESPONSE, 7, STATUS_OK, reply, exchange->responseLength);
+        memcpy(wire, getConsole(), getConsoleLength());
+        replyCount = getConsoleLength();
+        clearConsole();
+        for(bit = 0; bit < (replyCount - 1) * 8; bit++)
+        {
+            uint8_t j = 0;
+            wire[bit / 8] ^= 1 << (bit % 8);
+            for(j = 0; j < replyCount; j++)
+            {
+                accepted += receiveByte(&client, wire[j], &response);
+            }
+            wire[bit / 8] ^= 1 << (bit % 8);
+            flips++;
+        }
+    }
+    printf("  %u single bit errors, %u frames accepted\n", (unsigned)flips, (unsigned)accepted);
+    CHECK(accepted == 0);
+
+    i = encodeRequest(wire, MSG_GET_TIME, 9, NULL, 0);    // Line noise up to a 0 costs only the noise
+    CHECK(deviceReceive((const uint8_t*)"\x13\x37\xFF\x00", 4) == 0);
+    CHECK(deviceReceive(wire, i) == 2);
+}
+
+static void testCrc()                               // The firmware's nibble table against the client's bitwise CRC
+{
+    uint8_t data[FRAME_MAX];
+    uint16_t round = 0;
+    bool same = true;
+    for(round = 0; round < 1000; round++)
+    {
+        uint8_t length = rand() % FRAME_MAX;
+        uint8_t i = 0;
+        for(i = 0; i < length; i++)
+        {
+            data[i] = rand();
+        }
+        same &= (crc16(CRC_START, data, length) == clientCrc16(data, length));
+    }
+    CHECK(same);
+}
+
+static void testRanges()                            // What the text commands accept, and nothing else, gets stored
+{
+    uint32_t daily = (5 * 60) + 10 + (RULE_DAILY << TIME_RULE_S);
+    uint32_t action = 10 | (50 << ACTION_PWM_S);
+
+    CHECK(validEventRecord(daily, action));
+    CHECK(validEventRecord(daily, ACTION_GRAMS | 40 | (100 << ACTION_PWM_S)));
+    CHECK(!validEventRecord(daily, 10 | (101 << ACTION_PWM_S)));            // Speed over 100 %
+    CHECK(!validEventRecord(daily, 10 | (50 << ACTION_PWM_S) | (1 << 24)));  // Bits between the PWM and ACTION_GRAMS
+    CHECK(!validEventRecord((24 * 60) | (RULE_DAILY << TIME_RULE_S), action));
+    CHECK(!validEventRecord(daily | (3 << TIME_ARG_S), action));             // Daily takes no argument
+    CHECK(validEventRecord(600 | (RULE_HOURS << TIME_RULE_S) | (24 << TIME_ARG_S), action));
+    CHECK(!validEventRecord(600 | (RULE_HOURS << TIME_RULE_S), action));     // Every 0 hours
+    CHECK(!validEventRecord(600 | (RULE_HOURS << TIME_RULE_S) | (25 << TIME_ARG_S), action));
+    CHECK(validEventRecord(600 | (RULE_WEEKDAYS << TIME_RULE_S) | (0x41 << TIME_ARG_S), action));
+    CHECK(!validEventRecord(600 | (RULE_WEEKDAYS << TIME_RULE_S), action));  // No day set
+    CHECK(!validEventRecord(daily | (1u << 20), action));                     // Above the argument
+    CHECK(!validEventRecord(0xFFFFFFFF, action));
+
+    CHECK(validFilterSetting(getFilterSetting(MAX_BURST, MAX_EMA_SHIFT)));
+    CHECK(!validFilterSetting(getFilterSetting(0, 2)));
+    CHECK(!validFilterSetting(getFilterSetting(5, MAX_EMA_SHIFT + 1)));
+    CHECK(!validFilterSetting(0xFFFFFFFF));
+    CHECK(validSampleSetting(getSampleSetting(SAMPLE_UNIT_MS, MAX_SAMPLE_MS)));
+    CHECK(!validSampleSetting(getSampleSetting(500, 400)));
+    CHECK(!validSampleSetting(getSampleSetting(0, 400)));
+    CHECK(!validSampleSetting(0xFFFFFFFF));
+    CHECK(validPumpSetting(getPumpSetting(255, MAX_RUN_LIMIT_S, PUMP_TIME_M)));
+    CHECK(!validPumpSetting(getPumpSetting(20, 0, 30)));
+    CHECK(!validPumpSetting(getPumpSetting(20, MAX_RUN_LIMIT_S + 1, 30)));
+    CHECK(validPumpSpeedSetting(getPumpSpeedSetting(100, SPEED_TAPER_M)));
+    CHECK(!validPumpSpeedSetting(getPumpSpeedSetting(0, 100)));
+    CHECK(!validPumpSpeedSetting(getPumpSpeedSetting(101, 100)));
+    CHECK(!validPumpSpeedSetting(0xFFFFFFFF));
+}
+
+int main()
+{
+    srand(23);
+    initClient(&client, -1);
+    testThroughput();
+    testCorruption();
+    testCrc();
+    testRanges();
+    return finishTest("protocolTest");
+}
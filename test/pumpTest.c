@@ -0,0 +1,224 @@
+//Pump controller against a model of the bowl. The model pump moves water in proportion to the duty
+//above a stall, the water reaches the bowl half a second after it leaves the pump, and the level is read
+//through the calibration table with a few ticks of noise. Every reading goes through the real burst
+//filter, calibration lookup, controller, speed taper and sample period, the way analogISR does it, and
+//Timer 3 is modelled by calling cutoffPump when a run reaches the maximum.
+//For a range of water settings the bowl is filled from empty and held, then drunk from; the test
+//reports the fill time, pump runs and overshoot and checks the band, the cutoff and the off-time hold.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "initModules.h"
+#include "eepromCache.h"
+#include "calibration.h"
+#include "levelFilter.h"
+#include "sampleRate.h"
+#include "pumpControl.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/pumpTest.img"
+#define STEP_MS 10
+#define FULL_ML_S 12.0                              // Flow at full duty
+#define STALL 0.2                                   // Duty below which the pump does not move water
+#define DELAY_STEPS 50                              // Hose, 500 ms from the pump to the bowl
+#define NOISE_TICKS 3
+#define MAX_OVERSHOOT_ML 10
+
+typedef struct _BOWL
+{
+    double ml;
+    double hose[DELAY_STEPS];                       // Water on its way, ml per step
+    uint16_t hoseIndex;
+    bool blocked;
+    bool on;
+    uint16_t duty;
+    uint32_t ms;                                    // Model time
+    uint32_t nextSampleMs;
+    uint32_t runStartMs;
+    uint32_t lastStopMs;
+    uint32_t shortestOffMs;                         // Between the end of a run and the next start
+    uint32_t noise;
+} BOWL;
+
+static uint16_t levelToTicks(double ml)             // The calibration table read backwards
+{
+    uint8_t i = 1;
+    uint16_t ticks[2];
+    uint16_t points[2];
+    while((i + 1 < getCalibrationCount()))
+    {
+        getCalibrationPoint(i, &ticks[1], &points[1]);
+        if(points[1] >= ml)
+        {
+            break;
+        }
+        i++;
+    }
+    getCalibrationPoint(i - 1, &ticks[0], &points[0]);
+    getCalibrationPoint(i, &ticks[1], &points[1]);
+    return ticks[0] + (uint16_t)(((ml - points[0]) * (ticks[1] - ticks[0])) / (points[1] - points[0]) + 0.5);
+}
+
+static uint16_t reading(BOWL* bowl)                 // One comparator measurement
+{
+    bowl->noise = (bowl->noise * 1103515245) + 12345;
+    return levelToTicks(bowl->ml) + ((bowl->noise >> 16) % (2 * NOISE_TICKS + 1)) - NOISE_TICKS;
+}
+
+static void sample(BOWL* bowl, uint16_t target)     // Timer 1 expired: a burst, then what analogISR does with it
+{
+    uint16_t level = 0;
+    bool on = false;
+    while(!addSample(reading(bowl)));
+    level = ticksToLevel(getFilteredTicks());
+    on = updatePump(level, target, true, bowl->ms / 1000);
+    bowl->duty = getPumpDuty(level, target);
+    if(on && !bowl->on)
+    {
+        uint32_t off = bowl->ms - bowl->lastStopMs;
+        bowl->shortestOffMs = (off < bowl->shortestOffMs) ? off : bowl->shortestOffMs;
+        bowl->runStartMs = bowl->ms;
+    }
+    if(!on && bowl->on)
+    {
+        bowl->lastStopMs = bowl->ms;
+    }
+    bowl->on = on;
+    bowl->nextSampleMs = bowl->ms + nextSamplePeriod(level, target, on);
+}
+
+static void step(BOWL* bowl, uint16_t target)
+{
+    double u = (double)bowl->duty / PWM_FULL;
+    double flow = (!bowl->on || bowl->blocked || (u <= STALL)) ? 0 : FULL_ML_S * (u - STALL) / (1 - STALL);
+    bowl->ml += bowl->hose[bowl->hoseIndex];        // Leaves the hose as the new water enters it
+    bowl->hose[bowl->hoseIndex] = flow * STEP_MS / 1000;
+    bowl->hoseIndex = (bowl->hoseIndex + 1) % DELAY_STEPS;
+    bowl->ms += STEP_MS;
+    if(bowl->on && (bowl->ms - bowl->runStartMs >= getMaxRun() * 1000))   // Timer 3
+    {
+        cutoffPump(bowl->ms / 1000);
+        bowl->on = false;
+        bowl->lastStopMs = bowl->ms;
+    }
+    if(bowl->ms >= bowl->nextSampleMs)
+    {
+        sample(bowl, target);
+    }
+}
+
+static void run(BOWL* bowl, uint16_t target, uint32_t ms)
+{
+    uint32_t end = bowl->ms + ms;
+    while(bowl->ms < end)
+    {
+        step(bowl, target);
+    }
+}
+
+static void startBowl(BOWL* bowl, double ml)
+{
+    uint16_t i = 0;
+    bowl->ml = ml;
+    for(i = 0; i < DELAY_STEPS; i++)
+    {
+        bowl->hose[i] = 0;
+    }
+    bowl->hoseIndex = 0;
+    bowl->blocked = false;
+    bowl->on = false;
+    bowl->duty = 0;
+    bowl->nextSampleMs = bowl->ms;
+    bowl->lastStopMs = bowl->ms - (DEFAULT_MIN_OFF_S * 1000);
+    bowl->shortestOffMs = 0xFFFFFFFF;
+    initLevelFilter(0xFFFFFFFF);                    // A fresh filter so the EMA starts at this bowl
+    initSampleRate(0xFFFFFFFF);
+}
+
+static void testFills()
+{
+    static const uint16_t targets[] = {100, 200, 300, 400, 500};
+    BOWL bowl = {0};
+    uint8_t i = 0;
+    bowl.noise = 1;
+    bowl.ms = 100000;
+    printf("  water   fill time   runs   cutoffs   overshoot\n");
+    for(i = 0; i < sizeof(targets) / sizeof(targets[0]); i++)
+    {
+        PUMP_STATS before;
+        PUMP_STATS after;
+        uint32_t start = 0;
+        uint32_t filled = 0;
+        double peak = 0;
+        uint16_t target = targets[i];
+
+        startBowl(&bowl, 0);
+        getPumpStats(&before);
+        start = bowl.ms;
+        while((bowl.ms - start < 600000) && (filled == 0))  // Full: the pump is off with the level at the target
+        {
+            step(&bowl, target);
+            filled = (!bowl.on && (bowl.ml >= target - 2)) ? bowl.ms - start : 0;
+        }
+        while(bowl.ms - start < filled + 60000)     // The hose drains, the level settles and the pump stays off
+        {
+            step(&bowl, target);
+            peak = (bowl.ml > peak) ? bowl.ml : peak;
+        }
+        getPumpStats(&after);
+        printf("  %3u ml   %6.1f s   %4u   %7u   %6.1f ml\n", target, filled / 1000.0,
+               (unsigned)(after.starts - before.starts), (unsigned)(after.cutoffs - before.cutoffs), peak - target);
+        CHECK(filled != 0);
+        CHECK(peak - target <= MAX_OVERSHOOT_ML);
+        CHECK(after.longestRunS <= getMaxRun());
+        CHECK(bowl.shortestOffMs >= DEFAULT_MIN_OFF_S * 1000);
+        CHECK(!bowl.on);
+
+        getPumpStats(&before);
+        run(&bowl, target, 600000);                 // Ten minutes at the target with the noise: no runs
+        bowl.ml -= DEFAULT_BAND_ML / 2;             // A sip inside the band: still none
+        run(&bowl, target, 120000);
+        getPumpStats(&after);
+        CHECK(after.starts == before.starts);
+        bowl.ml -= DEFAULT_BAND_ML * 2;             // A drink: one run back to the target
+        run(&bowl, target, 120000);
+        getPumpStats(&after);
+        CHECK(after.starts == before.starts + 1);
+        CHECK(bowl.ml >= target - 2);
+    }
+}
+
+static void testBlocked()                           // Nothing reaches the bowl: cut off at the maximum, then rest
+{
+    BOWL bowl = {0};
+    PUMP_STATS before;
+    PUMP_STATS after;
+    bowl.noise = 7;
+    bowl.ms = 100000;
+    startBowl(&bowl, 50);
+    bowl.blocked = true;
+    getPumpStats(&before);
+    run(&bowl, 300, 200000);                        // 60 s run, 30 s rest, 60 s run, 30 s rest, and a third
+    getPumpStats(&after);
+    printf("  blocked hose: %u runs in 200 s, %u cut off\n",
+           (unsigned)(after.starts - before.starts), (unsigned)(after.cutoffs - before.cutoffs));
+    CHECK(after.starts - before.starts == 3);
+    CHECK(after.cutoffs - before.cutoffs == 2);
+    CHECK(after.longestRunS == DEFAULT_MAX_RUN_S);
+    CHECK(bowl.shortestOffMs >= DEFAULT_MIN_OFF_S * 1000);
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    eraseEepromImage();
+    initEepromCache();
+    initCalibration();
+    initPumpControl(0xFFFFFFFF);
+    initPumpSpeed(0xFFFFFFFF);
+    testFills();
+    testBlocked();
+    closeEepromImage();
+    return finishTest("pumpTest");
+}
@@ -0,0 +1,115 @@
+//PWM set-up and pump duty on the simulated register file. initPWM is run over registers left in a
+//dirty state and what it programs is read back; the generator is then modelled from its registers
+//(count down from LOAD, the GEN actions at load, zero and compare down) to see how long the pin is high
+//each period for the duties the pump controller asks for as the bowl fills.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "initModules.h"
+#include "pumpControl.h"
+#include "hostTest.h"
+
+#define ACT_ZERO_S 0                                // GEN action fields, 2 bits each
+#define ACT_LOAD_S 2
+#define ACT_CMPA_DOWN_S 6
+#define ACT_CMPB_DOWN_S 10
+#define ACT_NONE 0
+#define ACT_LOW 2
+#define ACT_HIGH 3
+#define TARGET 300
+
+static uint32_t highCounts(uint32_t gen, uint32_t load, uint32_t compare, uint8_t compareShift)  // One period of a count-down generator
+{
+    uint32_t count = 0;
+    uint32_t high = 0;
+    bool pin = false;
+    for(count = load + 1; count-- > 0;)
+    {
+        uint8_t action = (count == load) ? (gen >> ACT_LOAD_S) & 3 : ACT_NONE;
+        action = (count == compare) ? (gen >> compareShift) & 3 : action;
+        action = ((count == 0) && (((gen >> ACT_ZERO_S) & 3) != ACT_NONE)) ? (gen >> ACT_ZERO_S) & 3 : action;
+        pin = (action == ACT_HIGH) ? true : (action == ACT_LOW) ? false : pin;
+        high += pin;
+    }
+    return high;
+}
+
+static uint32_t pumpHigh()
+{
+    return highCounts(PWM1_2_GENA_R, PWM1_2_LOAD_R, PWM1_2_CMPA_R, ACT_CMPA_DOWN_S);
+}
+
+static void testInit()                              // Both generators from whatever a warm reset left behind
+{
+    PWM1_ENABLE_R = 0xFF;
+    PWM1_2_CMPA_R = 777;
+    PWM0_0_CMPB_R = 555;
+    initPWM();
+    CHECK(SYSCTL_SRPWM_R == 0);                     // Out of reset
+    CHECK((PWM0_0_LOAD_R == PWM_LOAD) && (PWM1_2_LOAD_R == PWM_LOAD));
+    CHECK(PWM0_0_GENB_R == ((ACT_HIGH << ACT_CMPB_DOWN_S) | (ACT_LOW << ACT_LOAD_S)));
+    CHECK(PWM1_2_GENA_R == ((ACT_HIGH << ACT_CMPA_DOWN_S) | (ACT_LOW << ACT_LOAD_S)));
+    CHECK((PWM0_0_CMPB_R == 0) && (PWM1_2_CMPA_R == 0));
+    CHECK((PWM0_0_CTL_R == PWM_0_CTL_ENABLE) && (PWM1_2_CTL_R == PWM_2_CTL_ENABLE));
+    CHECK(PWM0_ENABLE_R == PWM_ENABLE_PWM1EN);      // Auger output on, held low by CMPB = 0
+    CHECK((PWM1_ENABLE_R & PWM_ENABLE_PWM4EN) == 0);    // Pump output off until drivePump
+    CHECK(PWM0_INTEN_R == PWM_INTEN_INTPWM0);
+    CHECK(NVIC_EN0_R == (1 << (INT_PWM0_0 - 16)));
+}
+
+static void testWaveform()                          // Pin high for CMP of LOAD + 1 counts
+{
+    CHECK(pumpHigh() == 1);                         // CMPA = 0 still gives one count, so the pump is turned off by its enable bit
+    PWM1_2_CMPA_R = PWM_FULL;
+    CHECK(pumpHigh() == PWM_FULL + 1);
+    PWM1_2_CMPA_R = PWM_FULL / 2;
+    CHECK(pumpHigh() == (PWM_FULL / 2) + 1);
+    PWM0_0_CMPB_R = 800;
+    CHECK(highCounts(PWM0_0_GENB_R, PWM0_0_LOAD_R, PWM0_0_CMPB_R, ACT_CMPB_DOWN_S) == 801);
+    PWM0_0_CMPB_R = 0;
+}
+
+static void testDuty()                              // Duty updates as the bowl fills, written to CMPA as drivePump does
+{
+    PUMP_STATS stats;
+    uint16_t level = 0;
+    uint32_t last = PWM_LOAD + 1;
+    bool falling = true;
+    uint32_t minHigh = 0;
+
+    initPumpSpeed(0xFFFFFFFF);
+    printf("  distance to %u ml: pin high %% of the period\n ", TARGET);
+    for(level = 0; level <= TARGET; level += 20)
+    {
+        PWM1_2_CMPA_R = getPumpDuty(level, TARGET);
+        falling &= (pumpHigh() <= last);
+        last = pumpHigh();
+        printf(" %u:%.0f", TARGET - level, pumpHigh() * 100.0 / (PWM_LOAD + 1));
+    }
+    printf("\n");
+    getPumpStats(&stats);
+    minHigh = ((DEFAULT_MIN_SPEED * (PWM_LOAD + 1)) + 50) / 100;
+    CHECK(falling);
+    CHECK(stats.lastDuty == PWM1_2_CMPA_R);
+    CHECK((last >= minHigh - 2) && (last <= minHigh + 2));   // The minimum speed at the target
+    CHECK(getPumpDuty(TARGET - DEFAULT_TAPER_ML, TARGET) == PWM_FULL);
+    CHECK(getPumpDuty(TARGET + 50, TARGET) == getPumpDuty(TARGET, TARGET));
+    CHECK(getPumpDuty(0, TARGET) == PWM_FULL);
+
+    initPumpSpeed(getPumpSpeedSetting(100, 50));    // No taper at 100 %
+    CHECK(getPumpDuty(TARGET - 10, TARGET) == PWM_FULL);
+    initPumpSpeed(getPumpSpeedSetting(30, 0));      // Taper distance 0: on or off as before
+    CHECK(getPumpDuty(TARGET - 1, TARGET) == PWM_FULL);
+    initPumpSpeed(getPumpSpeedSetting(1, 1000));    // Lowest speed over a long taper
+    PWM1_2_CMPA_R = getPumpDuty(TARGET, TARGET);
+    CHECK((pumpHigh() >= 10) && (pumpHigh() <= 12));
+}
+
+int main()
+{
+    testInit();
+    testWaveform();
+    testDuty();
+    return finishTest("pwmTest");
+}
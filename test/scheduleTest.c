@@ -0,0 +1,203 @@
+//Thirty days of feeding on the host RTC. A one-time, a daily, two weekday-mask and two every-N-hours
+//events are stored and the alarm is followed from fire to fire: the RTC jumps to the match AlarmTime
+//set, the due event is taken off the heap the way startFeed does it, and the alarm is set again. Every
+//fire is compared with a list worked out minute by minute from the rules, where events due in the same
+//minute go in event order a second apart, as AlarmTime sets them. Firing must not write the EEPROM;
+//only the one-time event is cleared, once, after it has fired.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+#include "eepromCache.h"
+#include "sortEvent.h"
+#include "AlarmTIme.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/scheduleTest.img"
+#define DAYS 30
+#define START ((8 * 3600) + 1800)                   // RTC at 08:30 on day 0
+#define DAY0 3                                      // Day 0 is a Wednesday
+#define FIRES_MAX 400
+
+typedef struct _RULE
+{
+    uint8_t rule;
+    uint8_t arg;                                    // Weekday mask or hours
+    uint16_t minutes;
+} RULE;
+
+typedef struct _FIRE
+{
+    uint32_t time;
+    uint16_t event;
+} FIRE;
+
+static const RULE rules[] =
+{
+    {RULE_ONCE, 0, (6 * 60)},                       // Already past today, so tomorrow at 06:00
+    {RULE_DAILY, 0, (7 * 60) + 30},
+    {RULE_WEEKDAYS, 0x2A, 18 * 60},                 // Monday, Wednesday and Friday
+    {RULE_WEEKDAYS, 0x41, (9 * 60) + 15},           // Weekends
+    {RULE_HOURS, 5, 2 * 60},                        // 02:00, 07:00, ... from RTC day 0, the day drifts
+    {RULE_HOURS, 24, (12 * 60) + 10}
+};
+#define EVENTS (sizeof(rules) / sizeof(rules[0]))
+
+static FIRE expected[FIRES_MAX];
+static FIRE fired[FIRES_MAX];
+
+static bool firesAt(uint16_t event, uint32_t t, bool onceDone)   // The rules as written in sortEvent.h
+{
+    uint32_t minute = (t % SECONDS_PER_DAY) / 60;
+    uint32_t start = rules[event].minutes * 60;
+    uint8_t weekday = (DAY0 + (t / SECONDS_PER_DAY)) % 7;
+    switch(rules[event].rule)
+    {
+    case RULE_ONCE:
+        return !onceDone && (minute == rules[event].minutes);
+    case RULE_DAILY:
+        return minute == rules[event].minutes;
+    case RULE_WEEKDAYS:
+        return (minute == rules[event].minutes) && (rules[event].arg & (1 << weekday));
+    default:
+        return (t >= start) && (((t - start) % (rules[event].arg * 3600)) == 0);
+    }
+}
+
+static uint16_t expectFires()                       // Every minute of the thirty days
+{
+    uint16_t count = 0;
+    uint16_t event = 0;
+    bool onceDone = false;
+    uint32_t t = 0;
+    for(t = START; t < START + (DAYS * SECONDS_PER_DAY); t += 60)
+    {
+        for(event = 0; event < EVENTS; event++)
+        {
+            if(firesAt(event, t, onceDone) && (count < FIRES_MAX))
+            {
+                expected[count].time = t;
+                expected[count].event = event;
+                count++;
+                onceDone |= (rules[event].rule == RULE_ONCE);
+            }
+        }
+    }
+    return count;
+}
+
+static uint32_t eepromWrites()
+{
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t skips = 0;
+    getEepromCounts(&reads, &writes, &skips);
+    return writes;
+}
+
+static void setUp()
+{
+    uint16_t event = 0;
+    eraseEepromImage();
+    initEepromCache();
+    HIB_RTCC_R = START;
+    writeEepromCache(SETTING_WEEKDAY, DAY0);
+    for(event = 0; event < EVENTS; event++)
+    {
+        writeEepromCache(EVENT_ACTION(event), 5 | (60 << ACTION_PWM_S));
+        writeEepromCache(EVENT_TIME(event), rules[event].minutes | (rules[event].rule << TIME_RULE_S)
+                         | (rules[event].arg << TIME_ARG_S));
+    }
+    sortEvent();
+}
+
+static void testThirtyDays()
+{
+    const uint32_t erased[EVENT_WORDS] = {0xFFFFFFFF, 0xFFFFFFFF};
+    uint16_t count = expectFires();
+    uint16_t fires = 0;
+    uint16_t late = 0;
+    uint32_t fireWrites = 0;
+    uint32_t clearWrites = 0;
+    uint32_t due = 0;
+    uint16_t i = 0;
+
+    setUp();
+    AlarmTime();
+    while((HIB_RTCM0_R < START + (DAYS * SECONDS_PER_DAY)) && (fires < FIRES_MAX))
+    {
+        uint32_t before = 0;
+        uint16_t event = 0;
+        HIB_RTCC_R = HIB_RTCM0_R;                   // The alarm matches
+        event = getNextEvent();
+        if((event == NO_EVENT) || (getNextFireTime() > HIB_RTCC_R))
+        {
+            break;                                  // Woken with nothing due
+        }
+        fired[fires].time = HIB_RTCC_R;
+        fired[fires].event = event;
+        fires++;
+        before = eepromWrites();
+        if(((readEepromCache(EVENT_TIME(event)) >> TIME_RULE_S) & TIME_RULE_M) == RULE_ONCE)
+        {
+            removeEvent(event);
+            fireWrites += eepromWrites() - before;
+            before = eepromWrites();
+            writeEepromCacheBlock(EVENT_TIME(event), erased, EVENT_WORDS);   // endFeed, after the feed
+            clearWrites += eepromWrites() - before;
+        }
+        else
+        {
+            rescheduleEvent(event);
+            fireWrites += eepromWrites() - before;
+        }
+        AlarmTime();
+    }
+
+    for(i = 0; (i < fires) && (i < count); i++)
+    {
+        due = ((i == 0) || (expected[i].time > due)) ? expected[i].time : due + 1;
+        if((fired[i].time != due) || (fired[i].event != expected[i].event))
+        {
+            late++;
+            printf("  fire %u: event %u at day %u %05u s, expected event %u at day %u %05u s\n", i,
+                   fired[i].event, (unsigned)(fired[i].time / SECONDS_PER_DAY), (unsigned)(fired[i].time % SECONDS_PER_DAY),
+                   expected[i].event, (unsigned)(due / SECONDS_PER_DAY), (unsigned)(due % SECONDS_PER_DAY));
+        }
+    }
+    printf("  %d days, %u fires of %u expected, %u off time, %u EEPROM writes firing, %u clearing the one-time event\n",
+           DAYS, fires, count, late, (unsigned)fireWrites, (unsigned)clearWrites);
+    CHECK(fires == count);
+    CHECK(late == 0);
+    CHECK(fireWrites == 0);
+    CHECK(clearWrites == EVENT_WORDS);
+    CHECK(!eventScheduled(0));
+}
+
+static void testRuleCounts()                        // The rules seen from the other side: fires per event
+{
+    uint16_t perEvent[EVENTS] = {0};
+    uint16_t count = expectFires();
+    uint16_t i = 0;
+    for(i = 0; i < count; i++)
+    {
+        perEvent[expected[i].event]++;
+    }
+    CHECK(perEvent[0] == 1);
+    CHECK(perEvent[1] == DAYS);                     // 07:30 on day 0 was before the start, day 30 at 07:30 is not
+    CHECK(perEvent[2] == 13);                       // Wed 0 18:00 to Mon 29 18:00
+    CHECK(perEvent[3] == 8);
+    CHECK(perEvent[4] == (DAYS * 24) / 5);
+    CHECK(perEvent[5] == DAYS);
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testRuleCounts();
+    testThirtyDays();
+    closeEepromImage();
+    return finishTest("scheduleTest");
+}
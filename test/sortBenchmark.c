@@ -0,0 +1,162 @@
+//EEPROM traffic of ordering 10 feeding events: the old sortEvent, which bubble sorted the schedule blocks
+//in the EEPROM after every "feed", against the RAM heap that only reads the cache. Both run on the host
+//EEPROM and are counted by its driver, for events entered in time order and in reverse.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+#include "eepromCache.h"
+#include "sortEvent.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/sortBenchmark.img"
+#define EVENTS 10
+
+typedef struct _TRAFFIC
+{
+    uint32_t reads;
+    uint32_t writes;
+} TRAFFIC;
+
+static void legacySortEvent()                       // sortEvent before the RAM index, blocks of 16 words, one per event
+{
+    uint16_t TOTAL_BLOCKS = 10;
+    uint8_t fo;
+    uint8_t block = 0;
+    for (block = 0; block < TOTAL_BLOCKS; block++)
+    {
+        int ActiveFlag = readEeprom(16 * block + 5);
+
+        if (ActiveFlag == 1)
+        {
+            uint8_t i = 0;
+            for (i = 0; i < TOTAL_BLOCKS - 1; i++)
+            {
+                uint8_t j = 0;
+                for (j = 0; j < TOTAL_BLOCKS - i -1; j++)
+                {
+                    uint32_t currentHours = (readEeprom(16 * j + 3));
+                    uint32_t currentMinutes = (readEeprom(16 * j + 4));
+
+                    uint32_t nextHours = (readEeprom(16 * (j + 1) + 3));
+                    uint32_t nextMinutes = (readEeprom(16 * (j + 1) + 4));
+
+                    if ((currentHours > nextHours) || (currentHours == nextHours && currentMinutes > nextMinutes))
+                    {
+                        uint8_t k = 0;
+                        for (k = 0; k < 16; k++)    //Swap the entire block
+                        {
+                            uint32_t temp = readEeprom(16 * j + k);
+                            writeEeprom(16 * j + k, readEeprom(16 * (j + 1) + k));
+                            writeEeprom(16 * (j + 1) + k, temp);
+                        }
+                    }
+                }
+            }
+            // Update the event field on the eeprom
+
+            for (fo = 0; fo < 10; fo++)
+            {
+                uint8_t sorted = 16* fo;
+                writeEeprom(sorted, fo);  //Event address
+            }
+        }
+    }
+}
+
+static void count(TRAFFIC* traffic)
+{
+    uint32_t skips = 0;
+    getEepromCounts(&traffic->reads, &traffic->writes, &skips);
+}
+
+static uint16_t eventMinutes(uint16_t i, bool reverse)
+{
+    return (reverse ? (EVENTS - 1 - i) : i) * 90;
+}
+
+static void legacyFeeds(bool reverse, TRAFFIC* traffic)    // Ten "feed" commands, each followed by sortEvent
+{
+    uint16_t i = 0;
+    TRAFFIC before;
+    TRAFFIC after;
+    eraseEepromImage();
+    traffic->reads = 0;
+    traffic->writes = 0;
+    for(i = 0; i < EVENTS; i++)
+    {
+        uint32_t block[6] = {i, 10, 50, eventMinutes(i, reverse) / 60, eventMinutes(i, reverse) % 60, 1};
+        writeEepromBlock(16 * i, block, 6);
+        count(&before);
+        legacySortEvent();
+        count(&after);
+        traffic->reads += after.reads - before.reads;
+        traffic->writes += after.writes - before.writes;
+    }
+    for(i = 1; i < EVENTS; i++)                     // The blocks did end up in time order
+    {
+        CHECK((readEeprom(16 * i + 3) * 60) + readEeprom(16 * i + 4) >= (readEeprom(16 * (i - 1) + 3) * 60) + readEeprom(16 * (i - 1) + 4));
+    }
+}
+
+static void heapFeeds(bool reverse, TRAFFIC* traffic, TRAFFIC* rebuild)  // Ten events inserted into the heap, then a boot rebuild
+{
+    uint16_t i = 0;
+    uint16_t event = NO_EVENT;
+    TRAFFIC before;
+    TRAFFIC after;
+    eraseEepromImage();
+    initEepromCache();
+    HIB_RTCC_R = 0;
+    traffic->reads = 0;
+    traffic->writes = 0;
+    for(i = 0; i < EVENTS; i++)
+    {
+        writeEepromCache(EVENT_ACTION(i), 10 | (50 << ACTION_PWM_S));
+        writeEepromCache(EVENT_TIME(i), eventMinutes(i, reverse) | (RULE_DAILY << TIME_RULE_S));
+        count(&before);
+        insertEvent(i);
+        count(&after);
+        traffic->reads += after.reads - before.reads;
+        traffic->writes += after.writes - before.writes;
+    }
+    count(&before);
+    sortEvent();
+    count(&after);
+    rebuild->reads = after.reads - before.reads;
+    rebuild->writes = after.writes - before.writes;
+
+    CHECK(getEventCount() == EVENTS);
+    startEventWalk();
+    for(i = 0; i < EVENTS; i++)                     // The heap hands them out earliest first
+    {
+        event = nextWalkEvent();
+        CHECK(event == (reverse ? EVENTS - 1 - i : i));
+    }
+}
+
+int main()
+{
+    uint8_t pass = 0;
+    openEepromImage(IMAGE);
+    printf("  ordering %d events entered by \"feed\", EEPROM word reads/writes:\n", EVENTS);
+    for(pass = 0; pass < 2; pass++)
+    {
+        bool reverse = (pass == 1);
+        TRAFFIC legacy;
+        TRAFFIC heap;
+        TRAFFIC rebuild;
+        legacyFeeds(reverse, &legacy);
+        heapFeeds(reverse, &heap, &rebuild);
+        printf("  %-13s old sortEvent %6u / %5u   heap inserts %u / %u, boot rebuild %u / %u\n", reverse ? "reverse order" : "time order",
+               (unsigned)legacy.reads, (unsigned)legacy.writes, (unsigned)heap.reads, (unsigned)heap.writes,
+               (unsigned)rebuild.reads, (unsigned)rebuild.writes);
+        CHECK((heap.reads == 0) && (heap.writes == 0));
+        CHECK((rebuild.reads == 0) && (rebuild.writes == 0));
+        CHECK(legacy.writes >= 100);
+    }
+    closeEepromImage();
+    return finishTest("sortBenchmark");
+}
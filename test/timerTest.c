@@ -0,0 +1,161 @@
+//Software timers of the event loop on the simulated SysTick. A tick is 10 ms; the tick interrupt only
+//runs while the loop has enabled it, and what it posts is run by runTimers the way doWork does. One-shot
+//and periodic timers must call back on the tick they are due, a callback may start timers of its own,
+//and with no timer running the tick interrupt must be off so an idle feeder is not woken. sleepUntilWork
+//must only sleep with no work queued and must leave interrupts enabled.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "fixedPoint.h"
+#include "isrQueue.h"
+#include "eventLoop.h"
+#include "hostTest.h"
+
+#define TIMER_ONCE 0
+#define TIMER_PERIODIC 1
+#define TIMER_CHAIN 2
+#define TICKS_MAX 64
+
+static uint32_t tick = 0;                           // Ticks of the simulated SysTick
+static uint32_t wokenTicks = 0;                     // Ticks the interrupt ran on
+static uint32_t onceAt[TICKS_MAX];
+static uint32_t periodicAt[TICKS_MAX];
+static uint32_t chainAt[TICKS_MAX];
+static uint8_t onceCount = 0;
+static uint8_t periodicCount = 0;
+static uint8_t chainCount = 0;
+
+void sysTickISR();
+
+static void once()
+{
+    onceAt[onceCount++ % TICKS_MAX] = tick;
+}
+
+static void periodic()
+{
+    periodicAt[periodicCount++ % TICKS_MAX] = tick;
+}
+
+static void chain()                                 // Starts itself again, 20 ms later
+{
+    chainAt[chainCount++ % TICKS_MAX] = tick;
+    if(chainCount < 3)
+    {
+        startTimer(TIMER_CHAIN, 20, false, chain);
+    }
+}
+
+static void runTicks(uint32_t count)                // SysTick runs on, the main loop does its work after each tick
+{
+    uint32_t i = 0;
+    WORK_ITEM item;
+    for(i = 0; i < count; i++)
+    {
+        tick++;
+        if(NVIC_ST_CTRL_R & NVIC_ST_CTRL_INTEN)
+        {
+            sysTickISR();
+            wokenTicks++;
+        }
+        while(getWork(&item))
+        {
+            if(item.type == WORK_TICK)
+            {
+                runTimers();
+            }
+        }
+    }
+}
+
+static void testSetUp()
+{
+    initEventLoop();
+    CHECK(NVIC_ST_RELOAD_R == MS_TO_CYCLES(TICK_MS) - 1);
+    CHECK(NVIC_ST_CTRL_R & NVIC_ST_CTRL_ENABLE);
+    CHECK(!(NVIC_ST_CTRL_R & NVIC_ST_CTRL_INTEN));  // No timer, no tick interrupt
+    CHECK(!timersRunning());
+}
+
+static void testOnce()
+{
+    tick = 0;
+    wokenTicks = 0;
+    startTimer(TIMER_ONCE, 45, false, once);        // Rounded up to 5 ticks
+    CHECK(NVIC_ST_CTRL_R & NVIC_ST_CTRL_INTEN);
+    runTicks(20);
+    CHECK(onceCount == 1);
+    CHECK(onceAt[0] == 5);
+    CHECK(!timersRunning());
+    CHECK(!(NVIC_ST_CTRL_R & NVIC_ST_CTRL_INTEN));
+    CHECK(wokenTicks == 5);                         // Not woken after the timer ran
+
+    startTimer(TIMER_ONCE, 0, false, once);         // Never sooner than the next tick
+    runTicks(1);
+    CHECK(onceCount == 2);
+}
+
+static void testPeriodic()
+{
+    uint8_t i = 0;
+    bool onTime = true;
+    tick = 0;
+    wokenTicks = 0;
+    startTimer(TIMER_PERIODIC, 30, true, periodic);
+    startTimer(TIMER_ONCE, 100, false, once);
+    runTicks(31);
+    stopTimer(TIMER_PERIODIC);
+    for(i = 0; i < periodicCount; i++)
+    {
+        onTime &= (periodicAt[i] == 3u * (i + 1));
+    }
+    printf("  periodic 30 ms: %u calls in 310 ms, tick interrupt on %u of 31 ticks\n", periodicCount, (unsigned)wokenTicks);
+    CHECK(periodicCount == 10);
+    CHECK(onTime);
+    CHECK(onceAt[onceCount - 1] == 10);             // The one-shot beside it
+    CHECK(wokenTicks == 31);
+    runTicks(10);
+    CHECK(periodicCount == 10);                     // Stopped
+    CHECK(!(NVIC_ST_CTRL_R & NVIC_ST_CTRL_INTEN));
+}
+
+static void testChain()
+{
+    LOOP_STATS before;
+    LOOP_STATS after;
+    getLoopStats(&before);
+    tick = 0;
+    startTimer(TIMER_CHAIN, 20, false, chain);
+    runTicks(20);
+    getLoopStats(&after);
+    CHECK(chainCount == 3);
+    CHECK((chainAt[0] == 2) && (chainAt[1] == 4) && (chainAt[2] == 6));
+    CHECK(after.timersRun - before.timersRun == 3);
+    CHECK(!timersRunning());
+}
+
+static void testSleep()
+{
+    LOOP_STATS stats;
+    uint32_t wfis = getWfiCount();
+    sleepUntilWork();                               // Nothing queued: WFI
+    CHECK(getWfiCount() == wfis + 1);
+    CHECK(getPrimask() == 0);
+    postWork(WORK_RX, 0);
+    sleepUntilWork();                               // Work waiting: straight back to it
+    CHECK(getWfiCount() == wfis + 1);
+    CHECK(getPrimask() == 0);
+    getLoopStats(&stats);
+    CHECK(stats.wakes == 1);
+}
+
+int main()
+{
+    testSetUp();
+    testOnce();
+    testPeriodic();
+    testChain();
+    testSleep();
+    return finishTest("timerTest");
+}
@@ -0,0 +1,237 @@
+//parseFields on a corpus of command lines, good and malformed: the result code, the field types and the
+//values of each, numbers at the edges of 32 bits, times at the edges of the day, quoted strings with and
+//without their closing quote and lines longer than the field limit. Then the lines a second the one pass
+//tokenizer reaches on a typical command against the old parseFields followed by the old getFieldInteger
+//for each number, which is what reading the values cost before.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "getInput.h"
+#include "hostTest.h"
+
+#define ROUNDS 1000000
+
+typedef struct _SAMPLE
+{
+    const char* line;
+    uint8_t result;
+    const char* types;                              // fieldType of each field when the line parses
+} SAMPLE;
+
+static const SAMPLE corpus[] =
+{
+    {"feed 0 10 99 5:10", PARSE_OK, "annnt"},
+    {"feed 0 10 99 5 10", PARSE_OK, "annnnn"},      // Six fields, more than the old limit of five
+    {"feed 0 10 99 5 10 7 8 9 10 11", PARSE_TOO_MANY, ""},
+    {"time 23:59", PARSE_OK, "at"},
+    {"time 00:00", PARSE_OK, "at"},
+    {"time 24:00", PARSE_BAD_TIME, ""},
+    {"time 5:60", PARSE_BAD_TIME, ""},
+    {"time 5:1", PARSE_BAD_TIME, ""},
+    {"time 5:", PARSE_BAD_TIME, ""},
+    {"time 5:100", PARSE_BAD_TIME, ""},
+    {"time 123:10", PARSE_BAD_TIME, ""},
+    {"water 2147483647", PARSE_OK, "an"},
+    {"water 2147483648", PARSE_BAD_NUMBER, ""},
+    {"water -2147483648", PARSE_OK, "an"},
+    {"water -2147483649", PARSE_BAD_NUMBER, ""},
+    {"water 99999999999999999999", PARSE_BAD_NUMBER, ""},
+    {"water 12ab", PARSE_BAD_NUMBER, ""},
+    {"water 1.5", PARSE_BAD_NUMBER, ""},
+    {"water -", PARSE_BAD_NUMBER, ""},
+    {"water --1", PARSE_BAD_NUMBER, ""},
+    {"alert on!", PARSE_BAD_CHAR, ""},
+    {"$", PARSE_BAD_CHAR, ""},
+    {"say \"hello world\" x", PARSE_OK, "asa"},
+    {"say \"open", PARSE_BAD_STRING, ""},
+    {"say \"\"", PARSE_OK, "as"},
+    {"x \"q\"y", PARSE_BAD_CHAR, ""},
+    {"  pump   speed\t40,100  ", PARSE_OK, "aann"},
+    {"a_b c9", PARSE_OK, "aa"},
+    {"", PARSE_OK, ""},
+    {"   ", PARSE_OK, ""}
+};
+#define SAMPLES (sizeof(corpus) / sizeof(corpus[0]))
+
+static bool parse(USER_DATA* data, const char* line, uint8_t maxFields, uint8_t result)
+{
+    strcpy(data->buffer, line);
+    return parseFields(data, maxFields) == result;
+}
+
+static void legacyParseFields(USER_DATA* data)      // parseFields before the tokenizer, without the overrun
+{
+    data->fieldCount = 0;
+    uint8_t i = 0;
+    int prevCh = 0;
+    uint8_t indexcount= 0;
+
+    while(data->buffer[i] && (indexcount < MAX_FIELDS))
+    {
+        if (((data->buffer[i] >= 'a') && (data->buffer[i] <= 'z')) || ((data->buffer[i] >= 'A') && (data->buffer[i] <= 'Z')))
+        {
+            if (prevCh == 0)
+            {
+                data->fieldType[indexcount] = 'a';
+                data->fieldPosition[indexcount] = i;
+                data->fieldCount++;
+                prevCh = 1;
+                indexcount++;
+            }
+        }
+        else if (((data->buffer[i] >= '0') && (data->buffer[i] <= '9')) || (data->buffer[i] == '-') || (data->buffer[i] == '.'))
+        {
+           if(prevCh == 0)
+           {
+               data->fieldType[indexcount] = 'n';
+               data->fieldPosition[indexcount] = i;
+               data->fieldCount++;
+               prevCh = 1;
+               indexcount++;
+            }
+        }
+        else
+        {
+            data->buffer[i] = '\0';
+            prevCh = 0;
+        }
+        i++;
+    }
+}
+
+static int32_t legacyGetFieldInteger(USER_DATA* data, uint8_t fieldNumber)
+{
+    int32_t i = 0;
+    int32_t fieldint = 0;
+    char *strtoi;
+
+    if((fieldNumber <= data -> fieldCount) && (data->fieldType[fieldNumber] == 'n'))
+    {
+        strtoi = &(data->buffer[data->fieldPosition[fieldNumber]]);
+        while(strtoi[i])
+        {
+            fieldint = fieldint * 10 + (strtoi[i] - '0');
+            i++;
+        }
+        return fieldint;
+    }
+    return 0;
+}
+
+static void testCorpus()
+{
+    USER_DATA data;
+    uint8_t i = 0;
+    uint8_t wrong = 0;
+    for(i = 0; i < SAMPLES; i++)
+    {
+        uint8_t result = 0;
+        bool same = true;
+        strcpy(data.buffer, corpus[i].line);
+        result = parseFields(&data, MAX_FIELDS);
+        same = (result == corpus[i].result);
+        if(same && (result == PARSE_OK))
+        {
+            uint8_t field = 0;
+            same = (data.fieldCount == strlen(corpus[i].types));
+            for(field = 0; same && (field < data.fieldCount); field++)
+            {
+                same = (data.fieldType[field] == corpus[i].types[field]);
+            }
+        }
+        if(!same)
+        {
+            printf("  \"%s\" gave %u, expected %u \"%s\"\n", corpus[i].line, result, corpus[i].result, corpus[i].types);
+            wrong++;
+        }
+    }
+    printf("  %u lines, %u parsed otherwise than expected\n", (unsigned)SAMPLES, wrong);
+    CHECK(wrong == 0);
+}
+
+static void testValues()
+{
+    USER_DATA data;
+    uint16_t hour = 0;
+    uint16_t mins = 0;
+
+    CHECK(parse(&data, "water -2147483648 2147483647 0", MAX_FIELDS, PARSE_OK));
+    CHECK(getFieldInteger(&data, 1) == INT32_MIN);
+    CHECK(getFieldInteger(&data, 2) == INT32_MAX);
+    CHECK(getFieldInteger(&data, 3) == 0);
+    CHECK(getFieldInteger(&data, 0) == 0);          // Not a number
+    CHECK(getFieldInteger(&data, 4) == 0);          // No such field
+
+    CHECK(parse(&data, "feed 0 10 99 05:10", MAX_FIELDS, PARSE_OK));
+    CHECK(getFieldTime(&data, 4, &hour, &mins) && (hour == 5) && (mins == 10));
+    CHECK(getFieldInteger(&data, 4) == 0);          // A time, not a number
+    CHECK(!getFieldTime(&data, 2, &hour, &mins));   // 10 and 99, no time
+    CHECK(parse(&data, "time 5 10", MAX_FIELDS, PARSE_OK));
+    CHECK(getFieldTime(&data, 1, &hour, &mins) && (hour == 5) && (mins == 10));
+    CHECK(!getFieldTime(&data, 2, &hour, &mins));
+
+    CHECK(parse(&data, "say \"hello world\" x", MAX_FIELDS, PARSE_OK));
+    CHECK(strcmp(getFieldString(&data, 1), "hello world") == 0);   // In place, the quotes dropped
+    CHECK(strcmp(getFieldString(&data, 2), "x") == 0);
+    CHECK(getFieldString(&data, 1) == &data.buffer[5]);
+}
+
+static void testLimit()
+{
+    USER_DATA data;
+    CHECK(parse(&data, "a b c", 3, PARSE_OK));
+    CHECK(data.fieldCount == 3);
+    CHECK(parse(&data, "a b c d", 3, PARSE_TOO_MANY));
+    CHECK(parse(&data, "a b c d", MAX_FIELDS + 5, PARSE_OK));   // Never past MAX_FIELDS whatever the caller asks
+    CHECK(parse(&data, "1 2 3 4 5 6 7 8 9 10", MAX_FIELDS, PARSE_OK));
+    CHECK(parse(&data, "1 2 3 4 5 6 7 8 9 10 11", MAX_FIELDS + 5, PARSE_TOO_MANY));
+}
+
+static void testThroughput()
+{
+    const char* line = "feed 12 10 99 510 repeat every 6 hours";   // Numbers the old parser reads too
+    USER_DATA data;
+    uint32_t round = 0;
+    uint8_t field = 0;
+    int32_t sum = 0;
+    uint64_t start = 0;
+    double now = 0;
+    double legacy = 0;
+
+    start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        strcpy(data.buffer, line);
+        parseFields(&data, MAX_FIELDS);
+        for(field = 0; field < data.fieldCount; field++)
+        {
+            sum += getFieldInteger(&data, field);
+        }
+    }
+    now = (double)(getNanoseconds() - start) / ROUNDS;
+
+    start = getNanoseconds();
+    for(round = 0; round < ROUNDS; round++)
+    {
+        strcpy(data.buffer, line);
+        legacyParseFields(&data);
+        for(field = 0; field < data.fieldCount; field++)
+        {
+            sum -= legacyGetFieldInteger(&data, field);
+        }
+    }
+    legacy = (double)(getNanoseconds() - start) / ROUNDS;
+
+    printf("  \"%s\": %.1f ns a line (%.0f MB/s), the old parser %.1f ns\n", line, now, strlen(line) * 1000.0 / now, legacy);
+    CHECK(sum == 0);                                // Both read the same values
+}
+
+int main()
+{
+    testCorpus();
+    testValues();
+    testLimit();
+    testThroughput();
+    return finishTest("tokenizerTest");
+}
@@ -0,0 +1,225 @@
+//uart0.c against the simulated UART0 in host/uart.c. The UART0 interrupt is taken whenever it is
+//pending and PRIMASK clears, so it also runs while the main loop waits for room. In loopback everything
+//sent comes back at the line rate without a loss. A main loop that outruns the line waits and loses
+//nothing, an interrupt never waits and drops what does not fit, and an rx ring nobody reads drops what
+//does not fit. The high-water marks follow, and the time an enqueue takes is measured.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "uart0.h"
+#include "hostUart.h"
+#include "hostTest.h"
+
+#define CLOCK_HZ 40000000
+#define LOOPBACK_CHARS 20000
+#define BURST_CHARS 1000
+#define ISR_CHARS 400
+#define UNREAD_CHARS 200
+#define LINE_SLACK 8                                // Characters the line may send while a burst is queued
+
+static uint32_t interrupts = 0;
+
+static void uartInterrupt()                         // The NVIC, UART0 vector
+{
+    if(uartInterruptPending())
+    {
+        uint32_t active = NVIC_INT_CTRL_R;
+        NVIC_INT_CTRL_R = INT_UART0;
+        serviceUart0();
+        NVIC_INT_CTRL_R = active;
+        interrupts++;
+    }
+}
+
+static void drain()                                 // Lets everything queued leave the transmitter
+{
+    uint16_t i = 0;
+    for(i = 0; i < UART0_TX_SIZE + UART_FIFO_SIZE + 2; i++)
+    {
+        runUart(getUartCharCycles());
+        uartInterrupt();
+    }
+}
+
+static void loopback(bool on)
+{
+    drain();
+    if(on)
+    {
+        UART0_CTL_R |= UART_CTL_LBE;
+    }
+    else
+    {
+        UART0_CTL_R &= ~UART_CTL_LBE;
+    }
+}
+
+static void testLoopback()                          // The main loop sends and reads back as fast as it can
+{
+    UART0_STATS stats;
+    HOST_UART_STATS line;
+    uint64_t start = 0;
+    uint32_t sent = 0;
+    uint32_t got = 0;
+    uint32_t wrong = 0;
+    uint32_t rate = 0;
+    uint32_t rounds = 0;
+    char c = 0;
+
+    loopback(true);
+    start = getUartCycles();
+    while((got < LOOPBACK_CHARS) && (rounds++ < LOOPBACK_CHARS * 100))   // Ends even if characters are lost
+    {
+        if(sent < LOOPBACK_CHARS)
+        {
+            putcUart0((char)sent++);                // Every byte value, the negative chars too
+        }
+        runUart(100);
+        uartInterrupt();
+        while(tryGetcUart0(&c))
+        {
+            wrong += (c != (char)got++);
+        }
+    }
+    rate = (uint32_t)(((uint64_t)got * CLOCK_HZ) / (getUartCycles() - start));
+    getUart0Stats(&stats);
+    getHostUartStats(&line);
+    printf("  loopback: %u chars at %u chars/s, line rate %u, %u interrupts, tx ring high %u, rx ring high %u\n",
+           (unsigned)got, (unsigned)rate, (unsigned)(CLOCK_HZ / getUartCharCycles()), (unsigned)interrupts,
+           (unsigned)stats.txHigh, (unsigned)stats.rxHigh);
+    CHECK((got == LOOPBACK_CHARS) && (wrong == 0));
+    CHECK(rate * 100 >= (CLOCK_HZ / getUartCharCycles()) * 99);   // The transmitter never idles
+    CHECK((stats.txDropped == 0) && (stats.rxDropped == 0) && (line.overruns == 0));
+    CHECK(stats.txStalls != 0);                     // The sender is faster than the line
+    CHECK(stats.rxHigh < UART0_RX_SIZE);
+}
+
+static void testBackpressure()                      // A burst from the main loop waits for room and loses nothing
+{
+    UART0_STATS before;
+    UART0_STATS after;
+    HOST_UART_STATS lineBefore;
+    HOST_UART_STATS lineAfter;
+    uint16_t i = 0;
+
+    loopback(false);
+    getUart0Stats(&before);
+    getHostUartStats(&lineBefore);
+    for(i = 0; i < BURST_CHARS; i++)
+    {
+        putcUart0('b');
+    }
+    drain();
+    getUart0Stats(&after);
+    getHostUartStats(&lineAfter);
+    printf("  main loop burst of %u: %u sent, %u waits\n", BURST_CHARS, (unsigned)(lineAfter.sent - lineBefore.sent),
+           (unsigned)(after.txStalls - before.txStalls));
+    CHECK(lineAfter.sent - lineBefore.sent == BURST_CHARS);
+    CHECK(after.txDropped == before.txDropped);
+    CHECK(after.txStalls - before.txStalls >= BURST_CHARS - UART0_TX_SIZE - UART_FIFO_SIZE - LINE_SLACK);
+    CHECK(after.txHigh == UART0_TX_SIZE);
+    CHECK(lineAfter.txOverflows == 0);              // TXFF is always checked first
+}
+
+static void testInterruptDrops()                    // The same burst from an interrupt is cut short instead
+{
+    UART0_STATS before;
+    UART0_STATS after;
+    HOST_UART_STATS lineBefore;
+    HOST_UART_STATS lineAfter;
+    HOST_UART_STATS polled;
+    uint64_t worstNs = 0;
+    uint32_t worstPolls = 0;
+    uint16_t i = 0;
+
+    loopback(false);
+    getUart0Stats(&before);
+    getHostUartStats(&lineBefore);
+    NVIC_INT_CTRL_R = INT_PWM0_0;
+    for(i = 0; i < ISR_CHARS; i++)
+    {
+        uint32_t polls = 0;
+        uint64_t start = 0;
+        uint64_t ns = 0;
+        getHostUartStats(&polled);
+        polls = polled.polls;
+        start = getNanoseconds();
+        putcUart0('i');
+        ns = getNanoseconds() - start;
+        getHostUartStats(&polled);
+        worstNs = (ns > worstNs) ? ns : worstNs;
+        worstPolls = (polled.polls - polls > worstPolls) ? polled.polls - polls : worstPolls;
+    }
+    NVIC_INT_CTRL_R = 0;
+    drain();
+    getUart0Stats(&after);
+    getHostUartStats(&lineAfter);
+    printf("  interrupt burst of %u: %u sent, %u dropped, worst enqueue %u ns on the host and %u flag reads\n", ISR_CHARS,
+           (unsigned)(lineAfter.sent - lineBefore.sent), (unsigned)(after.txDropped - before.txDropped),
+           (unsigned)worstNs, (unsigned)worstPolls);
+    CHECK(after.txDropped - before.txDropped == ISR_CHARS - (lineAfter.sent - lineBefore.sent));
+    CHECK(after.txDropped - before.txDropped >= ISR_CHARS - UART0_TX_SIZE - UART_FIFO_SIZE - LINE_SLACK);
+    CHECK(after.txStalls == before.txStalls);       // Never waited
+    CHECK(worstPolls <= UART_FIFO_SIZE + 1);        // At most one FIFO refill
+}
+
+static void testUnread()                            // Nobody reads: the rx ring fills and the rest is dropped
+{
+    UART0_STATS before;
+    UART0_STATS after;
+    HOST_UART_STATS lineBefore;
+    HOST_UART_STATS lineAfter;
+    uint16_t i = 0;
+    uint16_t got = 0;
+    bool ordered = true;
+    char c = 0;
+
+    loopback(true);
+    getUart0Stats(&before);
+    getHostUartStats(&lineBefore);
+    for(i = 0; i < UNREAD_CHARS; i++)
+    {
+        putcUart0((char)i);
+    }
+    drain();
+    getUart0Stats(&after);
+    getHostUartStats(&lineAfter);
+    while(tryGetcUart0(&c))
+    {
+        ordered &= (c == (char)got++);
+    }
+    printf("  %u unread: %u kept, %u dropped by serviceUart0\n", UNREAD_CHARS, got, (unsigned)(after.rxDropped - before.rxDropped));
+    CHECK(after.rxHigh == UART0_RX_SIZE);
+    CHECK(after.rxDropped - before.rxDropped == UNREAD_CHARS - UART0_RX_SIZE);
+    CHECK((got == UART0_RX_SIZE) && ordered);       // The oldest are kept
+    CHECK(lineAfter.overruns == lineBefore.overruns);   // The interrupt kept the rx FIFO empty
+}
+
+static void testPrimask()                           // A caller that masked interrupts keeps them masked
+{
+    uint32_t primask = 0;
+    uint32_t taken = 0;
+    loopback(false);
+    CHECK(getPrimask() == 0);
+    primask = _disable_interrupts();
+    taken = interrupts;
+    putcUart0('p');
+    tryPutcUart0('q');
+    CHECK(getPrimask() == 1);
+    CHECK(interrupts == taken);
+    _restore_interrupts(primask);
+    CHECK(getPrimask() == 0);
+}
+
+int main()
+{
+    initUart0();
+    setInterruptHook(uartInterrupt);
+    testLoopback();
+    testBackpressure();
+    testInterruptDrops();
+    testUnread();
+    testPrimask();
+    return finishTest("uartTest");
+}
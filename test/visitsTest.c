@@ -0,0 +1,114 @@
+//Hourly visit buckets when the clock is set: backwards and forwards by "time", a visit open across the
+//change, and a boot with the RTC behind the saved hour after the backup battery ran out. Each time the
+//counts must stay with the hours they were made in and new visits must be counted.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "eepromCache.h"
+#include "visits.h"
+#include "hostEeprom.h"
+#include "hostTest.h"
+
+#define IMAGE "build/visitsTest.img"
+#define HOUR 3600
+#define DAY (24 * HOUR)
+
+static void visit(uint32_t start, uint16_t seconds)
+{
+    startVisit(start);
+    endVisit(start + seconds);
+}
+
+static uint8_t visitsAgo(uint32_t now, uint8_t hoursAgo)
+{
+    VISIT_HOUR_STATS stats;
+    compactVisits(now);
+    getVisitHour(now, hoursAgo, &stats);
+    return stats.visits;
+}
+
+static void boot(uint32_t now)
+{
+    eraseEepromImage();
+    initEepromCache();
+    initVisits(now);
+}
+
+static void testBackwards()                         // Day 3 at 11:30 set to 11:30 and then 00:30 on RTC day 0
+{
+    uint32_t now = (3 * DAY) + (11 * HOUR) + 1800;
+    boot((3 * DAY) + (9 * HOUR));
+    visit((3 * DAY) + (10 * HOUR) + 60, 30);
+    visit((3 * DAY) + (10 * HOUR) + 600, 30);
+    visit((3 * DAY) + (11 * HOUR) + 60, 30);
+    CHECK(visitsAgo(now, 0) == 1);
+    CHECK(visitsAgo(now, 1) == 2);
+
+    rebaseVisits(now, (11 * HOUR) + 1800);          // "time 11:30", the RTC restarts at day 0
+    now = (11 * HOUR) + 1800;
+    CHECK(visitsAgo(now, 0) == 1);
+    CHECK(visitsAgo(now, 1) == 2);
+    visit(now + 60, 30);
+    CHECK(visitsAgo(now + 120, 0) == 2);
+
+    rebaseVisits(now + 120, 1800);                  // "time 00:30": only the newest hour is after RTC hour 0
+    now = 1800;
+    CHECK(visitsAgo(now, 0) == 2);
+    CHECK(visitsAgo(now, 1) == 0);
+    visit(now + 60, 30);
+    CHECK(visitsAgo(now + 120, 0) == 3);
+    CHECK(visitsAgo(now + HOUR, 1) == 3);           // And the hour rolls on
+}
+
+static void testForwards()
+{
+    uint32_t now = (5 * HOUR) + 1800;
+    boot(HOUR);
+    visit((4 * HOUR) + 60, 30);
+    visit(now, 30);
+    rebaseVisits(now + 60, (20 * HOUR) + 1800);     // "time 20:30"
+    now = (20 * HOUR) + 1800;
+    CHECK(visitsAgo(now, 0) == 1);
+    CHECK(visitsAgo(now, 1) == 1);
+    CHECK(visitsAgo(now, 2) == 0);
+}
+
+static void testOpenVisit()                         // The pet is at the bowl while the clock is set back
+{
+    VISIT recent;
+    uint32_t now = (2 * DAY) + (8 * HOUR);
+    boot(now);
+    startVisit(now);
+    rebaseVisits(now + 40, HOUR + 1800);            // 40 s into the visit
+    endVisit(HOUR + 1820);
+    CHECK(getRecentVisits(&recent, 1) == 1);
+    CHECK(recent.seconds == 60);
+    CHECK(recent.start == HOUR + 1760);
+    CHECK(visitsAgo(HOUR + 1830, 0) == 1);
+}
+
+static void testBatteryLoss()                       // Saved at day 6, the RTC came back at 0 after a power loss
+{
+    uint32_t saved = (6 * DAY) + (15 * HOUR);
+    boot(saved);
+    visit(saved + 60, 30);
+    compactVisits(saved + HOUR);
+    saveVisits();
+    CHECK(readEepromCache(VISIT_HOUR) == (saved / HOUR) + 1);
+
+    initVisits(2 * HOUR);                           // Reboot, the cache still holds the saved buckets
+    visit((2 * HOUR) + 60, 30);
+    CHECK(visitsAgo((2 * HOUR) + 120, 0) == 1);
+    CHECK(readEepromCache(VISIT_HOUR) == 2);
+}
+
+int main()
+{
+    openEepromImage(IMAGE);
+    testBackwards();
+    testForwards();
+    testOpenVisit();
+    testBatteryLoss();
+    closeEepromImage();
+    return finishTest("visitsTest");
+}